@@ -1,131 +1,250 @@
 #include "communicator.h"
 
 #include "device.h"
+#include "passed_time.hpp"
+#include "wire_messages.h"
 
 #include <boost/interprocess/creation_tags.hpp>
 #include <boost/interprocess/detail/os_file_functions.hpp>
 #include <boost/interprocess/shared_memory_object.hpp>
-#include <boost/interprocess/sync/interprocess_mutex.hpp>
-#include <boost/interprocess/sync/scoped_lock.hpp>
 
-#include <cereal/archives/binary.hpp>
-#include <cereal/types/array.hpp>
-#include <cereal/types/map.hpp>
-#include <cereal/types/string.hpp>
-#include <cereal/types/variant.hpp>
-#include <cereal/types/vector.hpp>
+#include <unistd.h>
 
+#include <atomic>
 #include <bits/chrono.h>
-#include <istream>
+#include <chrono>
+#include <cstdint>
+#include <exception>
 #include <memory>
-#include <ostream>
-#include <thread>
+#include <optional>
+#include <stdexcept>
 #include <utility>
+#include <vector>
 
 // This is GUI side communicator
 
 static_assert(kWholeSharedMemSize % 2 == 0, "Wrong size.");
+static_assert(2 * sizeof(wire::FullInfo) < SharedMemoryWithMutex::kInfoSize,
+              "Both seqlock buffers must fit publication area of the shared memory.");
+
+namespace {
+using namespace std::chrono_literals;
+/// Daemon is considered dead if it did not respond during this time.
+constexpr auto kDaemonResponseTimeout = 4s;
+/// Waiting for the daemon is interrupted this often to check if GUI is closing.
+constexpr auto kStopCheckPeriod = 100ms;
+
+/// @returns Token which is unique for each client object of each process.
+std::uint64_t MakeClientToken()
+{
+    static std::atomic<std::uint32_t> counter{0};
+    return (static_cast<std::uint64_t>(getpid()) << 32u) | ++counter;
+}
+} // namespace
 
-// Ok, idea is, on 1st half of the memory we will put cereal serialized current state like
-// temperature / rpm. From the 2nd half we will read contol if any.
+// Ok, idea is, on 1st part of the memory we will put wire::FullInfo current state like
+// temperature / rpm. Each client pushes wire::Request contol into own slot after it.
 
-CSharedDevice::CSharedDevice(utility::runnerint_t should_stop) :
-    should_stop(std::move(should_stop))
+CSharedDevice::CSharedDevice(utility::runnerint_t should_stop, wire::FieldsMask fields) :
+    should_stop(std::move(should_stop)),
+    token(MakeClientToken()),
+    infoSubscriber(fields)
 {
     using namespace boost::interprocess;
 
     shared_memory_object shm(open_only, GetMemoryName(), read_write);
     shm.truncate(kWholeSharedMemSize);
     sharedMem = std::make_shared<SharedMemoryWithMutex>(std::move(shm));
+    ClaimSlot();
 }
 
 CSharedDevice::~CSharedDevice()
 {
+    sharedMem->ClientSlot(slotIndex).Release(token);
     sharedMem.reset();
 }
 
+void CSharedDevice::RequestUpdatePeriod(std::chrono::milliseconds period)
+{
+    requestedPeriod = period;
+    sharedMem->ClientSlot(slotIndex).RequestPeriod(static_cast<std::uint32_t>(period.count()));
+}
+
 const FullInfoBlock &CSharedDevice::LastKnownInfo() const
 {
     return lastKnownInfo;
 }
 
+wire::FieldsMask CSharedDevice::LastChangedFields() const
+{
+    return lastChangedFields;
+}
+
 bool CSharedDevice::PingDaemon()
 {
     static const RequestFromUi ping{RequestFromUi::RequestType::PING_DAEMON};
 
-    SendRequest(ping);
-    return UpdateInfoFromDaemon();
+    return UpdateInfoFromDaemon(SendRequest(ping));
 }
 
 bool CSharedDevice::SetBoosters(BoostersStates newState)
 {
     RequestFromUi writeBooster{RequestFromUi::RequestType::WRITE_DATA};
     writeBooster.boostersStates = newState;
-    SendRequest(writeBooster);
-    return UpdateInfoFromDaemon();
+    return UpdateInfoFromDaemon(SendRequest(writeBooster));
 }
 
 bool CSharedDevice::SetBattery(Battery newState)
 {
     RequestFromUi writeBooster{RequestFromUi::RequestType::WRITE_DATA};
     writeBooster.battery = newState;
-    SendRequest(writeBooster);
-    return UpdateInfoFromDaemon();
+    return UpdateInfoFromDaemon(SendRequest(writeBooster));
+}
+
+bool CSharedDevice::SendUserAction(RequestFromUi request)
+{
+    request.request = RequestFromUi::RequestType::WRITE_DATA;
+    return UpdateInfoFromDaemon(SendRequest(request));
+}
+
+std::uint64_t CSharedDevice::ReadHistory(std::uint64_t since, std::vector<TelemetrySample> &out)
+{
+    if (!sharedHistory)
+    {
+        using namespace boost::interprocess;
+        try
+        {
+            shared_memory_object shm(open_only, GetHistoryMemoryName(), read_only);
+            sharedHistory = std::make_shared<SharedMemory>(std::move(shm), read_only);
+        }
+        catch (std::exception &)
+        {
+            // Daemon did not create it yet.
+            return since;
+        }
+    }
+
+    const CTelemetryHistory history(sharedHistory->Ptr(), sharedHistory->Size());
+    return history.ReadSince(since, out);
+}
+
+bool CSharedDevice::ReadDaemonStats(DaemonStatsSnapshot &out)
+{
+    if (!sharedStats)
+    {
+        using namespace boost::interprocess;
+        try
+        {
+            shared_memory_object shm(open_only, GetStatsMemoryName(), read_only);
+            sharedStats = std::make_shared<SharedMemory>(std::move(shm), read_only);
+        }
+        catch (std::exception &)
+        {
+            // Daemon did not create it yet.
+            return false;
+        }
+    }
+
+    out = CDaemonStats(sharedStats->Ptr(), sharedStats->Size()).Snapshot();
+    return true;
 }
 
 bool CSharedDevice::RefreshData()
 {
     static const RequestFromUi readRequest{RequestFromUi::RequestType::READ_FRESH_DATA};
 
-    SendRequest(readRequest);
-    return UpdateInfoFromDaemon();
+    return UpdateInfoFromDaemon(SendRequest(readRequest));
 }
 
-void CSharedDevice::SendRequest(const RequestFromUi &request) const
+void CSharedDevice::ClaimSlot()
 {
-    using namespace boost::interprocess;
-    const scoped_lock<interprocess_mutex> grd(sharedMem->Mutex());
-    auto buffer = sharedMem->UI2Daemon();
-    std::ostream ss(&buffer);
-    cereal::BinaryOutputArchive oarchive(ss);
-    oarchive(request);
-    sharedMem->UIPushedForDaemon();
+    const auto now = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < SharedMemoryWithMutex::kMaxClients; ++i)
+    {
+        const auto slot = sharedMem->ClientSlot(i);
+        if (slot.TryClaim(token, now))
+        {
+            slotIndex = i;
+            slot.RequestPeriod(static_cast<std::uint32_t>(requestedPeriod.count()));
+            return;
+        }
+    }
+    throw std::runtime_error("All daemon's client slots are busy.");
 }
 
-bool CSharedDevice::UpdateInfoFromDaemon()
+std::optional<std::uint32_t> CSharedDevice::SendRequest(const RequestFromUi &request)
 {
-    using namespace boost::interprocess;
+    const auto message = CWireCodec::Encode(request);
+
+    // Ring is full only if daemon is stuck or too slow, wait it drains instead of dropping request.
+    const CPassedTime timeout(kDaemonResponseTimeout);
+    while (!(*should_stop) && !timeout)
+    {
+        // Heartbeat is refreshed only here, by requests. It must go before the ownership check, so
+        // daemon cannot reclaim the slot between the check and the push (see CClientSlot).
+        const auto slot = sharedMem->ClientSlot(slotIndex);
+        slot.Heartbeat(std::chrono::steady_clock::now());
+        if (!slot.IsOwnedBy(token))
+        {
+            // Daemon reclaims slot if we were silent too long, take any free one then.
+            ClaimSlot();
+            continue;
+        }
+
+        const auto completion = slot.Completion();
+        const auto seen = completion.Load();
+        const auto sequence = slot.Requests().TryPush(message);
+        sharedMem->UIPushedForDaemon();
+        if (sequence)
+        {
+            if (slot.IsOwnedBy(token))
+            {
+                return sequence;
+            }
+            // Slot was lost anyway, request could be dropped with it, so it is sent again.
+            continue;
+        }
+        completion.WaitChange(seen, kStopCheckPeriod);
+    }
+    return std::nullopt;
+}
+
+bool CSharedDevice::UpdateInfoFromDaemon(std::optional<std::uint32_t> sequence)
+{
+    lastChangedFields = 0;
+    if (!sequence || !WaitDaemonRead(*sequence))
+    {
+        return false;
+    }
 
-    if (!WaitDaemonRead())
+    // Snapshot is copied without mutex, daemon never waits for us. Only changed fields are copied
+    // and decoded.
+    const auto changed = infoSubscriber.Read(sharedMem->Daemon2UI());
+    if (!changed)
     {
         return false;
     }
 
     const auto old_tag = lastKnownInfo.tag;
-    const scoped_lock<interprocess_mutex> grd(sharedMem->Mutex());
-    auto buffer = sharedMem->Daemon2UI();
-    std::istream ss(&buffer);
-    cereal::BinaryInputArchive iarchive(ss);
-    iarchive(lastKnownInfo);
+    CWireCodec::Decode(infoSubscriber.Latest(), *changed, lastKnownInfo);
+    lastChangedFields = *changed;
 
     return old_tag < lastKnownInfo.tag;
 }
 
-bool CSharedDevice::WaitDaemonRead() const
+bool CSharedDevice::WaitDaemonRead(std::uint32_t sequence) const
 {
-    using namespace boost::interprocess;
-
-    constexpr auto half = kMinimumServiceDelay / 2;
-    std::this_thread::sleep_for(half);
-
-    bool ok = false;
-    for (int i = 0; !ok && i < 15 && !(*should_stop); ++i)
+    const auto completion = sharedMem->ClientSlot(slotIndex).Completion();
+    const CPassedTime timeout(kDaemonResponseTimeout);
+    while (!(*should_stop) && !timeout)
     {
-        std::this_thread::sleep_for(half);
-
-        const scoped_lock<interprocess_mutex> grd(sharedMem->Mutex());
-        ok = !sharedMem->IsUiPushed();
+        const auto seen = completion.Load();
+        if (CSpscRing::IsReached(seen, sequence))
+        {
+            return true;
+        }
+        completion.WaitChange(seen, kStopCheckPeriod);
     }
 
-    return ok;
+    return false;
 }
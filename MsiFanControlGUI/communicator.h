@@ -2,10 +2,19 @@
 
 #include "cm_ctors.h"
 #include "communicator_common.h"
+#include "daemon_stats.h"
 #include "device.h"
 #include "runners.h"
+#include "telemetry_history.h"
+#include "wire_delta.h"
+#include "wire_messages.h"
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <vector>
 
 /// @brief This is GUI side communicator
 namespace boost::interprocess {
@@ -37,7 +46,10 @@ struct CleanSharedMemory
 class CSharedDevice
 {
   public:
-    explicit CSharedDevice(utility::runnerint_t should_stop);
+    //! @param fields which are copied out of daemon's publications, other fields of the
+    //! LastKnownInfo() stay default.
+    explicit CSharedDevice(utility::runnerint_t should_stop,
+                           wire::FieldsMask fields = wire::kAllFields);
     NO_COPYMOVE(CSharedDevice);
     ~CSharedDevice();
 
@@ -45,36 +57,74 @@ class CSharedDevice
     [[nodiscard]]
     const FullInfoBlock &LastKnownInfo() const;
 
+    //! @brief Returns fields of LastKnownInfo() changed by the latest daemon's response.
+    [[nodiscard]]
+    wire::FieldsMask LastChangedFields() const;
+
     //! @brief Blocking call to read if daemon alive, does not update values from the BIOS,
-    //! but updates LastKnownInfo() local copy.
-    //! @note Call is blocking for at least kMinimumServiceDelay.
+    //! but updates LastKnownInfo() local copy with values daemon read by own schedule.
+    //! @note Call is blocking until daemon responds (or timeout).
     //! @returns true if daemon responds properly.
     [[nodiscard]]
     bool PingDaemon();
 
     //! @brief Writes desired booster state, than triggers BIOS reading,
     //! than updates LastKnownInfo() local copy.
-    //! @note Call is blocking for at least 2 * kMinimumServiceDelay.
+    //! @note Call is blocking until daemon responds (or timeout).
     //! @returns true if daemon responds properly.
     bool SetBoosters(BoostersStates newState);
     bool SetBattery(Battery newState);
 
+    //! @brief Sends everything user changed (boosters, battery, game mode) as single request and
+    //! single round trip.
+    bool SendUserAction(RequestFromUi request);
+
     //! @brief This triggers BIOS reading and IRQ-9 than updates LastKnownInfo() local copy.
     //! Try to avoid too often usage of it.
-    //! @note Call is blocking for at least kMinimumServiceDelay.
+    //! @note Call is blocking until daemon responds (or timeout).
     //! @returns true if daemon responds properly.
     bool RefreshData();
 
+    //! @brief Asks daemon to read EC not less often than @p period while this client is
+    //! connected, zero means daemon decides itself.
+    void RequestUpdatePeriod(std::chrono::milliseconds period);
+
+    //! @brief Appends to @p out daemon's telemetry history samples numbered from @p since. It does
+    //! not talk to the daemon and does not cause any EC reads.
+    //! @returns Number to pass as @p since next time.
+    std::uint64_t ReadHistory(std::uint64_t since, std::vector<TelemetrySample> &out);
+
+    //! @brief Copies daemon's self-profiling statistics into @p out. It does not talk to the
+    //! daemon.
+    //! @returns false if daemon did not create statistics yet.
+    bool ReadDaemonStats(DaemonStatsSnapshot &out);
+
   private:
-    void SendRequest(const RequestFromUi &request) const;
+    //! @brief Takes free client slot of the shared memory.
+    //! @throws std::runtime_error if all slots are busy.
+    void ClaimSlot();
+
+    //! @brief Pushes @p request into own slot. Requests are the only heartbeat of the client: slot
+    //! of the client idle for CClientSlot::kHeartbeatTimeout is reclaimed by daemon, then new one
+    //! is claimed here.
+    //! @returns sequence number of the request or std::nullopt if it could not be sent.
+    std::optional<std::uint32_t> SendRequest(const RequestFromUi &request);
 
     [[nodiscard]]
-    bool UpdateInfoFromDaemon();
+    bool UpdateInfoFromDaemon(std::optional<std::uint32_t> sequence);
 
+    //! @returns true when daemon processed request @p sequence and published response.
     [[nodiscard]]
-    bool WaitDaemonRead() const;
+    bool WaitDaemonRead(std::uint32_t sequence) const;
 
     utility::runnerint_t should_stop;
+    std::uint64_t token;
+    std::size_t slotIndex{0};
+    std::chrono::milliseconds requestedPeriod{0};
     std::shared_ptr<SharedMemoryWithMutex> sharedMem;
     FullInfoBlock lastKnownInfo;
+    std::shared_ptr<SharedMemory> sharedHistory;
+    std::shared_ptr<SharedMemory> sharedStats;
+    CWireDeltaSubscriber infoSubscriber;
+    wire::FieldsMask lastChangedFields{0};
 };
@@ -1,16 +1,14 @@
 #include "mainwindow.h" // IWYU pragma: keep
 
-#include "booster_onoff_decider.h" // IWYU pragma: keep
-#include "communicator.h"          // IWYU pragma: keep
-#include "execonmainthread.h"      // IWYU pragma: keep
-#include "gui_helpers.h"           // IWYU pragma: keep
+#include "communicator.h"     // IWYU pragma: keep
+#include "execonmainthread.h" // IWYU pragma: keep
+#include "gui_helpers.h"      // IWYU pragma: keep
 #include "lambda_visitors.h"
 #include "messages_types.h" // IWYU pragma: keep
 #include "qcheckbox.h"
 #include "qnamespace.h"
 #include "qradiobutton.h"
 #include "qtimer.h"
-#include "reads_period_detector.h"
 #include "runners.h"
 
 #include "ui_mainwindow.h" // IWYU pragma: keep
@@ -47,7 +45,6 @@
 #include <mutex>
 #include <optional>
 #include <stdexcept>
-#include <thread>
 #include <utility>
 #include <variant>
 
@@ -115,14 +112,7 @@ MainWindow::MainWindow(StartOptions options, QWidget *parent) :
 
     connect(ui->action_Game_Mode, &QAction::triggered, this, [this](bool checked) {
         ui->boostGroup->setEnabled(!checked);
-        if (checked)
-        {
-            LaunchGameMode();
-        }
-        else
-        {
-            gameModeThread.reset();
-        }
+        RequestGameMode(checked);
 
         // sync checkbox to the action
         auto block = BlockGuard(ui->cbGameMode, ui->action_Game_Mode);
@@ -181,14 +171,13 @@ MainWindow::MainWindow(StartOptions options, QWidget *parent) :
             ui->action_Game_Mode->setChecked(true);
             ui->cbGameMode->setCheckState(Qt::CheckState::Checked);
             ui->boostGroup->setEnabled(false);
-            LaunchGameMode();
+            RequestGameMode(true);
         }
     });
 }
 
 MainWindow::~MainWindow()
 {
-    gameModeThread.reset();
     communicator.reset();
     delete ui;
 }
@@ -206,47 +195,14 @@ void MainWindow::closeEvent(QCloseEvent *event)
     }
 }
 
-/// @brief Starts "game mode" thread. At this mode "smart" algorithm decides when to switch on/off
-/// different boosters. All user controls of the boosters are disabled.
-void MainWindow::LaunchGameMode()
+/// @brief Asks daemon to enable / disable "game mode". At this mode daemon's "smart" algorithm
+/// decides when to switch on/off different boosters. All user controls of the boosters are
+/// disabled.
+void MainWindow::RequestGameMode(bool enabled)
 {
-    using namespace std::chrono_literals;
-    gameModeThread = utility::startNewRunner([this](const auto &shouldStop) {
-        std::optional<BoostersStates> originalTurboBoostState;
-        const auto restoreTurboBoost = [&originalTurboBoostState, this]() {
-            if (originalTurboBoostState.has_value() && originalTurboBoostState->HasAnyChange())
-            {
-                UpdateRequestToDaemon([&originalTurboBoostState](RequestFromUi &r) {
-                    r.boostersStates = *originalTurboBoostState;
-                });
-            }
-        };
-        const ExecOnExitScope restoreTurboBoostWhenExit(restoreTurboBoost);
-
-        BoostersOnOffDecider<3> decider;
-        while (!*(shouldStop))
-        {
-            std::optional<FullInfoBlock> optInfo;
-            {
-                const std::lock_guard grd(lastReadInfoForGameModeThreadMutex);
-                std::swap(optInfo, lastReadInfoForGameModeThread);
-            }
-            if (!originalTurboBoostState.has_value() && optInfo.has_value())
-            {
-                originalTurboBoostState = BoostersStates{};
-                // Do not copy all states, just turbo boost.
-                originalTurboBoostState->cpuTurboBoostState =
-                  optInfo->boostersStates.cpuTurboBoostState;
-            }
-            const auto state = decider.ComputeUpdatedBoosterStates(optInfo);
-            if (state.HasAnyChange())
-            {
-                UpdateRequestToDaemon([&state](RequestFromUi &r) {
-                    r.boostersStates = state;
-                });
-            }
-            std::this_thread::sleep_for(kMinimumServiceDelay + 500ms);
-        };
+    BlockReadSetters(ui->cbGameMode);
+    UpdateRequestToDaemon([enabled](RequestFromUi &r) {
+        r.gameMode = enabled ? PolicyState::ON : PolicyState::OFF;
     });
 }
 
@@ -257,11 +213,12 @@ void MainWindow::CreateCommunicator()
         try
         {
             CSharedDevice comm(shouldStop);
-            bool pingOk = true;
-            const ReadsPeriodDetector refreshPeriodDetector(pingOk, comm);
+            // Daemon reads EC by own schedule, GUI only picks up what it published. Fresh read
+            // is asked once on connect and to confirm user's action.
+            bool pingOk = comm.RefreshData();
 
             bool hadUserAction = false;
-            for (std::size_t loopsCounter = 0; !(*shouldStop); ++loopsCounter)
+            while (!(*shouldStop))
             {
                 std::optional<RequestFromUi> request{std::nullopt};
                 {
@@ -271,18 +228,16 @@ void MainWindow::CreateCommunicator()
 
                 if (!request)
                 {
-                    if (hadUserAction || loopsCounter % refreshPeriodDetector() == 0)
+                    if (hadUserAction)
                     {
                         pingOk = comm.RefreshData();
                     }
                     else
                     {
-                        if (loopsCounter % 3 == 0)
+                        pingOk = comm.PingDaemon();
+                        if (!pingOk)
                         {
-                            if (!comm.PingDaemon())
-                            {
-                                throw std::runtime_error("Possibly daemon was stopped.");
-                            }
+                            throw std::runtime_error("Possibly daemon was stopped.");
                         }
                     }
                     hadUserAction = false;
@@ -292,18 +247,21 @@ void MainWindow::CreateCommunicator()
                     hadUserAction = request->HasUserAction();
                     if (hadUserAction)
                     {
-                        pingOk = comm.SetBoosters(request->boostersStates);
-                        pingOk = comm.SetBattery(request->battery) || pingOk;
+                        pingOk = comm.SendUserAction(*request);
                     }
                 }
 
-                UpdateUiWithInfo(comm.LastKnownInfo(), !pingOk);
+                UpdateUiWithInfo(comm.LastKnownInfo(), comm.LastChangedFields(), !pingOk);
                 if (*shouldStop)
                 {
                     break;
                 }
+                // User's action is sent to daemon as soon as it happened.
                 using namespace std::chrono_literals;
-                std::this_thread::sleep_for(hadUserAction ? 250ms : 1s);
+                std::unique_lock lock(requestMutex);
+                requestArrived.wait_for(lock, hadUserAction ? 250ms : 1s, [this]() {
+                    return requestToDaemon.has_value();
+                });
             }
         }
         catch (std::exception &ex)
@@ -319,44 +277,75 @@ void MainWindow::CreateCommunicator()
     });
 }
 
-void MainWindow::UpdateUiWithInfo(FullInfoBlock info, bool possiblyBrokenConn)
+void MainWindow::UpdateUiWithInfo(FullInfoBlock info, wire::FieldsMask changedFields,
+                                  bool possiblyBrokenConn)
 {
-    ExecOnMainThread::get().exec([this, info = std::move(info), possiblyBrokenConn]() mutable {
+    ExecOnMainThread::get().exec([this, info = std::move(info), changedFields,
+                                  possiblyBrokenConn]() mutable {
+        pendingUiFields |= changedFields;
+        const auto takePending = [this](wire::Field field) {
+            const auto bit = wire::FieldBit(field);
+            const bool pending = (pendingUiFields & bit) != 0;
+            pendingUiFields &= ~bit;
+            return pending;
+        };
+        const bool cpuChanged = takePending(wire::Field::CPU_INFO);
+        const bool boostersChanged = takePending(wire::Field::BOOSTERS);
+
         static const QString fmtNum("%1");
-        ui->outCpuT->setText(QString(fmtNum).arg(info.info.cpu.temperature));
-        ui->outCpuR->setText(QString(fmtNum).arg(info.info.cpu.fanRPM));
-        if (info.boostersStates.cpuTurboBoostState == CpuTurboBoostState::ON)
+        if (cpuChanged)
+        {
+            ui->outCpuT->setText(QString(fmtNum).arg(info.info.cpu.temperature));
+            ui->outCpuR->setText(QString(fmtNum).arg(info.info.cpu.fanRPM));
+        }
+        if (boostersChanged)
         {
-            if (!ui->lblCpuBoost->pixmap())
+            if (info.boostersStates.cpuTurboBoostState == CpuTurboBoostState::ON)
+            {
+                if (!ui->lblCpuBoost->pixmap())
+                {
+                    ui->lblCpuBoost->setScaledContents(true);
+                    ui->lblCpuBoost->setPixmap({":/images/boost2.png"});
+                    ui->lblCpuBoost->setToolTip(tr("Cpu's turbo-boost mode is active."));
+                }
+            }
+            else
+            {
+                ui->lblCpuBoost->clear();
+                ui->lblCpuBoost->setToolTip("");
+            }
+            if (!SetUiBooster(info.boostersStates) || !SetUiGameMode(info.gameMode))
             {
-                ui->lblCpuBoost->setScaledContents(true);
-                ui->lblCpuBoost->setPixmap({":/images/boost2.png"});
-                ui->lblCpuBoost->setToolTip(tr("Cpu's turbo-boost mode is active."));
+                pendingUiFields |= wire::FieldBit(wire::Field::BOOSTERS);
             }
         }
-        else
+        if (takePending(wire::Field::GPU_INFO))
         {
-            ui->lblCpuBoost->clear();
-            ui->lblCpuBoost->setToolTip("");
+            if (0 == info.info.gpu.temperature)
+            {
+                static const QString offline(tr("Offline"));
+                ui->outGpuT->setText(offline);
+                ui->outGpuR->setText(offline);
+            }
+            else
+            {
+                ui->outGpuT->setText(QString(fmtNum).arg(info.info.gpu.temperature));
+                ui->outGpuR->setText(QString(fmtNum).arg(info.info.gpu.fanRPM));
+            }
         }
-        if (0 == info.info.gpu.temperature)
+
+        if (takePending(wire::Field::BATTERY) && !SetUiBattery(info.battery))
         {
-            static const QString offline(tr("Offline"));
-            ui->outGpuT->setText(offline);
-            ui->outGpuR->setText(offline);
+            pendingUiFields |= wire::FieldBit(wire::Field::BATTERY);
         }
-        else
+
+        const bool behaveChanged = takePending(wire::Field::BEHAVE_AND_CURVE);
+        if (behaveChanged)
         {
-            ui->outGpuT->setText(QString(fmtNum).arg(info.info.gpu.temperature));
-            ui->outGpuR->setText(QString(fmtNum).arg(info.info.gpu.fanRPM));
+            ui->outHwProfile->setText(
+              info.behaveAndCurve.behaveState == BehaveState::AUTO ? tr("Auto") : tr("Advanced"));
         }
 
-        SetUiBooster(info.boostersStates);
-        SetUiBattery(info.battery);
-
-        ui->outHwProfile->setText(
-          info.behaveAndCurve.behaveState == BehaveState::AUTO ? tr("Auto") : tr("Advanced"));
-
         if (info.daemonDeviceException.empty())
         {
             SetDaemonConnectionStateOnGuiThread(possiblyBrokenConn ? ConnState::YELLOW
@@ -367,13 +356,17 @@ void MainWindow::UpdateUiWithInfo(FullInfoBlock info, bool possiblyBrokenConn)
             ui->statusbar->showMessage(tr("Device error: ")
                                        + QString::fromStdString(info.daemonDeviceException));
         }
+        takePending(wire::Field::DEVICE_ERROR);
 
-        SetImageIcon(info.info.cpu.temperature, Qt::green,
-                     info.boostersStates.cpuTurboBoostState == CpuTurboBoostState::ON);
-        ReadCurvesFromDaemon(std::move(info.behaveAndCurve));
-
-        const std::lock_guard grd(lastReadInfoForGameModeThreadMutex);
-        lastReadInfoForGameModeThread = std::move(info);
+        if (cpuChanged || boostersChanged)
+        {
+            SetImageIcon(info.info.cpu.temperature, Qt::green,
+                         info.boostersStates.cpuTurboBoostState == CpuTurboBoostState::ON);
+        }
+        if (behaveChanged)
+        {
+            ReadCurvesFromDaemon(std::move(info.behaveAndCurve));
+        }
     });
 }
 
@@ -389,64 +382,85 @@ void MainWindow::SetDaemonConnectionStateOnGuiThread(const ConnState state)
     setEnabled(state != ConnState::RED);
 }
 
-void MainWindow::SetUiBooster(const BoostersStates &state)
+bool MainWindow::SetUiBooster(const BoostersStates &state)
 {
-    if (!IsReadSettingBlocked(ui->btnOn))
+    if (IsReadSettingBlocked(ui->btnOn))
     {
-        auto block = BlockGuard(ui->btnOff, ui->btnOn);
-        switch (state.fanBoosterState)
-        {
-            case BoosterState::ON:
-                ui->btnOn->setChecked(true);
-                break;
-            case BoosterState::OFF:
-                ui->btnOff->setChecked(true);
-                break;
-            default:
-                break;
-        }
+        return false;
+    }
+
+    auto block = BlockGuard(ui->btnOff, ui->btnOn);
+    switch (state.fanBoosterState)
+    {
+        case BoosterState::ON:
+            ui->btnOn->setChecked(true);
+            break;
+        case BoosterState::OFF:
+            ui->btnOff->setChecked(true);
+            break;
+        default:
+            break;
     }
+    return true;
 }
 
-void MainWindow::SetUiBattery(const Battery &battery)
+bool MainWindow::SetUiGameMode(PolicyState state)
 {
-    if (!IsReadSettingBlocked(ui->rbBatBalance))
+    if (IsReadSettingBlocked(ui->cbGameMode))
     {
-        const auto errorCondition = [this](const bool setVisible) {
-            ui->groupBat->setVisible(setVisible);
-            UncheckAllBatteryButtons();
-        };
+        return false;
+    }
 
-        const sfw::LambdaVisitor visitor{
-          [this](const Battery::BatteryLevels &level) {
-              ui->groupBat->setVisible(true);
-              switch (level)
-              {
-                  case Battery::BatteryLevels::BestForBattery:
-                      ui->rbBatMin->setChecked(true);
-                      break;
-                  case Battery::BatteryLevels::Balanced:
-                      ui->rbBatBalance->setChecked(true);
-                      break;
-                  case Battery::BatteryLevels::BestForMobility:
-                      ui->rbBatMax->setChecked(true);
-                      break;
-              }
-          },
-          [&errorCondition](const Battery::TCannotDetectBatteryControlSlot &) {
-              errorCondition(false);
-          },
-          [&errorCondition](const Battery::TInvalidRange &) {
-              errorCondition(false);
-          },
-          [&errorCondition](const Battery::TLevelWasNotExact &) {
-              errorCondition(true);
-          },
-        };
+    const bool enabled = state == PolicyState::ON;
+    auto block = BlockGuard(ui->cbGameMode, ui->action_Game_Mode);
+    ui->cbGameMode->setCheckState(enabled ? Qt::CheckState::Checked : Qt::CheckState::Unchecked);
+    ui->action_Game_Mode->setChecked(enabled);
+    ui->boostGroup->setEnabled(!enabled);
+    return true;
+}
 
-        const auto block = BlockGuard(ui->rbBatBalance, ui->rbBatMax, ui->rbBatMin);
-        std::visit(visitor, battery.maxLevel);
+bool MainWindow::SetUiBattery(const Battery &battery)
+{
+    if (IsReadSettingBlocked(ui->rbBatBalance))
+    {
+        return false;
     }
+
+    const auto errorCondition = [this](const bool setVisible) {
+        ui->groupBat->setVisible(setVisible);
+        UncheckAllBatteryButtons();
+    };
+
+    const sfw::LambdaVisitor visitor{
+      [this](const Battery::BatteryLevels &level) {
+          ui->groupBat->setVisible(true);
+          switch (level)
+          {
+              case Battery::BatteryLevels::BestForBattery:
+                  ui->rbBatMin->setChecked(true);
+                  break;
+              case Battery::BatteryLevels::Balanced:
+                  ui->rbBatBalance->setChecked(true);
+                  break;
+              case Battery::BatteryLevels::BestForMobility:
+                  ui->rbBatMax->setChecked(true);
+                  break;
+          }
+      },
+      [&errorCondition](const Battery::TCannotDetectBatteryControlSlot &) {
+          errorCondition(false);
+      },
+      [&errorCondition](const Battery::TInvalidRange &) {
+          errorCondition(false);
+      },
+      [&errorCondition](const Battery::TLevelWasNotExact &) {
+          errorCondition(true);
+      },
+    };
+
+    const auto block = BlockGuard(ui->rbBatBalance, ui->rbBatMax, ui->rbBatMin);
+    std::visit(visitor, battery.maxLevel);
+    return true;
 }
 
 void MainWindow::UncheckAllBatteryButtons()
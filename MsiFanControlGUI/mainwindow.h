@@ -3,6 +3,7 @@
 #include "cm_ctors.h"       // IWYU pragma: keep
 #include "messages_types.h" // IWYU pragma: keep
 #include "passed_time.hpp"  // IWYU pragma: keep
+#include "wire_messages.h"
 
 #include <QAction>
 #include <QButtonGroup>
@@ -19,6 +20,7 @@
 #include <qtmetamacros.h>
 #include <qwidget.h>
 
+#include <condition_variable>
 #include <cstdint>
 #include <memory>
 #include <mutex>
@@ -59,7 +61,9 @@ class MainWindow final : public QMainWindow
         RED,
         YELLOW
     };
-    void UpdateUiWithInfo(FullInfoBlock info, bool possiblyBrokenConn);
+    /// @brief Updates widgets which show @p changedFields of the @p info.
+    void UpdateUiWithInfo(FullInfoBlock info, wire::FieldsMask changedFields,
+                          bool possiblyBrokenConn);
 
     // must be called on GUI thread!
     void SetDaemonConnectionStateOnGuiThread(const ConnState state);
@@ -67,16 +71,21 @@ class MainWindow final : public QMainWindow
     template <typename taCallable>
     void UpdateRequestToDaemon(const taCallable &callback)
     {
-        const std::lock_guard grd(requestMutex);
-        if (!requestToDaemon)
         {
-            requestToDaemon = RequestFromUi{};
+            const std::lock_guard grd(requestMutex);
+            if (!requestToDaemon)
+            {
+                requestToDaemon = RequestFromUi{};
+            }
+            callback(*requestToDaemon);
         }
-        callback(*requestToDaemon);
+        requestArrived.notify_one();
     }
 
-    void SetUiBooster(const BoostersStates &state);
-    void SetUiBattery(const Battery &battery);
+    /// @returns false if widget is blocked from the updates by user's action.
+    bool SetUiBooster(const BoostersStates &state);
+    bool SetUiBattery(const Battery &battery);
+    bool SetUiGameMode(PolicyState state);
     void UncheckAllBatteryButtons();
 
     ///@brief There is communication lag of writting settings than reading it back.
@@ -90,7 +99,7 @@ class MainWindow final : public QMainWindow
     /// @returns true if current data must NOT update the GUI controls yet.
     bool IsReadSettingBlocked(const QObject *whom);
 
-    void LaunchGameMode();
+    void RequestGameMode(bool enabled);
 
     void SetImageIcon(std::optional<int> value, const QColor &color = qRgba(0, 0, 0, 0),
                       const bool cpuTurboBoost = false);
@@ -100,17 +109,16 @@ class MainWindow final : public QMainWindow
     Ui::MainWindow *ui;
     std::shared_ptr<std::thread> communicator;
 
-    std::shared_ptr<std::thread> gameModeThread;
-
     std::optional<RequestFromUi> requestToDaemon;
     std::mutex requestMutex;
-
-    std::optional<FullInfoBlock> lastReadInfoForGameModeThread;
-    std::mutex lastReadInfoForGameModeThreadMutex;
+    std::condition_variable requestArrived;
 
     QPointer<QSystemTrayIcon> systemTray;
     QPointer<QButtonGroup> batButtons;
     bool closing{false};
 
+    /// @brief Fields received from daemon but not shown yet, GUI thread only.
+    wire::FieldsMask pendingUiFields{wire::kAllFields};
+
     std::unordered_map<const QObject *, std::optional<CPassedTime>> updateFromDaemonBlockers;
 };
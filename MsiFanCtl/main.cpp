@@ -0,0 +1,354 @@
+#include "communicator.h"
+#include "daemon_stats.h"
+#include "lambda_visitors.h"
+#include "messages_types.h"
+#include "sampling_scheduler.h"
+#include "telemetry_history.h"
+#include "wire_messages.h"
+
+#include <signal.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <variant>
+
+#include <boost/program_options.hpp> // IWYU pragma: keep
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/positional_options.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+// This is headless client of the daemon, it does not need Qt.
+
+namespace po = boost::program_options;
+
+namespace {
+/// @brief Exit codes.
+constexpr int kOk = 0;
+constexpr int kNoDaemon = 1;
+constexpr int kWrongUsage = 2;
+
+/// @brief Set by SIGINT / SIGTERM, so "watch" stops and releases client slot.
+utility::runnerint_t shouldStop = std::make_shared<std::atomic<bool>>(false);
+static_assert(std::atomic<bool>::is_always_lock_free, "Flag is set from the signal handler.");
+
+void onStopSignal(int)
+{
+    shouldStop->store(true);
+}
+
+const char *ToText(BoosterState state)
+{
+    switch (state)
+    {
+        case BoosterState::ON:
+            return "on";
+        case BoosterState::OFF:
+            return "off";
+        case BoosterState::NO_CHANGE:
+            break;
+    }
+    return "unknown";
+}
+
+const char *ToText(CpuTurboBoostState state)
+{
+    switch (state)
+    {
+        case CpuTurboBoostState::ON:
+            return "on";
+        case CpuTurboBoostState::OFF:
+            return "off";
+        case CpuTurboBoostState::NO_CHANGE:
+            break;
+    }
+    return "unknown";
+}
+
+const char *ToText(PolicyState state)
+{
+    return state == PolicyState::ON ? "on" : "off";
+}
+
+const char *ToText(const Battery &battery)
+{
+    const sfw::LambdaVisitor visitor{
+      [](const Battery::BatteryLevels &level) {
+          switch (level)
+          {
+              case Battery::BatteryLevels::BestForBattery:
+                  return "battery";
+              case Battery::BatteryLevels::Balanced:
+                  return "balanced";
+              case Battery::BatteryLevels::BestForMobility:
+                  return "mobility";
+          }
+          return "unknown";
+      },
+      [](const Battery::TCannotDetectBatteryControlSlot &) { return "undetected"; },
+      [](const Battery::TInvalidRange &) { return "invalid"; },
+      [](const Battery::TLevelWasNotExact &) { return "custom"; },
+    };
+    return std::visit(visitor, battery.maxLevel);
+}
+
+bool ParseOnOff(const std::string &value)
+{
+    if (value == "on")
+    {
+        return true;
+    }
+    if (value == "off")
+    {
+        return false;
+    }
+    throw std::invalid_argument("Expected 'on' or 'off', got '" + value + "'.");
+}
+
+Battery::BatteryLevels ParseBattery(const std::string &value)
+{
+    if (value == "battery")
+    {
+        return Battery::BatteryLevels::BestForBattery;
+    }
+    if (value == "balanced")
+    {
+        return Battery::BatteryLevels::Balanced;
+    }
+    if (value == "mobility")
+    {
+        return Battery::BatteryLevels::BestForMobility;
+    }
+    throw std::invalid_argument("Expected 'battery', 'balanced' or 'mobility', got '" + value
+                                + "'.");
+}
+
+/// @brief Daemon does not read EC more often than CSamplingScheduler::kBurstInterval, shorter
+/// period would only repeat the same samples.
+std::chrono::milliseconds ParsePeriod(unsigned value)
+{
+    const std::chrono::milliseconds period(value);
+    if (period < CSamplingScheduler::kBurstInterval)
+    {
+        throw std::invalid_argument(
+          "Expected period of at least "
+          + std::to_string(CSamplingScheduler::kBurstInterval.count()) + " ms, got "
+          + std::to_string(value) + " ms.");
+    }
+    return period;
+}
+
+void PrintInfo(const FullInfoBlock &info)
+{
+    std::printf("cpu_temp=%u cpu_rpm=%u gpu_temp=%u gpu_rpm=%u fan_booster=%s turbo=%s "
+                "battery=%s game_mode=%s\n",
+                info.info.cpu.temperature, info.info.cpu.fanRPM, info.info.gpu.temperature,
+                info.info.gpu.fanRPM, ToText(info.boostersStates.fanBoosterState),
+                ToText(info.boostersStates.cpuTurboBoostState), ToText(info.battery),
+                ToText(info.gameMode));
+    if (!info.daemonDeviceException.empty())
+    {
+        std::printf("error=%s\n", info.daemonDeviceException.c_str());
+    }
+}
+
+/// @brief Streams samples until stopped. Nothing is allocated per sample: only fields of
+/// TelemetrySample are subscribed and lines are formatted into the stack buffer.
+int Watch(std::chrono::milliseconds period, bool binary, std::uint64_t count)
+{
+    using namespace wire;
+    CSharedDevice comm(shouldStop,
+                       FieldBit(Field::CPU_INFO) | FieldBit(Field::GPU_INFO)
+                         | FieldBit(Field::BOOSTERS));
+    comm.RequestUpdatePeriod(period);
+
+    if (!binary)
+    {
+        std::printf("# steady_ms cpu_temp cpu_rpm gpu_temp gpu_rpm fan_booster turbo\n");
+    }
+    std::array<char, 128> line{};
+    for (std::uint64_t written = 0; !(*shouldStop) && (count == 0 || written < count); ++written)
+    {
+        const auto started = std::chrono::steady_clock::now();
+        if (!comm.PingDaemon())
+        {
+            if (*shouldStop)
+            {
+                break;
+            }
+            std::cerr << "Daemon did not respond." << std::endl;
+            return kNoDaemon;
+        }
+
+        const auto sample = TelemetrySample::From(comm.LastKnownInfo(), started);
+        if (binary)
+        {
+            std::fwrite(&sample, sizeof(sample), 1, stdout);
+        }
+        else
+        {
+            const auto len = std::snprintf(
+              line.data(), line.size(), "%lld %u %u %u %u %s %s\n",
+              static_cast<long long>(sample.steadyTimeNs / 1000000), sample.cpuTemperature,
+              sample.cpuFanRpm, sample.gpuTemperature, sample.gpuFanRpm,
+              ToText(sample.fanBoosterState), ToText(sample.cpuTurboBoostState));
+            std::fwrite(line.data(), 1, std::min<std::size_t>(len, line.size() - 1), stdout);
+        }
+        std::fflush(stdout);
+        std::this_thread::sleep_until(started + period);
+    }
+    return kOk;
+}
+
+/// @brief Prints daemon's self-profiling histograms, quantiles are upper bounds of the buckets.
+int DumpStats()
+{
+    CSharedDevice comm(shouldStop, 0);
+    DaemonStatsSnapshot stats;
+    if (!comm.ReadDaemonStats(stats))
+    {
+        std::cerr << "Daemon did not publish statistics." << std::endl;
+        return kNoDaemon;
+    }
+
+    std::printf("%-18s %10s %10s %10s %10s %10s\n", "phase", "count", "mean_us", "p50_us",
+                "p99_us", "max_us");
+    for (std::size_t i = 0; i < kCyclePhasesCount; ++i)
+    {
+        const auto &phase = stats.phases.at(i);
+        const double mean =
+          phase.count ? static_cast<double>(phase.sumNs) / static_cast<double>(phase.count) / 1e3
+                      : 0.;
+        std::printf("%-18s %10llu %10.1f %10lld %10lld %10.1f\n",
+                    CyclePhaseName(static_cast<CyclePhase>(i)),
+                    static_cast<unsigned long long>(phase.count), mean,
+                    static_cast<long long>(phase.Quantile(0.5).count()),
+                    static_cast<long long>(phase.Quantile(0.99).count()),
+                    static_cast<double>(phase.maxNs) / 1e3);
+    }
+    std::printf("overruns (cycle > %lld ms): %llu\n",
+                static_cast<long long>(CDaemonStats::kCycleBudget.count()),
+                static_cast<unsigned long long>(stats.overruns));
+    return kOk;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    po::options_description desc("Usage: msifanctl <command> [value] [options]\n"
+                                 "Commands:\n"
+                                 "  get                                    print current state\n"
+                                 "  set-booster on|off                     fan's cooler boost\n"
+                                 "  set-turbo on|off                       CPU turbo boost\n"
+                                 "  set-battery battery|balanced|mobility  max charge level\n"
+                                 "  watch                                  stream samples\n"
+                                 "  stats                                  daemon's timings\n"
+                                 "Options");
+
+    const auto periodHelp = "Watch: milliseconds between samples, at least "
+                            + std::to_string(CSamplingScheduler::kBurstInterval.count())
+                            + ". Daemon reads EC not less often.";
+    desc.add_options()("help,h", "Show this help.")(
+      "period,p", po::value<unsigned>()->default_value(1000), periodHelp.c_str())(
+      "binary,b", "Watch: write raw TelemetrySample records instead of text lines.")(
+      "count,n", po::value<std::uint64_t>()->default_value(0),
+      "Watch: stop after this many samples, 0 is endless.");
+
+    po::options_description hidden;
+    hidden.add_options()("command", po::value<std::string>())("value", po::value<std::string>());
+    po::options_description all;
+    all.add(desc).add(hidden);
+    po::positional_options_description positional;
+    positional.add("command", 1).add("value", 1);
+
+    po::variables_map vm;
+    try
+    {
+        po::store(po::command_line_parser(argc, argv).options(all).positional(positional).run(),
+                  vm);
+        po::notify(vm);
+    }
+    catch (std::exception &ex)
+    {
+        std::cerr << ex.what() << std::endl << desc << std::endl;
+        return kWrongUsage;
+    }
+
+    if (vm.count("help") || !vm.count("command"))
+    {
+        std::cout << desc << std::endl;
+        return kWrongUsage;
+    }
+
+    signal(SIGINT, onStopSignal);
+    signal(SIGTERM, onStopSignal);
+
+    const auto command = vm["command"].as<std::string>();
+    const auto value = vm.count("value") ? vm["value"].as<std::string>() : std::string();
+    try
+    {
+        if (command == "stats")
+        {
+            return DumpStats();
+        }
+        if (command == "watch")
+        {
+            return Watch(ParsePeriod(vm["period"].as<unsigned>()), vm.count("binary") > 0,
+                         vm["count"].as<std::uint64_t>());
+        }
+
+        std::optional<RequestFromUi> request;
+        if (command == "set-booster")
+        {
+            request.emplace();
+            request->boostersStates.fanBoosterState =
+              ParseOnOff(value) ? BoosterState::ON : BoosterState::OFF;
+        }
+        else if (command == "set-turbo")
+        {
+            request.emplace();
+            request->boostersStates.cpuTurboBoostState =
+              ParseOnOff(value) ? CpuTurboBoostState::ON : CpuTurboBoostState::OFF;
+        }
+        else if (command == "set-battery")
+        {
+            request.emplace();
+            request->battery.maxLevel = ParseBattery(value);
+        }
+        else if (command != "get")
+        {
+            std::cerr << "Unknown command: " << command << std::endl << desc << std::endl;
+            return kWrongUsage;
+        }
+
+        CSharedDevice comm(shouldStop);
+        const bool ok = request ? comm.SendUserAction(*request) : comm.RefreshData();
+        if (!ok)
+        {
+            std::cerr << "Daemon did not respond." << std::endl;
+            return kNoDaemon;
+        }
+        PrintInfo(comm.LastKnownInfo());
+    }
+    catch (std::invalid_argument &ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return kWrongUsage;
+    }
+    catch (std::exception &ex)
+    {
+        std::cerr << "Failed to talk to the daemon: " << ex.what() << std::endl;
+        return kNoDaemon;
+    }
+    return kOk;
+}
@@ -5,41 +5,40 @@
 #include "communicator_common.h"
 #include "csysfsprovider.h" // IWYU pragma: keep
 #include "device.h"         // IWYU pragma: keep
+#include "ec_trace.h"
 #include "messages_types.h"
 #include "msi_fan_control.h"
 #include "readwrite_provider.h" // IWYU pragma: keep
+#include "simulated_ec_provider.h"
+#include "wire_messages.h"
 
 #include <boost/interprocess/creation_tags.hpp>            // IWYU pragma: keep
 #include <boost/interprocess/detail/os_file_functions.hpp> // IWYU pragma: keep
 #include <boost/interprocess/permissions.hpp>              // IWYU pragma: keep
-#include <boost/interprocess/sync/interprocess_mutex.hpp>  // IWYU pragma: keep
-#include <boost/interprocess/sync/scoped_lock.hpp>         // IWYU pragma: keep
-
-#include <cereal/archives/binary.hpp>
-#include <cereal/types/array.hpp>   // IWYU pragma: keep
-#include <cereal/types/map.hpp>     // IWYU pragma: keep
-#include <cereal/types/string.hpp>  // IWYU pragma: keep
-#include <cereal/types/variant.hpp> // IWYU pragma: keep
-#include <cereal/types/vector.hpp>  // IWYU pragma: keep
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cstdint>
 #include <exception>
 #include <filesystem>
 #include <fstream>
 #include <ios>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <ostream>
 #include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 // This is daemon side communicator.
 
 namespace {
-// Ok, idea is, on 1st half of the memory we will put cereal serialized current state like
-// temperature / rpm. From the 2nd half we will read contol if any.
+// Ok, idea is, on 1st part of the memory we will put wire::FullInfo current state like
+// temperature / rpm. Each client has own slot after it, we read wire::Request contol from there.
 
 /// @brief Does backup of 1 liner files (should be used on sysfs).
 class BackupOneLiner
@@ -150,14 +149,43 @@ class BackupExecutorImpl final : public IBackupProvider
     const BackupOneLiner backupTurboBoost{kIntelPStateNoTurbo};
 };
 
-CSharedDevice::CSharedDevice() :
+CSharedDevice::CSharedDevice(const DeviceOptions &options,
+                             std::shared_ptr<CMetricsServer> metrics) :
     memoryCleaner(),
-    lastReadInfo()
+    lastReadInfo(),
+    policy(options.policy),
+    metrics(std::move(metrics)),
+    acpiInterrupts([this]() {
+        return acpiCounter.Read();
+    })
 {
-    // Must be 1st to create.
-    MakeBackupBlock();
+    // EC accesses are always counted, optionally recorded as well.
+    const ReadWriteProviderDecorator decorator = [this, path = options.recordTrace](
+                                                   ReadWriteProviderPtr io) {
+        if (!path.empty())
+        {
+            std::cerr << "Recording EC traffic to " << path << std::endl << std::flush;
+            io = std::make_shared<CRecordingProvider>(std::move(io), path);
+        }
+        ecCounter = std::make_shared<CCountingProvider>(std::move(io));
+        return ecCounter;
+    };
 
-    device = CreateDeviceController(std::make_shared<BackupExecutorImpl>(this), kDryRun);
+    if (options.simulate)
+    {
+        std::cerr << "Working over simulated EC. Hardware is not accessed." << std::endl
+                  << std::flush;
+        ReadWriteProviderPtr io = std::make_shared<CSimulatedEcProvider>();
+        device = CreateSimulatedDeviceController(decorator(std::move(io)));
+    }
+    else
+    {
+        // Must be 1st to create.
+        MakeBackupBlock();
+        device =
+          CreateDeviceController(std::make_shared<BackupExecutorImpl>(this), kDryRun, decorator);
+        device->SetCpuTemperatureSource(options.cpuTemperature);
+    }
     using namespace boost::interprocess;
 
     const RelaxKernel relax;
@@ -167,7 +195,19 @@ CSharedDevice::CSharedDevice() :
     shared_memory_object shm(open_or_create, GetMemoryName(), read_write, unrestricted_permissions);
     shm.truncate(kWholeSharedMemSize);
     sharedMem = std::make_shared<SharedMemoryWithMutex>(std::move(shm));
-    sharedMem->DaemonReadUI();
+
+    // Clients may only read the history.
+    permissions history_permissions;
+    history_permissions.set_permissions(kHistoryPermissions);
+    shared_memory_object history(open_or_create, GetHistoryMemoryName(), read_write,
+                                 history_permissions);
+    history.truncate(kHistorySharedMemSize);
+    sharedHistory = std::make_shared<SharedMemory>(std::move(history));
+
+    shared_memory_object statistics(open_or_create, GetStatsMemoryName(), read_write,
+                                    history_permissions);
+    statistics.truncate(kStatsSharedMemSize);
+    sharedStats = std::make_shared<SharedMemory>(std::move(statistics));
 }
 
 CSharedDevice::~CSharedDevice()
@@ -203,63 +243,307 @@ CSharedDevice::~CSharedDevice()
 
 void CSharedDevice::Communicate()
 {
-    using namespace boost::interprocess;
-
-    RequestFromUi fromUI;
+    // Must be taken before checking for request, so WaitForRequest() will not sleep over request
+    // pushed after the check.
+    seenDoorbell = sharedMem->DaemonDoorbell().Load();
+
+    const auto now = std::chrono::steady_clock::now();
+    const auto stats = Stats();
+
+    // Drain all pending requests of all clients at once, each may push many without waiting.
+    std::vector<RequestFromUi> requests;
+    std::array<bool, SharedMemoryWithMutex::kMaxClients> served{};
+    std::optional<CSamplingScheduler::Duration> clientsPeriod;
+    wire::Request message{};
+    bool hadAny = false;
+    for (std::size_t i = 0; i < served.size(); ++i)
     {
-        const scoped_lock<interprocess_mutex> grd(sharedMem->Mutex());
-        if (!sharedMem->IsUiPushed())
+        const auto slot = sharedMem->ClientSlot(i);
+        if (slot.ReclaimIfStale(now))
         {
-            return;
+            std::cerr << "Client slot " << i << " was reclaimed, client did not respond."
+                      << std::endl
+                      << std::flush;
         }
-
-        auto readUiBuffer = sharedMem->UI2Daemon();
-        std::istream ss(&readUiBuffer);
-        try
+        if (const auto periodMs = slot.RequestedPeriodMs(); periodMs > 0 && slot.IsClaimed())
         {
-            cereal::BinaryInputArchive iarchive(ss);
-            iarchive(fromUI);
+            const CSamplingScheduler::Duration period(periodMs);
+            clientsPeriod = clientsPeriod ? std::min(*clientsPeriod, period) : period;
         }
-        catch (std::exception &ex)
+
+        const auto ring = slot.Requests();
+        while (ring.TryPop(message))
         {
-            sharedMem->DaemonReadUI();
-            std::cerr << "Failed to read/parse  UI command: " << ex.what() << std::endl
-                      << std::flush;
-            return;
+            served.at(i) = true;
+            hadAny = true;
+            try
+            {
+                requests.push_back(CWireCodec::Decode(message));
+            }
+            catch (std::exception &ex)
+            {
+                std::cerr << "Failed to read/parse  UI command: " << ex.what() << std::endl
+                          << std::flush;
+            }
         }
     }
+    scheduler.LimitInterval(clientsPeriod);
+    acpiInterrupts.UpdateRate(now);
+    if (hadAny)
+    {
+        stats.Record(CyclePhase::REQUEST_PARSE, std::chrono::steady_clock::now() - now);
+        scheduler.OnClientRequest(now);
+    }
+    // Daemon reads EC by own schedule, clients do not need to ask for fresh data.
+    const bool mustSample = scheduler.IsDue(now);
+    const bool mustSampleCpu = IsCpuTemperatureDue(now);
+    if (!hadAny && !mustSample && !mustSampleCpu)
+    {
+        return;
+    }
 
-    // We have some request from UI so we must respond with at least incremented tag.
+    // Each publication has new tag, GUI waiting for the response checks it.
     ++lastReadInfo.tag;
 
-    if (fromUI.request != RequestFromUi::RequestType::PING_DAEMON)
+    bool mustRead = mustSample;
+    std::optional<PolicyState> gameMode;
+    std::optional<std::string> writeError;
     {
-        if (fromUI.request == RequestFromUi::RequestType::WRITE_DATA)
+        // All writes are sent to EC as single transaction, later request wins on the same register.
+        const CPhaseTimer timer(stats, CyclePhase::EC_WRITE);
+        // Counter is not sampled if there is nothing to write, it costs reading of /proc.
+        if (!requests.empty())
         {
-            // Write data sent by UI.
-            device->SetBoosters(fromUI.boostersStates);
-            device->SetBattery(fromUI.battery);
+            acpiInterrupts.Begin();
+        }
+        for (const auto &fromUI : requests)
+        {
+            if (fromUI.gameMode != PolicyState::NO_CHANGE)
+            {
+                gameMode = fromUI.gameMode;
+            }
+            mustRead = mustRead || fromUI.request != RequestFromUi::RequestType::PING_DAEMON;
         }
+        try
+        {
+            auto session = device->StartWrites();
+            for (const auto &fromUI : requests)
+            {
+                if (fromUI.request == RequestFromUi::RequestType::WRITE_DATA)
+                {
+                    device->SetBoosters(fromUI.boostersStates, session);
+                    device->SetBattery(fromUI.battery, session);
+                }
+            }
+            device->CommitWrites(session);
+        }
+        catch (std::exception &ex)
+        {
+            // Failed write must not stop the daemon, client sees the error in the published info.
+            writeError = std::string(ex.what()).substr(0, wire::kMaxErrorText - 1);
+            std::cerr << "Failure writing UI command: " << ex.what() << std::endl << ::std::flush;
+        }
+        if (!requests.empty())
+        {
+            acpiInterrupts.End(InterruptCause::CLIENT_REQUEST);
+        }
+    }
 
+    bool isFresh = false;
+    if (mustRead)
+    {
         // Read fresh data from BIOS
+        const CPhaseTimer timer(stats, CyclePhase::EC_READ);
+        const auto bytesBefore = device->BytesReadByClass();
+        acpiInterrupts.Begin();
         try
         {
             lastReadInfo = device->ReadFullInformation(lastReadInfo.tag);
+            isFresh = true;
         }
         catch (std::exception &ex)
         {
-            lastReadInfo.daemonDeviceException = ex.what();
+            // Text is clipped, so it fits fixed size wire::FullInfo.
+            lastReadInfo.daemonDeviceException =
+              std::string(ex.what()).substr(0, wire::kMaxErrorText - 1);
             std::cerr << "Failure reading info: " << ex.what() << std::endl << ::std::flush;
         }
+        auto bytesRead = device->BytesReadByClass();
+        for (std::size_t i = 0; i < bytesRead.size(); ++i)
+        {
+            bytesRead.at(i) -= bytesBefore.at(i);
+        }
+        acpiInterrupts.End(bytesRead);
+        if (isFresh)
+        {
+            RecordHistory();
+        }
+        // Failed read is accounted too, so broken EC is not polled in tight loop.
+        scheduler.OnSample(now, static_cast<float>(lastReadInfo.info.cpu.temperature));
+        lastCpuTemperatureSample = now;
+    }
+    else if (mustSampleCpu)
+    {
+        // Cheap path, GPU and fans keep values of the last EC read.
+        const CPhaseTimer timer(stats, CyclePhase::EC_READ);
+        const auto sampledAt = Info::SampleClock::now();
+        if (const auto cpuTemperature = device->ReadCpuTemperature())
+        {
+            lastReadInfo.info.cpu.SetTemperatureMilli(*cpuTemperature);
+            lastReadInfo.info.cpu.SetSampledAt(sampledAt);
+            isFresh = true;
+        }
+        lastCpuTemperatureSample = now;
+    }
+    if (writeError)
+    {
+        // Fresh read must not hide the error.
+        lastReadInfo.daemonDeviceException = std::move(*writeError);
     }
+    ApplyPolicy(gameMode, isFresh, stats);
+    scheduler.SetPolicyEnabled(policy.IsEnabled());
 
-    const scoped_lock<interprocess_mutex> grd(sharedMem->Mutex());
-    auto daemonWritebuffer = sharedMem->Daemon2UI();
-    std::ostream ss(&daemonWritebuffer);
-    cereal::BinaryOutputArchive oarchive(ss);
-    oarchive(lastReadInfo);
+    {
+        // Publishing does not wait for readers, only changed fields are written.
+        const CPhaseTimer timer(stats, CyclePhase::SERIALIZE_PUBLISH);
+        infoPublisher.Publish(sharedMem->Daemon2UI(), lastReadInfo);
+        for (std::size_t i = 0; i < served.size(); ++i)
+        {
+            if (served.at(i))
+            {
+                const auto slot = sharedMem->ClientSlot(i);
+                slot.Completion().Publish(slot.Requests().Consumed());
+            }
+        }
+    }
+    ExportMetrics(stats);
+
+    const auto cycle = std::chrono::steady_clock::now() - now;
+    loopStatistics.Account(cycle);
+    stats.Record(CyclePhase::CYCLE, cycle);
+}
+
+void CSharedDevice::ApplyPolicy(std::optional<PolicyState> request, bool isFresh,
+                                const CDaemonStats &stats)
+{
+    BoostersStates decision;
+    if (request == PolicyState::ON)
+    {
+        policy.Enable(lastReadInfo.boostersStates);
+    }
+    else if (request == PolicyState::OFF)
+    {
+        decision = policy.Disable();
+    }
+    if (isFresh && policy.IsEnabled())
+    {
+        decision = policy.Decide(lastReadInfo);
+    }
+    lastReadInfo.gameMode = policy.State();
+
+    if (!decision.HasAnyChange())
+    {
+        return;
+    }
+    try
+    {
+        const CPhaseTimer timer(stats, CyclePhase::EC_WRITE);
+        acpiInterrupts.Begin();
+        auto session = device->StartWrites();
+        device->SetBoosters(decision, session);
+        device->CommitWrites(session);
+        acpiInterrupts.End(InterruptCause::POLICY);
+
+        // Written values are published right away, the next read confirms them.
+        if (decision.fanBoosterState != BoosterState::NO_CHANGE)
+        {
+            lastReadInfo.boostersStates.fanBoosterState = decision.fanBoosterState;
+        }
+        if (decision.cpuTurboBoostState != CpuTurboBoostState::NO_CHANGE)
+        {
+            lastReadInfo.boostersStates.cpuTurboBoostState = decision.cpuTurboBoostState;
+        }
+    }
+    catch (std::exception &ex)
+    {
+        std::cerr << "Failure applying game mode: " << ex.what() << std::endl << ::std::flush;
+    }
+}
+
+std::chrono::milliseconds CSharedDevice::WaitPeriod() const
+{
+    using namespace std::chrono;
+    const auto now = steady_clock::now();
+    auto res = std::min(scheduler.TimeToNextSample(now),
+                        duration_cast<milliseconds>(kDaemonHousekeepingPeriod));
+    if (device->HasCpuTemperatureSource() && scheduler.IsActive(now) && lastCpuTemperatureSample)
+    {
+        const auto left = *lastCpuTemperatureSample + kCpuTemperaturePeriod - now;
+        res = std::min(res, std::max(duration_cast<milliseconds>(left), milliseconds(0)));
+    }
+    return res;
+}
+
+bool CSharedDevice::IsCpuTemperatureDue(std::chrono::steady_clock::time_point now) const
+{
+    return device->HasCpuTemperatureSource() && scheduler.IsActive(now)
+           && (!lastCpuTemperatureSample || now - *lastCpuTemperatureSample >= kCpuTemperaturePeriod);
+}
+
+void CSharedDevice::RecordHistory()
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (lastHistorySample && now - *lastHistorySample < kHistoryPeriod)
+    {
+        return;
+    }
+    lastHistorySample = now;
+
+    const CTelemetryHistory history(sharedHistory->Ptr(), sharedHistory->Size());
+    auto sample = TelemetrySample::From(lastReadInfo, now);
+    sample.acpiInterruptsPerSecond = static_cast<std::uint16_t>(
+      std::min(acpiInterrupts.Statistics().perSecond,
+               static_cast<double>(std::numeric_limits<std::uint16_t>::max())));
+    history.Append(sample);
+}
+
+void CSharedDevice::ExportMetrics(const CDaemonStats &stats)
+{
+    if (!metrics)
+    {
+        return;
+    }
+    // Text is formatted here, so scraping never touches EC or lastReadInfo.
+    FormatOpenMetrics(lastReadInfo, ecCounter ? ecCounter->Statistics() : EcTrafficStatistics{},
+                      loopStatistics,
+                      acpiInterrupts.IsAvailable() ? &acpiInterrupts.Statistics() : nullptr,
+                      metricsText);
+    const CPhaseTimer timer(stats, CyclePhase::METRICS_PUBLISH);
+    metrics->Publish(metricsText);
+}
+
+CDaemonStats CSharedDevice::Stats() const
+{
+    return {sharedStats->Ptr(), sharedStats->Size()};
+}
+
+void CSharedDevice::WaitForRequest(std::chrono::milliseconds timeout) const
+{
+    if (!IsInterrupted())
+    {
+        sharedMem->DaemonDoorbell().WaitChange(seenDoorbell, timeout);
+    }
+}
 
-    sharedMem->DaemonReadUI();
+void CSharedDevice::Interrupt()
+{
+    interrupted = true;
+    sharedMem->DaemonDoorbell().Signal();
+}
+
+bool CSharedDevice::IsInterrupted() const
+{
+    return interrupted;
 }
 
 void CSharedDevice::RestoreOffsets(const std::set<int64_t> &offsetsToRestoreFromBackup) const
@@ -271,14 +555,15 @@ void CSharedDevice::RestoreOffsets(const std::set<int64_t> &offsetsToRestoreFrom
         {
             // copy ACPI file to shared memory which we just allocated. It should persist between
             // runs and keep 1st run copy, i.e. original data.
-            auto stream = CSysFsProvider::CreateIoDirect(kDryRun)->WriteStream();
+            const auto io = CSysFsProvider::CreateIoDirect(kDryRun);
             for (const auto &offset : offsetsToRestoreFromBackup)
             {
                 try
                 {
-                    stream.seekp(offset);
                     // NOLINTNEXTLINE
-                    stream.write(sharedBackup->Ptr() + offset, 1);
+                    io->WriteBytes(offset, reinterpret_cast<const std::uint8_t *>(
+                                             sharedBackup->Ptr() + offset),
+                                   1);
                 }
                 catch (std::exception &ex)
                 {
@@ -315,8 +600,9 @@ bool CSharedDevice::MakeBackupBlock()
             // copy ACPI file to shared memory which we just allocated. It should persist between
             // runs and keep 1st run copy, i.e. original data.
             const auto io = CSysFsProvider::CreateIoDirect(kDryRun);
-            io->ReadStream().read(sharedBackup->Ptr(),
-                                  static_cast<std::int64_t>(sharedBackup->Size()));
+            // NOLINTNEXTLINE
+            io->ReadBytes(0, reinterpret_cast<std::uint8_t *>(sharedBackup->Ptr()),
+                          sharedBackup->Size());
         }
         catch (std::exception &ex)
         {
@@ -1,12 +1,28 @@
 #pragma once
 
+#include "acpi_interrupts.h"
 #include "cm_ctors.h"
 #include "communicator_common.h"
+#include "cpu_temperature_source.h"
+#include "daemon_stats.h"
 #include "device.h"
+#include "ec_trace.h"
+#include "metrics_server.h"
+#include "openmetrics.h"
+#include "policy_engine.h"
+#include "policy_parameters.h"
+#include "sampling_scheduler.h"
+#include "telemetry_history.h"
+#include "wire_delta.h"
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <filesystem>
 #include <memory>
+#include <optional>
 #include <set>
+#include <string>
 
 /// @brief This is daemon side communicator.
 
@@ -19,19 +35,54 @@ class mapped_region;
 class CDevice;
 
 static inline constexpr auto kBackupSharedSize = 256;
+/// @brief Telemetry history and statistics are writable by daemon only.
+static inline constexpr auto kHistoryPermissions = 0644;
+/// @brief CPU temperature is read this often without EC while somebody uses the data.
+static inline constexpr auto kCpuTemperaturePeriod = std::chrono::milliseconds(500);
+
+/// @brief How daemon accesses EC.
+struct DeviceOptions
+{
+    /// If true, daemon works over simulated EC with thermal model instead of the real hardware.
+    /// Nothing is backed up or restored then.
+    bool simulate{false};
+    /// If not empty, all EC accesses are recorded to this file (see CRecordingProvider).
+    std::filesystem::path recordTrace;
+    /// If not null, CPU temperature is read from it instead of EC. It must be created before
+    /// seccomp is engaged (see CHwmonCpuTemperature::Create()).
+    CpuTemperatureSourcePtr cpuTemperature;
+    /// Thresholds of the "game mode", i.e. tuned for this model by msifantune.
+    PolicyParameters policy;
+};
 
 /// @brief Main daemon's logic.
 /// Also it keeps backup of BIOS' "file", so any changes can be reverted out of backup.
 class CSharedDevice
 {
   public:
-    CSharedDevice();
+    /// @param metrics if not null, daemon's state is published there after each cycle.
+    explicit CSharedDevice(const DeviceOptions &options = {},
+                           std::shared_ptr<CMetricsServer> metrics = nullptr);
     NO_COPYMOVE(CSharedDevice);
     ~CSharedDevice();
 
     /// @brief Do 1 step if I/O communication with GUI. Process it's orders, make proper responses.
     void Communicate();
 
+    /// @brief Blocks until GUI pushes request, Interrupt() is called or @p timeout passed.
+    /// Request pushed after last Communicate() started is never missed.
+    void WaitForRequest(std::chrono::milliseconds timeout) const;
+
+    /// @returns How long WaitForRequest() may sleep before next Communicate() is due.
+    [[nodiscard]]
+    std::chrono::milliseconds WaitPeriod() const;
+
+    /// @brief Wakes up WaitForRequest() and marks object as interrupted. It is thread-safe.
+    void Interrupt();
+
+    [[nodiscard]]
+    bool IsInterrupted() const;
+
   private:
     /// @brief This object removes shared memory block when created and destroyed.
     struct CleanSharedMemory
@@ -51,16 +102,55 @@ class CSharedDevice
         {
             using namespace boost::interprocess;
             shared_memory_object::remove(GetMemoryName());
+            shared_memory_object::remove(GetHistoryMemoryName());
+            shared_memory_object::remove(GetStatsMemoryName());
         }
     };
     friend class BackupExecutorImpl;
     void RestoreOffsets(const std::set<int64_t> &offsetsToRestoreFromBackup) const;
     bool MakeBackupBlock();
 
+    /// @brief Enables / disables policy engine by @p request and writes its decision when
+    /// lastReadInfo @p isFresh.
+    void ApplyPolicy(std::optional<PolicyState> request, bool isFresh, const CDaemonStats &stats);
+
+    /// @returns true if CPU temperature should be read by the cheap path (no EC) at @p now.
+    [[nodiscard]]
+    bool IsCpuTemperatureDue(std::chrono::steady_clock::time_point now) const;
+
+    /// @brief Appends fresh lastReadInfo to the history, but not more often than kHistoryPeriod.
+    void RecordHistory();
+
+    /// @brief Formats current state for the metrics server if there is one.
+    void ExportMetrics(const CDaemonStats &stats);
+
+    /// @brief Self-profiling statistics in the shared memory.
+    [[nodiscard]]
+    CDaemonStats Stats() const;
+
     CleanSharedMemory memoryCleaner;
     FullInfoBlock lastReadInfo;
+    CWireDeltaPublisher infoPublisher;
     std::shared_ptr<CDevice> device;
     std::shared_ptr<SharedMemoryWithMutex> sharedMem;
+    std::uint32_t seenDoorbell{0};
+    std::atomic<bool> interrupted{false};
 
     std::shared_ptr<SharedMemory> sharedBackup;
+
+    std::shared_ptr<SharedMemory> sharedHistory;
+    std::optional<std::chrono::steady_clock::time_point> lastHistorySample;
+
+    std::shared_ptr<SharedMemory> sharedStats;
+
+    CPolicyEngine policy;
+    CSamplingScheduler scheduler;
+    std::optional<std::chrono::steady_clock::time_point> lastCpuTemperatureSample;
+
+    std::shared_ptr<CCountingProvider> ecCounter;
+    std::shared_ptr<CMetricsServer> metrics;
+    DaemonLoopStatistics loopStatistics;
+    CAcpiInterruptCounter acpiCounter;
+    CAcpiInterruptAccounting acpiInterrupts;
+    std::string metricsText;
 };
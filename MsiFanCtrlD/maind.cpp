@@ -1,5 +1,9 @@
+#include "cm_ctors.h"
 #include "communicator.h"
+#include "cpu_temperature_source.h"
 #include "messages_types.h"
+#include "metrics_server.h"
+#include "policy_parameters.h"
 #include "runners.h"
 #include "seccomp_wrapper.hpp"
 
@@ -7,12 +11,18 @@
 #include <cerrno>
 #include <cstring>
 #include <exception>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <ostream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <vector>
 
 #include <systemd/sd-daemon.h>
 
@@ -26,22 +36,53 @@ namespace {
 // Note, security blocks thread creation calls (which includes it would block forks()).
 // So we have to wait thread launched, than engage security.
 std::mutex runThreadAfterSecurity;
+
+// Device served by the thread. Main thread uses it to wake the thread up on shutdown.
+std::mutex activeDeviceAccess;
+CSharedDevice *activeDevice{nullptr};
+
+/// @brief Publishes device to the main thread while alive.
+struct ActiveDeviceRegistration
+{
+    NO_COPYMOVE(ActiveDeviceRegistration);
+    explicit ActiveDeviceRegistration(CSharedDevice &device)
+    {
+        const std::lock_guard grd(activeDeviceAccess);
+        activeDevice = &device;
+    }
+
+    ~ActiveDeviceRegistration()
+    {
+        const std::lock_guard grd(activeDeviceAccess);
+        activeDevice = nullptr;
+    }
+};
+
+void interruptActiveDevice()
+{
+    const std::lock_guard grd(activeDeviceAccess);
+    if (activeDevice)
+    {
+        activeDevice->Interrupt();
+    }
+}
 } // namespace
 
 // NOLINTNEXTLINE
-void threadBody(const utility::runnerint_t shouldStop)
+void threadBody(const utility::runnerint_t shouldStop, const DeviceOptions &options,
+                const std::shared_ptr<CMetricsServer> &metrics)
 {
     const std::lock_guard delayedStart(runThreadAfterSecurity);
     try
     {
-        CSharedDevice sharedDevice;
+        CSharedDevice sharedDevice(options, metrics);
+        const ActiveDeviceRegistration registration(sharedDevice);
         sd_notify(0, "READY=1");
 
-        while (!(*shouldStop))
+        while (!(*shouldStop) && !sharedDevice.IsInterrupted())
         {
             sharedDevice.Communicate();
-            using namespace std::chrono_literals;
-            std::this_thread::sleep_for(kMinimumServiceDelay);
+            sharedDevice.WaitForRequest(sharedDevice.WaitPeriod());
         }
     }
     catch (std::exception &l_exception)
@@ -57,6 +98,10 @@ void threadBody(const utility::runnerint_t shouldStop)
 int main(int argc, const char **argv)
 {
     constexpr auto kRestrict = "--restrict";
+    constexpr auto kSimulate = "--simulate";
+    constexpr std::string_view kRecord = "--record=";
+    constexpr std::string_view kMetrics = "--metrics=";
+    constexpr std::string_view kPolicy = "--policy=";
     (void)argc;
     (void)argv;
 
@@ -69,14 +114,80 @@ int main(int argc, const char **argv)
         // NOLINTNEXTLINE
         sigprocmask(SIG_BLOCK, &l_waitedSignals, nullptr);
 
+        const auto hasParameter = [argc, argv](const char *const expected) {
+            return argc > 1 && std::any_of(argv, argv + argc, [expected](const char *const param) {
+                       return strcmp(param, expected) == 0;
+                   });
+        };
+        const bool isSecurityEnabled = hasParameter(kRestrict);
+        DeviceOptions deviceOptions;
+        deviceOptions.simulate = hasParameter(kSimulate);
+        std::filesystem::path metricsSocket;
+        std::filesystem::path policyFile;
+        for (const auto *const param : std::vector<const char *>(argv, argv + argc))
+        {
+            const std::string_view value(param);
+            if (value.substr(0, kRecord.size()) == kRecord)
+            {
+                deviceOptions.recordTrace = value.substr(kRecord.size());
+            }
+            if (value.substr(0, kMetrics.size()) == kMetrics)
+            {
+                metricsSocket = value.substr(kMetrics.size());
+            }
+            if (value.substr(0, kPolicy.size()) == kPolicy)
+            {
+                policyFile = value.substr(kPolicy.size());
+            }
+        }
+
+        // Tuned parameters are optional, broken file must not prevent fans control.
+        if (!policyFile.empty())
+        {
+            try
+            {
+                std::ifstream input(policyFile);
+                if (!input)
+                {
+                    throw std::runtime_error("can not open " + policyFile.string());
+                }
+                deviceOptions.policy = PolicyParameters::Load(input);
+                std::cerr << "Game mode parameters are loaded from " << policyFile << std::endl
+                          << std::flush;
+            }
+            catch (std::exception &ex)
+            {
+                std::cerr << "Default game mode parameters are used: " << ex.what() << std::endl
+                          << std::flush;
+            }
+        }
+
+        // Looking for hwmon needs directory listing, which is blocked once security is engaged.
+        if (!deviceOptions.simulate)
+        {
+            deviceOptions.cpuTemperature = CHwmonCpuTemperature::Create();
+        }
+
+        // Socket and its thread must be created before security is engaged.
+        std::shared_ptr<CMetricsServer> metrics;
+        if (!metricsSocket.empty())
+        {
+            try
+            {
+                metrics = std::make_shared<CMetricsServer>(metricsSocket);
+            }
+            catch (std::exception &ex)
+            {
+                std::cerr << "Metrics are disabled: " << ex.what() << std::endl << std::flush;
+            }
+        }
+
         std::optional<std::lock_guard<std::mutex>> delayedStart;
         delayedStart.emplace(runThreadAfterSecurity);
-        auto thread = utility::startNewRunner(threadBody);
+        auto thread = utility::startNewRunner([deviceOptions, metrics](const auto &shouldStop) {
+            threadBody(shouldStop, deviceOptions, metrics);
+        });
 
-        const bool isSecurityEnabled =
-          argc > 1 && std::any_of(argv, argv + argc, [](const char *const param) {
-              return strcmp(param, kRestrict) == 0;
-          });
         auto kernelSecurity = isSecurityEnabled ? CSecCompWrapper::Allocate() : nullptr;
         const bool securityEngaged = kernelSecurity && kernelSecurity->Engage();
         delayedStart.reset();
@@ -107,6 +218,7 @@ int main(int argc, const char **argv)
 
         // Stop all threading operations
         std::cerr << "Stopping thread...";
+        interruptActiveDevice();
         thread.reset();
         std::cerr << "Thread was stopped...";
 
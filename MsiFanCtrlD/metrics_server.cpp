@@ -0,0 +1,151 @@
+#include "metrics_server.h"
+
+#include "runners.h"
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace {
+/// @brief Snapshot is few KB, buffers are reserved once.
+constexpr std::size_t kSnapshotReserve = 4096;
+
+[[noreturn]]
+void ThrowErrno(const std::string &what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+} // namespace
+
+CMetricsServer::CMetricsServer(std::filesystem::path aSocketPath) :
+    socketPath(std::move(aSocketPath))
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    const auto &native = socketPath.native();
+    if (native.empty() || native.size() >= sizeof(address.sun_path))
+    {
+        throw std::invalid_argument("Wrong metrics socket path: " + native);
+    }
+    std::memcpy(address.sun_path, native.c_str(), native.size() + 1);
+
+    snapshot.reserve(kSnapshotReserve);
+    sending.reserve(kSnapshotReserve);
+    snapshot = "# EOF\n";
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0)
+    {
+        ThrowErrno("Cannot create metrics socket");
+    }
+    // Previous daemon's run could leave it.
+    std::error_code ignored;
+    std::filesystem::remove(socketPath, ignored);
+
+    // NOLINTNEXTLINE
+    if (bind(listenFd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0
+        || chmod(native.c_str(), 0666) != 0 || listen(listenFd, SOMAXCONN) != 0)
+    {
+        const auto error = errno;
+        close(listenFd);
+        errno = error;
+        ThrowErrno("Cannot listen on metrics socket " + native);
+    }
+
+    stopFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (stopFd < 0)
+    {
+        const auto error = errno;
+        close(listenFd);
+        errno = error;
+        ThrowErrno("Cannot create metrics eventfd");
+    }
+
+    runner = utility::startNewRunner([this](const auto &shouldStop) {
+        Serve(shouldStop);
+    });
+}
+
+CMetricsServer::~CMetricsServer()
+{
+    const std::uint64_t one = 1;
+    (void)write(stopFd, &one, sizeof(one));
+    runner.reset();
+
+    close(stopFd);
+    close(listenFd);
+    std::error_code ignored;
+    std::filesystem::remove(socketPath, ignored);
+}
+
+void CMetricsServer::Publish(std::string &formatted)
+{
+    const std::lock_guard grd(snapshotMutex);
+    std::swap(snapshot, formatted);
+}
+
+void CMetricsServer::Serve(const utility::runnerint_t &shouldStop)
+{
+    std::array<pollfd, 2> fds{};
+    fds[0].fd = listenFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = stopFd;
+    fds[1].events = POLLIN;
+
+    while (!(*shouldStop))
+    {
+        if (ppoll(fds.data(), fds.size(), nullptr, nullptr) < 0 && errno != EINTR)
+        {
+            break;
+        }
+        if (fds[1].revents != 0)
+        {
+            break;
+        }
+        if ((fds[0].revents & POLLIN) == 0)
+        {
+            continue;
+        }
+
+        const int clientFd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (clientFd >= 0)
+        {
+            Answer(clientFd);
+            close(clientFd);
+        }
+    }
+}
+
+void CMetricsServer::Answer(int clientFd)
+{
+    {
+        const std::lock_guard grd(snapshotMutex);
+        sending.assign(snapshot);
+    }
+
+    // Socket is non-blocking, client which does not read is not waited.
+    std::size_t sent = 0;
+    while (sent < sending.size())
+    {
+        const auto res =
+          send(clientFd, sending.data() + sent, sending.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (res <= 0)
+        {
+            break;
+        }
+        sent += static_cast<std::size_t>(res);
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "cm_ctors.h"
+#include "runners.h"
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/// @brief Serves daemon's metrics (OpenMetrics text) over UNIX domain socket. Each connected
+/// client receives the latest snapshot and the connection is closed, i.e.
+/// `socat - UNIX-CONNECT:/path` prints it.
+///
+/// Socket and serving thread are created in constructor, so it must be done before seccomp is
+/// engaged. Control loop only swaps preformatted buffer by Publish(), it never waits for the
+/// clients: sockets are non-blocking and slow client just gets truncated answer.
+class CMetricsServer
+{
+  public:
+    explicit CMetricsServer(std::filesystem::path socketPath);
+    NO_COPYMOVE(CMetricsServer);
+    ~CMetricsServer();
+
+    /// @brief Makes @p formatted the snapshot served to the clients. Buffers are swapped, so
+    /// @p formatted receives older snapshot's buffer and can be re-used without allocations.
+    void Publish(std::string &formatted);
+
+  private:
+    std::filesystem::path socketPath;
+    int listenFd{-1};
+    int stopFd{-1};
+
+    std::mutex snapshotMutex;
+    std::string snapshot;
+    std::string sending;
+
+    std::shared_ptr<std::thread> runner;
+
+    void Serve(const utility::runnerint_t &shouldStop);
+    void Answer(int clientFd);
+};
@@ -8,6 +8,7 @@
 #include <linux/futex.h>
 #include <seccomp.h>
 #include <sys/mman.h>
+#include <sys/socket.h>
 #include <sys/wait.h>
 
 #include <bits/types.h>
@@ -116,9 +117,12 @@ class CSecCompWrapper
             return InstallOpenAt() && InstallMMapUnmap() && InstallMProtect()
                    && InstallAllowRule(SCMP_SYS(fstat)) && InstallAllowRule(SCMP_SYS(write))
                    && InstallAllowRule(SCMP_SYS(read)) && InstallAllowRule(SCMP_SYS(close))
+                   && InstallAllowRule(SCMP_SYS(pread64)) && InstallAllowRule(SCMP_SYS(pwrite64))
 
                    && InstallAllowRule(SCMP_SYS(unlink))
                    && InstallAllowRule(SCMP_SYS(fchmod), Equals<__mode_t>(1u, 0666))
+                   && InstallAllowRule(SCMP_SYS(fchmod),
+                                       Equals<__mode_t>(1u, kHistoryPermissions))
 
                    && InstallAllowRule(SCMP_SYS(exit_group)) && InstallAllowRule(SCMP_SYS(exit))
                    && InstallAllowRule(SCMP_SYS(waitpid)) && InstallAllowRule(SCMP_SYS(waitid))
@@ -130,15 +134,33 @@ class CSecCompWrapper
                    && InstallAllowRule(SCMP_SYS(rt_sigprocmask))
                    && InstallAllowRule(SCMP_SYS(rt_sigaction))
 
-                   && InstallAllowRule(SCMP_SYS(fallocate), Equals<int>(1u, 0),
-                                       Equals<__off_t>(2u, 0),
-                                       Equals<__off_t>(3u, kWholeSharedMemSize))
-                   && InstallAllowRule(SCMP_SYS(ftruncate),
-                                       Equals<__off_t>(1u, kWholeSharedMemSize));
+                   && InstallMetrics()
+
+                   && InstallTruncate(kWholeSharedMemSize)
+                   && InstallTruncate(kHistorySharedMemSize)
+                   && InstallTruncate(kStatsSharedMemSize);
         }
         return false;
     }
 
+    /// @brief Metrics socket is created before, only serving it is allowed (see CMetricsServer).
+    [[nodiscard]]
+    bool InstallMetrics() const
+    {
+        return InstallAllowRule(SCMP_SYS(ppoll))
+               && InstallAllowRule(SCMP_SYS(accept4), Equals<int>(3u, SOCK_NONBLOCK | SOCK_CLOEXEC))
+               && InstallAllowRule(SCMP_SYS(sendto), Equals<int>(3u, MSG_NOSIGNAL | MSG_DONTWAIT));
+    }
+
+    /// @brief Allows to set size of the shared memory block to @p size.
+    [[nodiscard]]
+    bool InstallTruncate(std::size_t size) const
+    {
+        return InstallAllowRule(SCMP_SYS(fallocate), Equals<int>(1u, 0), Equals<__off_t>(2u, 0),
+                                Equals<__off_t>(3u, size))
+               && InstallAllowRule(SCMP_SYS(ftruncate), Equals<__off_t>(1u, size));
+    }
+
     [[nodiscard]]
     bool InstallMMapUnmap() const
     {
@@ -150,7 +172,8 @@ class CSecCompWrapper
               Equals<int>(2u, PROT_READ | PROT_WRITE), Equals<int>(3u, MAP_SHARED));
         };
 
-        res = res && installCommMMap(kWholeSharedMemSize) && installCommMMap(kBackupSharedSize);
+        res = res && installCommMMap(kWholeSharedMemSize) && installCommMMap(kBackupSharedSize)
+              && installCommMMap(kHistorySharedMemSize) && installCommMMap(kStatsSharedMemSize);
         res = res
               && InstallAllowRule(SCMP_SYS(mmap), Equals<void *>(0u, NULL),
                                   /*Skipping size at index 1*/
@@ -174,13 +197,20 @@ class CSecCompWrapper
     [[nodiscard]]
     bool InstallOpenAt() const
     {
+        // Device thread opens its files after security is engaged, so each flag set it uses is
+        // listed. EC "file" is opened once and kept opened, there is no open per access of it.
         const static std::vector<int> oflags = {
+          // std::ifstream: turbo-boost state and backups of the sysfs one-liners.
           O_RDONLY,
+          // ACPI interrupt counters.
           O_RDONLY | O_CLOEXEC,
+          // std::ofstream: turbo-boost switch and restoring of the sysfs one-liners.
           O_WRONLY | O_CREAT | O_TRUNC,
+          // EC "file".
+          O_RDWR | O_CLOEXEC,
+          // Shared memory: created or opened existing.
           O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC,
           O_RDWR | O_NOFOLLOW | O_CLOEXEC,
-          O_WRONLY | O_CREAT | O_TRUNC,
         };
 
         bool res = true;
@@ -0,0 +1,193 @@
+#include "policy_engine.h"
+#include "policy_parameters.h"
+#include "policy_replay.h"
+#include "telemetry_history.h"
+#include "thermal_plant.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp> // IWYU pragma: keep
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/positional_options.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+// Offline replay of the "game mode" decider, it does not need daemon nor hardware.
+
+namespace po = boost::program_options;
+
+namespace {
+/// @brief Exit codes.
+constexpr int kOk = 0;
+constexpr int kBadTrace = 1;
+constexpr int kWrongUsage = 2;
+
+const char *SensorName(ReplayThreshold::Sensor sensor)
+{
+    return sensor == ReplayThreshold::Sensor::CPU ? "cpu" : "gpu";
+}
+
+double Percent(std::chrono::duration<double> part, std::chrono::duration<double> whole)
+{
+    return whole.count() > 0. ? 100. * part.count() / whole.count() : 0.;
+}
+
+void PrintReport(const ReplayReport &report)
+{
+    std::printf("samples:            %zu\n", report.samples);
+    std::printf("trace duration:     %.1f s\n", report.traceDuration.count());
+    std::printf("booster toggles:    %llu\n",
+                static_cast<unsigned long long>(report.boosterToggles));
+    std::printf("turbo toggles:      %llu\n", static_cast<unsigned long long>(report.turboToggles));
+    std::printf("booster on:         %.1f s (%.1f%%)\n", report.boosterOnTime.count(),
+                Percent(report.boosterOnTime, report.traceDuration));
+    std::printf("turbo off:          %.1f s (%.1f%%)\n", report.turboOffTime.count(),
+                Percent(report.turboOffTime, report.traceDuration));
+    for (const auto &[threshold, time] : report.timeAbove)
+    {
+        std::printf("%s above %5.1f C:   %.1f s (%.1f%%)\n", SensorName(threshold.sensor),
+                    threshold.degrees, time.count(), Percent(time, report.traceDuration));
+    }
+    for (const auto &reaction : report.reactions)
+    {
+        std::printf("%s above %5.1f C reaction: %llu of %llu crossings, mean %.1f s, max %.1f s\n",
+                    SensorName(reaction.threshold.sensor), reaction.threshold.degrees,
+                    static_cast<unsigned long long>(reaction.answered),
+                    static_cast<unsigned long long>(reaction.crossings),
+                    reaction.MeanDelay().count(), reaction.maxDelay.count());
+    }
+    std::printf("throughput:         %.0f samples/s\n", report.SamplesPerSecond());
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    po::options_description desc("Usage: msifanreplay [trace] [options]\n"
+                                 "Replays trace of \"msifanctl watch\" through the game mode "
+                                 "decider as fast as possible.\n"
+                                 "Options");
+
+    desc.add_options()("help,h", "Show this help.")(
+      "binary,b", "Trace consists of raw TelemetrySample records (msifanctl watch --binary).")(
+      "synthetic,s", po::value<unsigned>(),
+      "Replay simulated laptop (default load profile) for this many minutes instead of trace.")(
+      "period,p", po::value<unsigned>()->default_value(1000),
+      "Synthetic: milliseconds between samples.")(
+      "policy", po::value<std::string>(),
+      "Game mode parameters (i.e. written by msifantune) instead of defaults.")(
+      "average,a", po::value<std::size_t>()->default_value(CPolicyEngine::kAvrSamplesCount),
+      "Amount of the samples averaged by decider, game mode uses 3.")(
+      "cpu-threshold", po::value<std::vector<float>>()->multitoken(),
+      "Report time CPU was above these temperatures, default is decider's thresholds.")(
+      "gpu-threshold", po::value<std::vector<float>>()->multitoken(),
+      "Report time GPU was above these temperatures.");
+
+    po::options_description hidden;
+    hidden.add_options()("trace", po::value<std::string>());
+    po::options_description all;
+    all.add(desc).add(hidden);
+    po::positional_options_description positional;
+    positional.add("trace", 1);
+
+    po::variables_map vm;
+    try
+    {
+        po::store(po::command_line_parser(argc, argv).options(all).positional(positional).run(),
+                  vm);
+        po::notify(vm);
+    }
+    catch (std::exception &ex)
+    {
+        std::cerr << ex.what() << std::endl << desc << std::endl;
+        return kWrongUsage;
+    }
+
+    if (vm.count("help") || (vm.count("trace") == vm.count("synthetic")))
+    {
+        std::cout << desc << std::endl;
+        return kWrongUsage;
+    }
+
+    PolicyParameters params;
+    if (vm.count("policy"))
+    {
+        try
+        {
+            std::ifstream input(vm["policy"].as<std::string>());
+            if (!input)
+            {
+                throw std::invalid_argument("Can not open parameters: "
+                                            + vm["policy"].as<std::string>());
+            }
+            params = PolicyParameters::Load(input);
+        }
+        catch (std::exception &ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            return kWrongUsage;
+        }
+    }
+
+    auto thresholds = DefaultReplayThresholds(params);
+    if (vm.count("cpu-threshold") || vm.count("gpu-threshold"))
+    {
+        thresholds.clear();
+        const auto add = [&thresholds, &vm](const char *option, ReplayThreshold::Sensor sensor) {
+            if (vm.count(option))
+            {
+                for (const auto degrees : vm[option].as<std::vector<float>>())
+                {
+                    thresholds.push_back({sensor, degrees});
+                }
+            }
+        };
+        add("cpu-threshold", ReplayThreshold::Sensor::CPU);
+        add("gpu-threshold", ReplayThreshold::Sensor::GPU);
+    }
+
+    try
+    {
+        TelemetryTrace trace;
+        if (vm.count("synthetic"))
+        {
+            trace = MakeSyntheticTrace(std::chrono::minutes(vm["synthetic"].as<unsigned>()),
+                                       std::chrono::milliseconds(vm["period"].as<unsigned>()));
+        }
+        else
+        {
+            const auto path = vm["trace"].as<std::string>();
+            std::ifstream input(path, vm.count("binary") ? std::ios::binary : std::ios::in);
+            if (!input)
+            {
+                std::cerr << "Can not open trace: " << path << std::endl;
+                return kBadTrace;
+            }
+            trace = ReadTelemetryTrace(input, vm.count("binary") > 0);
+        }
+        if (trace.size() < 2)
+        {
+            std::cerr << "Trace must have at least 2 samples." << std::endl;
+            return kBadTrace;
+        }
+
+        PrintReport(ReplayPolicy(vm["average"].as<std::size_t>(), trace, thresholds, params));
+    }
+    catch (std::invalid_argument &ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return kWrongUsage;
+    }
+    catch (std::exception &ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return kBadTrace;
+    }
+    return kOk;
+}
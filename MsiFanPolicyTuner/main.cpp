@@ -0,0 +1,197 @@
+#include "policy_parameters.h"
+#include "policy_replay.h"
+#include "policy_tuner.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp> // IWYU pragma: keep
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/positional_options.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+// Searches "game mode" parameters over thermal model of the laptop, it does not need daemon.
+
+namespace po = boost::program_options;
+
+namespace {
+/// @brief Exit codes.
+constexpr int kOk = 0;
+constexpr int kBadInput = 1;
+constexpr int kWrongUsage = 2;
+
+void PrintCandidate(const char *title, const TunedCandidate &candidate)
+{
+    const auto &report = candidate.report;
+    const double total = report.traceDuration.count();
+    const auto share = [total](std::chrono::duration<double> part) {
+        return total > 0. ? 100. * part.count() / total : 0.;
+    };
+    std::printf("%s: score %.4f, turbo off %.1f%%, booster on %.1f%%, toggles %llu/%llu\n", title,
+                candidate.score, share(report.turboOffTime), share(report.boosterOnTime),
+                static_cast<unsigned long long>(report.boosterToggles),
+                static_cast<unsigned long long>(report.turboToggles));
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    po::options_description desc(
+      "Usage: msifantune [trace...] [options]\n"
+      "Fits thermal model to the traces of \"msifanctl watch\" (default laptop model if none) and "
+      "searches game mode parameters on it using all cores.\n"
+      "Options");
+
+    desc.add_options()("help,h", "Show this help.")(
+      "binary,b", "Traces consist of raw TelemetrySample records (msifanctl watch --binary).")(
+      "ambient", po::value<float>(), "Room temperature while traces were recorded, C.")(
+      "output,o", po::value<std::string>(),
+      "Write best parameters here, daemon loads them with --policy=<file>.")(
+      "policy", po::value<std::string>(), "Start from these parameters instead of defaults.")(
+      "minutes,m", po::value<unsigned>(),
+      "Simulated minutes per candidate, default is the fitted load length but 30 at least.")(
+      "candidates,c", po::value<std::size_t>()->default_value(2000),
+      "Random candidates, the same amount refines the best of them.")(
+      "threads,j", po::value<std::size_t>()->default_value(0), "Threads, 0 is all cores.")(
+      "seed", po::value<std::uint32_t>()->default_value(1), "Random seed.")(
+      "weight-throttled", po::value<double>()->default_value(PolicyObjective{}.throttled),
+      "Objective: weight of the time turbo-boost is off.")(
+      "weight-booster", po::value<double>()->default_value(PolicyObjective{}.booster),
+      "Objective: weight of the booster's duty cycle.")(
+      "weight-toggles", po::value<double>()->default_value(PolicyObjective{}.togglesPerHour),
+      "Objective: weight of the toggles per hour.")(
+      "weight-overheat", po::value<double>()->default_value(PolicyObjective{}.overheat),
+      "Objective: weight of the time above overheat temperature.")(
+      "overheat", po::value<float>()->default_value(PolicyObjective{}.overheatDegrees),
+      "Objective: overheat temperature, C.");
+
+    po::options_description hidden;
+    hidden.add_options()("trace", po::value<std::vector<std::string>>());
+    po::options_description all;
+    all.add(desc).add(hidden);
+    po::positional_options_description positional;
+    positional.add("trace", -1);
+
+    po::variables_map vm;
+    try
+    {
+        po::store(po::command_line_parser(argc, argv).options(all).positional(positional).run(),
+                  vm);
+        po::notify(vm);
+    }
+    catch (std::exception &ex)
+    {
+        std::cerr << ex.what() << std::endl << desc << std::endl;
+        return kWrongUsage;
+    }
+
+    if (vm.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return kWrongUsage;
+    }
+
+    try
+    {
+        FittedThermalModel model;
+        if (vm.count("trace"))
+        {
+            std::vector<TelemetryTrace> traces;
+            for (const auto &path : vm["trace"].as<std::vector<std::string>>())
+            {
+                std::ifstream input(path, vm.count("binary") ? std::ios::binary : std::ios::in);
+                if (!input)
+                {
+                    std::cerr << "Can not open trace: " << path << std::endl;
+                    return kBadInput;
+                }
+                traces.push_back(ReadTelemetryTrace(input, vm.count("binary") > 0));
+            }
+            std::optional<float> ambient;
+            if (vm.count("ambient"))
+            {
+                ambient = vm["ambient"].as<float>();
+            }
+            model = FitThermalModel(traces, std::chrono::seconds(10), {}, ambient);
+        }
+        else
+        {
+            model.profile = MakeDefaultLoadProfile();
+            if (vm.count("ambient"))
+            {
+                model.plant.ambient = vm["ambient"].as<float>();
+            }
+        }
+
+        PolicyParameters start;
+        if (vm.count("policy"))
+        {
+            std::ifstream input(vm["policy"].as<std::string>());
+            if (!input)
+            {
+                std::cerr << "Can not open parameters: " << vm["policy"].as<std::string>()
+                          << std::endl;
+                return kBadInput;
+            }
+            start = PolicyParameters::Load(input);
+        }
+
+        TunerOptions options;
+        options.duration = vm.count("minutes")
+                             ? std::chrono::minutes(vm["minutes"].as<unsigned>())
+                             : std::max<std::chrono::milliseconds>(model.ProfileDuration(),
+                                                                   std::chrono::minutes(30));
+        options.candidates = vm["candidates"].as<std::size_t>();
+        options.threads = vm["threads"].as<std::size_t>();
+        options.seed = vm["seed"].as<std::uint32_t>();
+        options.objective.throttled = vm["weight-throttled"].as<double>();
+        options.objective.booster = vm["weight-booster"].as<double>();
+        options.objective.togglesPerHour = vm["weight-toggles"].as<double>();
+        options.objective.overheat = vm["weight-overheat"].as<double>();
+        options.objective.overheatDegrees = vm["overheat"].as<float>();
+
+        std::printf("model: ambient %.1f C, %zu load segments, %lld s simulated per candidate\n",
+                    model.plant.ambient, model.profile.size(),
+                    static_cast<long long>(
+                      std::chrono::duration_cast<std::chrono::seconds>(options.duration).count()));
+        const auto started = std::chrono::steady_clock::now();
+        const auto result = TunePolicy(model, options, start);
+        const std::chrono::duration<double> spent = std::chrono::steady_clock::now() - started;
+
+        PrintCandidate("start", result.start);
+        PrintCandidate("best ", result.best);
+        std::printf("%zu candidates in %.1f s\n", result.evaluated, spent.count());
+
+        if (vm.count("output"))
+        {
+            const auto path = vm["output"].as<std::string>();
+            std::ofstream output(path);
+            output << "# Generated by msifantune, score " << result.best.score << '\n';
+            result.best.params.Save(output);
+            if (!output)
+            {
+                std::cerr << "Can not write parameters: " << path << std::endl;
+                return kBadInput;
+            }
+        }
+        else
+        {
+            result.best.params.Save(std::cout);
+        }
+    }
+    catch (std::exception &ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return kBadInput;
+    }
+    return kOk;
+}
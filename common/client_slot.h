@@ -0,0 +1,182 @@
+#pragma once
+
+#include "futex_word.h"
+#include "spsc_ring.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Per-client part of the shared memory. Each client (GUI, CLI, exporter...) claims own
+/// slot, so it has own request ring, own completion (reply) sequence and own wish of update rate.
+/// Daemon drains all slots and serves all clients with single EC read.
+///
+/// Heartbeat is refreshed only by requests: client which did not send anything for
+/// kHeartbeatTimeout (crashed or just idle) loses its slot and must claim one again. Slot's ring
+/// keeps its counters, so new owner continues them.
+///
+/// Ring is single producer, so old owner must never push after slot was given to the other client.
+/// Client refreshes heartbeat and then checks ownership before each push, daemon parks the owner
+/// before it reclaims and checks heartbeat once again. All of them are sequentially consistent, so
+/// either daemon sees fresh heartbeat and keeps the owner, or client sees it lost the slot.
+///
+/// Layout: [owner u64][heartbeat ns u64][completion u32][requested period ms u32], padded to 64,
+/// then CSpscRing. Memory must be zero-initialized before 1st use (shm is after ftruncate()).
+/// @note Object does not own memory, it is cheap to create.
+class CClientSlot
+{
+  public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    /// @brief Size of the single slot in the shared memory.
+    static constexpr std::size_t kSize = 1024;
+    /// @brief Daemon reclaims slot if client did not send heartbeat this long.
+    static constexpr auto kHeartbeatTimeout = std::chrono::seconds(30);
+
+    explicit CClientSlot(char *base) :
+        base(base)
+    {
+    }
+
+    /// @brief Client only. Takes free slot for @p token (non-zero, not kReclaiming, unique per
+    /// client).
+    /// @returns false if slot is owned by other client.
+    bool TryClaim(std::uint64_t token, TimePoint now) const
+    {
+        std::uint64_t expected = 0;
+        if (!Owner().compare_exchange_strong(expected, token))
+        {
+            return false;
+        }
+        Heartbeat(now);
+        return true;
+    }
+
+    /// @brief Client only. Frees slot if it is still owned by @p token.
+    void Release(std::uint64_t token) const
+    {
+        RequestedPeriod().store(0, std::memory_order_relaxed);
+        Owner().compare_exchange_strong(token, 0, std::memory_order_acq_rel);
+    }
+
+    [[nodiscard]]
+    bool IsClaimed() const
+    {
+        return Owner().load(std::memory_order_acquire) != 0;
+    }
+
+    [[nodiscard]]
+    bool IsOwnedBy(std::uint64_t token) const
+    {
+        return Owner().load() == token;
+    }
+
+    /// @brief Client only. Tells daemon client is alive. Steady clock is CLOCK_MONOTONIC, it is
+    /// the same in all processes.
+    /// @note Must be called before IsOwnedBy() check which allows the push.
+    void Heartbeat(TimePoint now) const
+    {
+        HeartbeatNs().store(ToNs(now));
+    }
+
+    /// @brief Daemon only. Frees slot if its owner did not send heartbeat for kHeartbeatTimeout.
+    /// @returns true if slot was reclaimed.
+    bool ReclaimIfStale(TimePoint now) const
+    {
+        auto owner = Owner().load();
+        if (owner == 0 || owner == kReclaiming || !IsStale(now))
+        {
+            return false;
+        }
+        // Nobody can claim parked slot, while owner could refresh heartbeat right after the check
+        // above, so it is checked again.
+        if (!Owner().compare_exchange_strong(owner, kReclaiming))
+        {
+            return false;
+        }
+        if (!IsStale(now))
+        {
+            Owner().store(owner);
+            return false;
+        }
+        RequestedPeriod().store(0, std::memory_order_relaxed);
+        Owner().store(0);
+        return true;
+    }
+
+    /// @brief Client sets how often it wants daemon to read EC, 0 means "no wish".
+    void RequestPeriod(std::uint32_t periodMs) const
+    {
+        RequestedPeriod().store(periodMs, std::memory_order_release);
+    }
+
+    [[nodiscard]]
+    std::uint32_t RequestedPeriodMs() const
+    {
+        return RequestedPeriod().load(std::memory_order_acquire);
+    }
+
+    /// @brief Client pushes requests here, daemon drains them.
+    [[nodiscard]]
+    CSpscRing Requests() const
+    {
+        return CSpscRing(base + kControlSize, kSize - kControlSize);
+    }
+
+    /// @brief Sequence number of the last request of this client processed by daemon, it is
+    /// updated after response was published. Client sleeps on it.
+    [[nodiscard]]
+    CFutexWord Completion() const
+    {
+        // NOLINTNEXTLINE
+        return CFutexWord(reinterpret_cast<std::atomic<std::uint32_t> *>(base + kCompletionOffset));
+    }
+
+    /// @brief Owner while daemon reclaims the slot, it is never a client's token.
+    static constexpr std::uint64_t kReclaiming = UINT64_MAX;
+
+  private:
+    static constexpr std::size_t kControlSize = 64;
+    static constexpr std::size_t kHeartbeatOffset = sizeof(std::uint64_t);
+    static constexpr std::size_t kCompletionOffset = kHeartbeatOffset + sizeof(std::int64_t);
+    static constexpr std::size_t kPeriodOffset = kCompletionOffset + sizeof(std::uint32_t);
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free
+                    && std::atomic<std::int64_t>::is_always_lock_free,
+                  "Atomics in shared memory must be lock-free.");
+
+    char *base;
+
+    [[nodiscard]]
+    bool IsStale(TimePoint now) const
+    {
+        static constexpr auto kTimeoutNs =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(kHeartbeatTimeout).count();
+        return ToNs(now) - HeartbeatNs().load() >= kTimeoutNs;
+    }
+
+    static std::int64_t ToNs(TimePoint time)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch())
+          .count();
+    }
+
+    std::atomic<std::uint64_t> &Owner() const
+    {
+        // NOLINTNEXTLINE
+        return *reinterpret_cast<std::atomic<std::uint64_t> *>(base);
+    }
+
+    std::atomic<std::int64_t> &HeartbeatNs() const
+    {
+        // NOLINTNEXTLINE
+        return *reinterpret_cast<std::atomic<std::int64_t> *>(base + kHeartbeatOffset);
+    }
+
+    std::atomic<std::uint32_t> &RequestedPeriod() const
+    {
+        // NOLINTNEXTLINE
+        return *reinterpret_cast<std::atomic<std::uint32_t> *>(base + kPeriodOffset);
+    }
+};
@@ -1,117 +1,86 @@
 #pragma once
 
+#include "client_slot.h"
+#include "futex_word.h"
+#include "seqlock_buffer.h"
+
 #include <boost/interprocess/mapped_region.hpp>
 #include <boost/interprocess/shared_memory_object.hpp>
-#include <boost/interprocess/sync/interprocess_mutex.hpp>
 
+#include <atomic>
 #include <cstddef>
-#include <streambuf>
+#include <cstdint>
+#include <new>
 
 /// @returns Shared memory name to be used by GUI/daemon for the communication.
 inline const char *GetMemoryName()
 {
-    static const char *const ptr = "MSICoolersSharedControlMem9";
+    static const char *const ptr = "MSICoolersSharedControlMem11";
     return ptr;
 }
 
-/// @brief streambuffer bound to the custom memory block.
-struct MemBuf : std::streambuf
-{
-    MemBuf(char *base, std::size_t size)
-    {
-        this->setp(base, base + size);
-        this->setg(base, base, base + size);
-    }
-    std::size_t written() const
-    {
-        return this->pptr() - this->pbase();
-    }
-    std::size_t read() const
-    {
-        return this->gptr() - this->eback();
-    }
-};
-
-inline constexpr std::size_t kWholeSharedMemSize = 4096;
+inline constexpr std::size_t kWholeSharedMemSize = 3 * 4096;
 
 /// @brief Communication interface, usable by daemon & gui both.
 class SharedMemoryWithMutex
 {
   public:
+    /// @brief Max amount of the clients connected at the same time.
+    static constexpr std::size_t kMaxClients = 8;
+    /// @brief Size of the daemon's publication area.
+    static constexpr std::size_t kInfoSize = 2048;
+
     SharedMemoryWithMutex() = delete;
     SharedMemoryWithMutex(boost::interprocess::shared_memory_object &&shm) :
         shm(std::move(shm)),
         region(this->shm, boost::interprocess::read_write)
     {
-        void *addr = region.get_address();
-        mutex = new (addr) boost::interprocess::interprocess_mutex;
-
-        constexpr std::size_t a = 64;
-        constexpr auto x = sizeof(boost::interprocess::interprocess_mutex);
-
-        const auto r = x % a;
-        offset = r ? x + (a - r) : x;
+        // Default-initialization of the atomic does not write, so value set by other side stays.
+        daemonDoorbell = new (static_cast<char *>(region.get_address()) + kDoorbellOffset)
+          std::atomic<std::uint32_t>;
     }
 
-    boost::interprocess::interprocess_mutex &Mutex() const
+    /// @brief Daemon publishes FullInfoBlock here, GUI reads it.
+    CSeqlockBuffer Daemon2UI() const
     {
-        return *mutex;
+        return CSeqlockBuffer(Ptr(), kInfoSize);
     }
 
-    MemBuf Daemon2UI() const
+    /// @brief Request ring, completion and heartbeat of the client @p index.
+    CClientSlot ClientSlot(std::size_t index) const
     {
-        return MemBuf(Ptr(), Size());
-    }
-
-    MemBuf UI2Daemon() const
-    {
-        // 1 byte is reserved to for signals
-        const auto sz = Size();
-        return MemBuf(Ptr() + sz + 1, sz - 1);
-    }
-
-    void DaemonReadUI() const
-    {
-        UiCheckByte() = 0;
+        return CClientSlot(Ptr() + kInfoSize + index * CClientSlot::kSize);
     }
 
     void UIPushedForDaemon() const
     {
-        UiCheckByte() = 1;
+        DaemonDoorbell().Signal();
     }
 
-    bool IsUiPushed() const
+    /// @brief Daemon sleeps on it until UI pushes request (or anybody else wakes it up).
+    CFutexWord DaemonDoorbell() const
     {
-        return UiCheckByte();
+        return CFutexWord(daemonDoorbell);
     }
 
   private:
-    char &UiCheckByte() const
-    {
-        const auto sz = Size();
-        return *(Ptr() + sz);
-    }
+    static constexpr std::size_t kDoorbellOffset = 0;
+    static constexpr std::size_t kDataOffset =
+      (kDoorbellOffset + sizeof(std::atomic<std::uint32_t>) + 63) / 64 * 64;
 
-    char *Ptr() const
-    {
-        return static_cast<char *>(region.get_address()) + offset;
-    }
+    static_assert(kDataOffset + kInfoSize + kMaxClients * CClientSlot::kSize
+                    <= kWholeSharedMemSize,
+                  "Shared memory is too small for all clients.");
 
-    std::size_t Size() const
+    char *Ptr() const
     {
-        std::size_t sz = (region.get_size() - offset) / 2;
-        if (sz % 2)
-        {
-            --sz;
-        }
-        return sz;
+        return static_cast<char *>(region.get_address()) + kDataOffset;
     }
 
     boost::interprocess::shared_memory_object shm;
     boost::interprocess::mapped_region region;
 
-    boost::interprocess::interprocess_mutex *mutex;
-    std::size_t offset;
+    std::atomic<std::uint32_t> *daemonDoorbell;
 };
 
 /// @brief Access to the shared memory as regular pointer.
@@ -119,9 +88,10 @@ class SharedMemory
 {
   public:
     SharedMemory() = delete;
-    SharedMemory(boost::interprocess::shared_memory_object &&shm) :
+    SharedMemory(boost::interprocess::shared_memory_object &&shm,
+                 boost::interprocess::mode_t mode = boost::interprocess::read_write) :
         shm(std::move(shm)),
-        region(this->shm, boost::interprocess::read_write)
+        region(this->shm, mode)
     {
     }
 
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+              "Futex word must be plain 32 bits in memory.");
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+              "Futex word must be plain 32 bits in memory.");
+
+/// @brief Eventfd-like counter placed into shared memory. Signal() increments it and wakes all
+/// waiters, waiter sleeps into kernel until counter differs from the value it saw. It does not
+/// spin and does not hold any lock while sleeping.
+///
+/// Usage pattern which does not lose signals:
+///   const auto seen = word.Load();
+///   ...check shared state, return if there is work...
+///   word.WaitChange(seen, timeout);
+/// @note Object does not own memory. It must be zero-initialized (shm is after ftruncate()).
+class CFutexWord
+{
+  public:
+    explicit CFutexWord(std::atomic<std::uint32_t> *word) :
+        word(word)
+    {
+    }
+
+    [[nodiscard]]
+    std::uint32_t Load() const
+    {
+        return word->load(std::memory_order_acquire);
+    }
+
+    /// @brief Increments counter and wakes all waiters (of all processes).
+    void Signal() const
+    {
+        word->fetch_add(1u, std::memory_order_acq_rel);
+        // Not FUTEX_PRIVATE_FLAG, waiters can be in other process.
+        syscall(SYS_futex, Address(), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+    /// @brief Sets the value and wakes all waiters (of all processes).
+    void Publish(std::uint32_t value) const
+    {
+        word->store(value, std::memory_order_release);
+        syscall(SYS_futex, Address(), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+    /// @brief Blocks while counter equals @p seen, but not longer than @p timeout.
+    /// @returns true if counter was changed (signaled).
+    template <typename taDuration>
+    bool WaitChange(std::uint32_t seen, taDuration timeout) const
+    {
+        using namespace std::chrono;
+        const auto deadline = steady_clock::now() + duration_cast<steady_clock::duration>(timeout);
+        while (Load() == seen)
+        {
+            const auto left = duration_cast<nanoseconds>(deadline - steady_clock::now());
+            if (left.count() <= 0)
+            {
+                return false;
+            }
+            timespec ts{};
+            ts.tv_sec = static_cast<time_t>(left.count() / 1000000000);
+            ts.tv_nsec = static_cast<long>(left.count() % 1000000000);
+            // Timeout is relative for FUTEX_WAIT. EINTR / EAGAIN / spurious wakeups are handled by
+            // re-checking counter.
+            syscall(SYS_futex, Address(), FUTEX_WAIT, seen, &ts, nullptr, 0);
+        }
+        return true;
+    }
+
+  private:
+    std::uint32_t *Address() const
+    {
+        // NOLINTNEXTLINE
+        return reinterpret_cast<std::uint32_t *>(word);
+    }
+
+    std::atomic<std::uint32_t> *word;
+};
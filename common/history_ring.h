@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+/// @brief Fixed capacity ring of the samples placed over raw (shared) memory block. Single writer
+/// overwrites the oldest samples, any amount of readers copy them out. Readers never write, so
+/// memory can be mapped read-only on their side.
+///
+/// Each sample gets absolute number (0, 1, 2...), reader asks "everything since N" and receives
+/// samples still present in the ring. Each slot is protected by own sequence like seqlock does,
+/// slot overwritten while it was copied is dropped by reader.
+///
+/// Layout: [written u64, padded to 64][slot 0]...[slot N-1], slot is
+/// [sequence u32][reserved u32][number u64][sample]. Memory must be zero-initialized before 1st use
+/// (shm is after ftruncate()).
+/// @note Object does not own memory, it is cheap to create.
+template <typename taSample>
+class CHistoryRing
+{
+  public:
+    static_assert(std::is_trivially_copyable_v<taSample>, "Sample must be copied by memcpy.");
+
+    /// @returns Size of the memory block which keeps @p capacity samples.
+    static constexpr std::size_t RequiredSize(std::size_t capacity)
+    {
+        return kHeaderSize + capacity * sizeof(Slot);
+    }
+
+    CHistoryRing(char *base, std::size_t size) :
+        base(base),
+        capacity(size > kHeaderSize ? (size - kHeaderSize) / sizeof(Slot) : 0)
+    {
+        if (capacity == 0)
+        {
+            throw std::invalid_argument("Memory block is too small for the history ring.");
+        }
+    }
+
+    [[nodiscard]]
+    std::size_t Capacity() const
+    {
+        return capacity;
+    }
+
+    /// @returns Amount of the samples appended ever, it is the number of the next sample.
+    [[nodiscard]]
+    std::uint64_t Written() const
+    {
+        return Counter().load(std::memory_order_acquire);
+    }
+
+    /// @brief Writer only. Stores @p sample overwriting the oldest one if ring is full.
+    void Append(const taSample &sample) const
+    {
+        const auto number = Counter().load(std::memory_order_relaxed);
+        auto &slot = SlotOf(number);
+        const auto started = slot.sequence.load(std::memory_order_relaxed);
+
+        slot.sequence.store(started + 1u, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::memcpy(&slot.number, &number, sizeof(number));
+        std::memcpy(&slot.sample, &sample, sizeof(sample));
+
+        slot.sequence.store(started + 2u, std::memory_order_release);
+        Counter().store(number + 1u, std::memory_order_release);
+    }
+
+    /// @brief Appends to @p out samples numbered from @p from which are still present in the ring.
+    /// @returns Number to pass as @p from next time to receive only new samples.
+    std::uint64_t ReadSince(std::uint64_t from, std::vector<taSample> &out) const
+    {
+        const auto written = Written();
+        const auto oldest = written > capacity ? written - capacity : 0u;
+        for (auto number = std::max(from, oldest); number < written; ++number)
+        {
+            const auto &slot = SlotOf(number);
+            const auto before = slot.sequence.load(std::memory_order_acquire);
+            if (before % 2u != 0u)
+            {
+                continue;
+            }
+
+            std::uint64_t stored = 0;
+            taSample sample;
+            std::memcpy(&stored, &slot.number, sizeof(stored));
+            std::memcpy(&sample, &slot.sample, sizeof(sample));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == before && stored == number)
+            {
+                out.push_back(sample);
+            }
+        }
+        return written;
+    }
+
+  private:
+    static constexpr std::size_t kHeaderSize = 64;
+
+    struct Slot
+    {
+        std::atomic<std::uint32_t> sequence;
+        std::uint32_t reserved;
+        std::uint64_t number;
+        taSample sample;
+    };
+
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free
+                    && std::atomic<std::uint64_t>::is_always_lock_free,
+                  "Atomics in shared memory must be lock-free.");
+
+    char *base;
+    std::size_t capacity;
+
+    std::atomic<std::uint64_t> &Counter() const
+    {
+        // NOLINTNEXTLINE
+        return *reinterpret_cast<std::atomic<std::uint64_t> *>(base);
+    }
+
+    Slot &SlotOf(std::uint64_t number) const
+    {
+        // NOLINTNEXTLINE
+        return reinterpret_cast<Slot *>(base + kHeaderSize)[number % capacity];
+    }
+};
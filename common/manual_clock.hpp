@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+
+/// @brief Clock which moves only when told so. It satisfies the Clock requirements, so it can be
+/// given to CPassedTimeT, TabularDerivativeT and the deciders instead of std::chrono::steady_clock
+/// to run hours of the simulated time in milliseconds.
+/// @note State is static (Clock::now() is static), it is not thread safe. Call Reset() before use.
+class CManualClock
+{
+  public:
+    using duration = std::chrono::nanoseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<CManualClock>;
+    static constexpr bool is_steady = true;
+
+    [[nodiscard]]
+    static time_point now() noexcept
+    {
+        return current;
+    }
+
+    /// @brief Moves time forward by @p step, negative steps are ignored.
+    template <typename taDuration>
+    static void Advance(taDuration step) noexcept
+    {
+        const auto delta = std::chrono::duration_cast<duration>(step);
+        if (delta.count() > 0)
+        {
+            current += delta;
+        }
+    }
+
+    static void Reset(time_point start = time_point{}) noexcept
+    {
+        current = start;
+    }
+
+  private:
+    inline static time_point current{};
+};
@@ -6,16 +6,18 @@
 
 /// @brief Simple time passed measure. It records clock on creations,
 /// and evalutes to true when recorded time + delay set < now().
-class CPassedTime
+/// @tparam taClock Source of the time, i.e. CManualClock in tests.
+template <typename taClock = std::chrono::steady_clock>
+class CPassedTimeT
 {
   public:
-    using clock_t = std::chrono::steady_clock;
-    CPassedTime() = delete;
-    ~CPassedTime() = default;
-    DEFAULT_COPYMOVE(CPassedTime);
+    using clock_t = taClock;
+    CPassedTimeT() = delete;
+    ~CPassedTimeT() = default;
+    DEFAULT_COPYMOVE(CPassedTimeT);
 
     template <typename taDuration>
-    explicit CPassedTime(taDuration duration) :
+    explicit CPassedTimeT(taDuration duration) :
         passed_at_(clock_t::now() + duration)
     {
     }
@@ -23,7 +25,7 @@ class CPassedTime
     [[nodiscard]]
     bool IsPassed() const
     {
-        return passed_at_ <= std::chrono::steady_clock::now();
+        return passed_at_ <= clock_t::now();
     }
 
     operator bool() const
@@ -34,3 +36,5 @@ class CPassedTime
   private:
     std::chrono::time_point<clock_t> passed_at_;
 };
+
+using CPassedTime = CPassedTimeT<>;
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+/// @brief Double buffered seqlock placed over raw (shared) memory block. It publishes byte blobs
+/// from the single writer to any amount of the readers, nobody takes a lock.
+///
+/// Writer never waits: it fills the buffer which is not the latest one, than switches "latest"
+/// index. Reader copies latest buffer and validates by sequence number that writer did not touch
+/// it meanwhile, otherwise it retries. Readers never write into memory, so stalled or crashed
+/// reader cannot block the writer.
+///
+/// Layout: [latest index, padded to 64][buffer 0][buffer 1], buffer is
+/// [sequence u32][size u32][payload]. Sequence is odd while buffer is written, 0 means buffer was
+/// never written. Memory must be zero-initialized before 1st use (shm is after ftruncate()).
+/// @note Object does not own memory, it is cheap to create.
+class CSeqlockBuffer
+{
+  public:
+    CSeqlockBuffer(char *base, std::size_t size) :
+        base(base),
+        bufferSize(size > kHeaderSize ? (size - kHeaderSize) / 2 / kAlign * kAlign : 0)
+    {
+        if (bufferSize <= kBufferHeaderSize)
+        {
+            throw std::invalid_argument("Memory block is too small for the seqlock.");
+        }
+    }
+
+    /// @returns Max size of the blob which can be published.
+    [[nodiscard]]
+    std::size_t Capacity() const
+    {
+        return bufferSize - kBufferHeaderSize;
+    }
+
+    /// @brief Publishes new blob. Only one writer is allowed at a time.
+    /// @throws std::length_error if blob is bigger than Capacity().
+    void Publish(const void *data, std::size_t size) const
+    {
+        PublishWith(size, [data, size](char *payload) {
+            std::memcpy(payload, data, size);
+        });
+    }
+
+    /// @brief Publishes new blob of @p size bytes which is written in place by fill(payload).
+    /// Payload keeps the publication made before the latest one (or zeros), so writer may update
+    /// only bytes which differ from it.
+    /// @throws std::length_error if blob is bigger than Capacity().
+    template <typename taFill>
+    void PublishWith(std::size_t size, const taFill &fill) const
+    {
+        if (size > Capacity())
+        {
+            throw std::length_error("Blob is too big for the seqlock buffer.");
+        }
+
+        const auto index = Latest().load(std::memory_order_relaxed) ^ 1u;
+        auto &sequence = Sequence(index);
+        const auto started = sequence.load(std::memory_order_relaxed);
+
+        sequence.store(started + 1u, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        fill(Payload(index));
+        Size(index).store(static_cast<std::uint32_t>(size), std::memory_order_relaxed);
+
+        sequence.store(started + 2u, std::memory_order_release);
+        Latest().store(index, std::memory_order_release);
+    }
+
+    /// @brief Publishes fixed size @p message as is.
+    template <typename taMessage>
+    void Publish(const taMessage &message) const
+    {
+        static_assert(std::is_trivially_copyable_v<taMessage>, "Message must be copied by memcpy.");
+        Publish(&message, sizeof(message));
+    }
+
+    /// @brief Copies latest published blob into @p out.
+    /// @returns false if nothing was published yet or consistent copy could not be made (writer
+    /// was too fast all attempts).
+    bool ReadLatest(std::string &out) const
+    {
+        return ReadLatestWith([&out](const char *payload, std::size_t size) {
+            out.assign(payload, size);
+            return true;
+        });
+    }
+
+    /// @brief Copies latest published fixed size message into @p out, without allocations.
+    /// @returns false in the same cases as blob version or if published size is different.
+    template <typename taMessage>
+    bool ReadLatest(taMessage &out) const
+    {
+        static_assert(std::is_trivially_copyable_v<taMessage>, "Message must be copied by memcpy.");
+        return ReadLatestWith([&out](const char *payload, std::size_t size) {
+            if (size != sizeof(out))
+            {
+                return false;
+            }
+            std::memcpy(&out, payload, sizeof(out));
+            return true;
+        });
+    }
+
+    /// @brief Lets reader to copy only part of the latest blob. Copy may be repeated if writer
+    /// interfered, so @p copy must write into scratch memory, which is used only on success.
+    /// @param copy is called as copy(payload, size) and returns false if payload is not accepted.
+    template <typename taCopy>
+    bool ReadLatestWith(const taCopy &copy) const
+    {
+        constexpr int kAttempts = 64;
+        for (int attempt = 0; attempt < kAttempts; ++attempt)
+        {
+            const auto index = Latest().load(std::memory_order_acquire);
+            const auto &sequence = Sequence(index);
+            const auto before = sequence.load(std::memory_order_acquire);
+            if (before == 0u)
+            {
+                return false;
+            }
+
+            const auto size = Size(index).load(std::memory_order_relaxed);
+            if (before % 2u == 0u && size <= Capacity())
+            {
+                const bool copied = copy(Payload(index), size);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before)
+                {
+                    return copied;
+                }
+            }
+            std::this_thread::yield();
+        }
+        return false;
+    }
+
+  private:
+    static constexpr std::size_t kAlign = 64;
+    static constexpr std::size_t kHeaderSize = kAlign;
+    static constexpr std::size_t kBufferHeaderSize = 2 * sizeof(std::uint32_t);
+
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+                  "Atomics in shared memory must be lock-free.");
+
+    char *base;
+    std::size_t bufferSize;
+
+    std::atomic<std::uint32_t> &Word(std::size_t offset) const
+    {
+        // NOLINTNEXTLINE
+        return *reinterpret_cast<std::atomic<std::uint32_t> *>(base + offset);
+    }
+
+    std::atomic<std::uint32_t> &Latest() const
+    {
+        return Word(0);
+    }
+
+    std::size_t BufferOffset(std::uint32_t index) const
+    {
+        return kHeaderSize + (index & 1u) * bufferSize;
+    }
+
+    std::atomic<std::uint32_t> &Sequence(std::uint32_t index) const
+    {
+        return Word(BufferOffset(index));
+    }
+
+    std::atomic<std::uint32_t> &Size(std::uint32_t index) const
+    {
+        return Word(BufferOffset(index) + sizeof(std::uint32_t));
+    }
+
+    char *Payload(std::uint32_t index) const
+    {
+        return base + BufferOffset(index) + kBufferHeaderSize;
+    }
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+/// @brief Bounded single-producer / single-consumer ring of the fixed-size slots placed over raw
+/// (shared) memory block. No locks: producer owns head, consumer owns tail.
+///
+/// Head and tail are free running 32 bits counters, slot is counter % SlotsCount(), amount of the
+/// slots is power of 2, so wrap-around of the counters is seamless. Head value after push is the
+/// sequence number of the pushed message, consumer may report it back as "processed up to".
+///
+/// Layout: [head u32, padded to 64][tail u32, padded to 64][slot 0]...[slot N-1], slot is
+/// [size u32][payload]. Memory must be zero-initialized before 1st use (shm is after ftruncate()).
+/// @note Object does not own memory, it is cheap to create.
+class CSpscRing
+{
+  public:
+    static constexpr std::size_t kSlotSize = 192;
+
+    CSpscRing(char *base, std::size_t size) :
+        base(base),
+        slotsCount(FloorPow2(size > kHeaderSize ? (size - kHeaderSize) / kSlotSize : 0))
+    {
+        if (slotsCount == 0)
+        {
+            throw std::invalid_argument("Memory block is too small for the ring.");
+        }
+    }
+
+    /// @returns Max size of the single message.
+    [[nodiscard]]
+    static constexpr std::size_t Capacity()
+    {
+        return kSlotSize - sizeof(std::uint32_t);
+    }
+
+    [[nodiscard]]
+    std::size_t SlotsCount() const
+    {
+        return slotsCount;
+    }
+
+    /// @brief Producer only. Copies message into the next free slot.
+    /// @returns sequence number of the message or std::nullopt if ring is full.
+    /// @throws std::length_error if message is bigger than Capacity().
+    std::optional<std::uint32_t> TryPush(const void *data, std::size_t size) const
+    {
+        if (size > Capacity())
+        {
+            throw std::length_error("Message is too big for the ring's slot.");
+        }
+        const auto head = Head().load(std::memory_order_relaxed);
+        const auto tail = Tail().load(std::memory_order_acquire);
+        if (head - tail >= slotsCount)
+        {
+            return std::nullopt;
+        }
+
+        char *slot = Slot(head);
+        const auto size32 = static_cast<std::uint32_t>(size);
+        std::memcpy(slot, &size32, sizeof(size32));
+        std::memcpy(slot + sizeof(size32), data, size);
+
+        Head().store(head + 1u, std::memory_order_release);
+        return head + 1u;
+    }
+
+    /// @brief Producer only. Copies fixed size @p message into the next free slot.
+    template <typename taMessage>
+    std::optional<std::uint32_t> TryPush(const taMessage &message) const
+    {
+        static_assert(std::is_trivially_copyable_v<taMessage>, "Message must be copied by memcpy.");
+        static_assert(sizeof(taMessage) <= Capacity(), "Message does not fit the slot.");
+        return TryPush(&message, sizeof(message));
+    }
+
+    /// @brief Consumer only. Moves the oldest message into @p out and frees the slot.
+    /// @returns false if ring is empty.
+    bool TryPop(std::string &out) const
+    {
+        return TryPopWith([&out](const char *payload, std::size_t size) {
+            out.assign(payload, size);
+        });
+    }
+
+    /// @brief Consumer only. Moves the oldest fixed size message into @p out, without allocations.
+    /// If message in the slot has other size @p out is zero filled, so caller's validation of the
+    /// message header fails.
+    /// @returns false if ring is empty.
+    template <typename taMessage>
+    bool TryPop(taMessage &out) const
+    {
+        static_assert(std::is_trivially_copyable_v<taMessage>, "Message must be copied by memcpy.");
+        return TryPopWith([&out](const char *payload, std::size_t size) {
+            if (size == sizeof(out))
+            {
+                std::memcpy(&out, payload, sizeof(out));
+            }
+            else
+            {
+                std::memset(&out, 0, sizeof(out));
+            }
+        });
+    }
+
+    /// @returns Sequence number of the last message popped by consumer.
+    [[nodiscard]]
+    std::uint32_t Consumed() const
+    {
+        return Tail().load(std::memory_order_acquire);
+    }
+
+    /// @returns true if @p sequence was popped already, it handles counter's wrap-around.
+    [[nodiscard]]
+    static bool IsReached(std::uint32_t current, std::uint32_t sequence)
+    {
+        return static_cast<std::int32_t>(current - sequence) >= 0;
+    }
+
+  private:
+    static constexpr std::size_t kAlign = 64;
+    static constexpr std::size_t kHeaderSize = 2 * kAlign;
+
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+                  "Atomics in shared memory must be lock-free.");
+
+    char *base;
+    std::uint32_t slotsCount;
+
+    static std::uint32_t FloorPow2(std::size_t value)
+    {
+        std::uint32_t res = 0;
+        for (std::uint32_t p = 1; p <= value && p != 0; p <<= 1u)
+        {
+            res = p;
+        }
+        return res;
+    }
+
+    template <typename taCopy>
+    bool TryPopWith(const taCopy &copy) const
+    {
+        const auto tail = Tail().load(std::memory_order_relaxed);
+        const auto head = Head().load(std::memory_order_acquire);
+        if (tail == head)
+        {
+            return false;
+        }
+
+        const char *slot = Slot(tail);
+        std::uint32_t size = 0;
+        std::memcpy(&size, slot, sizeof(size));
+        copy(slot + sizeof(size), size > Capacity() ? 0 : size);
+
+        Tail().store(tail + 1u, std::memory_order_release);
+        return true;
+    }
+
+    std::atomic<std::uint32_t> &Head() const
+    {
+        // NOLINTNEXTLINE
+        return *reinterpret_cast<std::atomic<std::uint32_t> *>(base);
+    }
+
+    std::atomic<std::uint32_t> &Tail() const
+    {
+        // NOLINTNEXTLINE
+        return *reinterpret_cast<std::atomic<std::uint32_t> *>(base + kAlign);
+    }
+
+    char *Slot(std::uint32_t counter) const
+    {
+        return base + kHeaderSize + (counter % slotsCount) * kSlotSize;
+    }
+};
@@ -0,0 +1,98 @@
+#include "acpi_interrupts.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace {
+/// @brief /proc/interrupts is few KB per 8 CPUs, buffer grows if it is not enough.
+constexpr std::size_t kInitialBuffer = 16 * 1024;
+
+int OpenReadOnly(const std::filesystem::path &file)
+{
+    return open(file.c_str(), O_RDONLY | O_CLOEXEC);
+}
+} // namespace
+
+CAcpiInterruptCounter::CAcpiInterruptCounter() :
+    CAcpiInterruptCounter("/proc/interrupts", "/sys/firmware/acpi/interrupts/sci")
+{
+}
+
+CAcpiInterruptCounter::CAcpiInterruptCounter(std::filesystem::path procInterrupts,
+                                             std::filesystem::path sciCounter) :
+    procFd(OpenReadOnly(procInterrupts)),
+    sciFd(OpenReadOnly(sciCounter)),
+    buffer(kInitialBuffer, 0)
+{
+    // Line may be missing, for example if kernel does not name acpi handler, sysfs is used then.
+    if (procFd >= 0 && !(ReadWhole(procFd) && ParseProcInterruptsAcpi(*ReadWhole(procFd))))
+    {
+        close(procFd);
+        procFd = -1;
+    }
+}
+
+CAcpiInterruptCounter::~CAcpiInterruptCounter()
+{
+    for (const int fd : {procFd, sciFd})
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+}
+
+std::optional<std::uint64_t> CAcpiInterruptCounter::Read() const
+{
+    if (procFd >= 0)
+    {
+        if (const auto text = ReadWhole(procFd))
+        {
+            return ParseProcInterruptsAcpi(*text);
+        }
+    }
+    if (sciFd >= 0)
+    {
+        if (const auto text = ReadWhole(sciFd))
+        {
+            return ParseAcpiInterruptsCounter(*text);
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string_view> CAcpiInterruptCounter::ReadWhole(int fd) const
+{
+    std::size_t size = 0;
+    while (true)
+    {
+        if (size == buffer.size())
+        {
+            buffer.resize(buffer.size() * 2);
+        }
+        const auto res = pread(fd, buffer.data() + size, buffer.size() - size,
+                               static_cast<off_t>(size));
+        if (res < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (res < 0)
+        {
+            return std::nullopt;
+        }
+        if (res == 0)
+        {
+            return std::string_view(buffer.data(), size);
+        }
+        size += static_cast<std::size_t>(res);
+    }
+}
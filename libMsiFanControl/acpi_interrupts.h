@@ -0,0 +1,314 @@
+#pragma once
+
+#include "cm_ctors.h"
+#include "register_cache.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/// File defines accounting of the ACPI interrupts (IRQ9 / SCI) caused by EC accesses. Each EC byte
+/// is ACPI transaction, which is the reason daemon keeps reads low.
+
+/// @brief Who started the EC session.
+enum class InterruptCause : std::uint8_t {
+    /// @brief Periodic read of the full information (single read plan).
+    READ_PLAN,
+    /// @brief Writes requested by clients.
+    CLIENT_REQUEST,
+    /// @brief Writes of the policy engine (game mode).
+    POLICY,
+    COUNT
+};
+
+inline constexpr std::size_t kInterruptCausesCount = static_cast<std::size_t>(InterruptCause::COUNT);
+
+inline const char *InterruptCauseName(InterruptCause cause)
+{
+    static constexpr std::array<const char *, kInterruptCausesCount> kNames = {
+      "read_plan",
+      "client_request",
+      "policy",
+    };
+    const auto index = static_cast<std::size_t>(cause);
+    return index < kNames.size() ? kNames.at(index) : "unknown";
+}
+
+inline const char *RegisterClassName(std::size_t index)
+{
+    static constexpr std::array<const char *, kRegisterClassesCount + 1> kNames = {
+      "fast_sensor",
+      "slow_setting",
+      "static",
+      "unclassified",
+    };
+    return index < kNames.size() ? kNames.at(index) : "unknown";
+}
+
+/// @returns Sum of all per-CPU counters of the /proc/interrupts line which serves "acpi" device, or
+/// std::nullopt if there is no such line.
+inline std::optional<std::uint64_t> ParseProcInterruptsAcpi(std::string_view text)
+{
+    constexpr std::string_view kSpaces = " \t";
+    while (!text.empty())
+    {
+        const auto eol = std::min(text.find('\n'), text.size());
+        auto line = text.substr(0, eol);
+        text.remove_prefix(std::min(eol + 1, text.size()));
+
+        const auto colon = line.find(':');
+        if (colon == std::string_view::npos)
+        {
+            continue;
+        }
+        line.remove_prefix(colon + 1);
+
+        std::uint64_t sum = 0;
+        bool isAcpi = false;
+        bool inCounters = true;
+        while (!line.empty())
+        {
+            line.remove_prefix(std::min(line.find_first_not_of(kSpaces), line.size()));
+            const auto end = std::min(line.find_first_of(kSpaces), line.size());
+            auto token = line.substr(0, end);
+            line.remove_prefix(end);
+            if (token.empty())
+            {
+                break;
+            }
+
+            const bool isNumber =
+              std::all_of(token.begin(), token.end(), [](char c) { return c >= '0' && c <= '9'; });
+            if (inCounters && isNumber)
+            {
+                std::uint64_t counter = 0;
+                for (const char c : token)
+                {
+                    counter = counter * 10 + static_cast<std::uint64_t>(c - '0');
+                }
+                sum += counter;
+                continue;
+            }
+            // Counters are followed by chip, hw irq and comma separated devices.
+            inCounters = false;
+            if (!token.empty() && token.back() == ',')
+            {
+                token.remove_suffix(1);
+            }
+            isAcpi = isAcpi || token == "acpi";
+        }
+        if (isAcpi)
+        {
+            return sum;
+        }
+    }
+    return std::nullopt;
+}
+
+/// @returns 1st number of the /sys/firmware/acpi/interrupts/ file, like "  1234  EN  enabled".
+inline std::optional<std::uint64_t> ParseAcpiInterruptsCounter(std::string_view text)
+{
+    text.remove_prefix(std::min(text.find_first_not_of(" \t"), text.size()));
+    if (text.empty() || text.front() < '0' || text.front() > '9')
+    {
+        return std::nullopt;
+    }
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i)
+    {
+        value = value * 10 + static_cast<std::uint64_t>(text[i] - '0');
+    }
+    return value;
+}
+
+/// @brief Reads system wide ACPI interrupts counter. The line of the /proc/interrupts is preferred
+/// (it is IRQ9 on the most laptops), /sys/firmware/acpi/interrupts/sci is used if it is missing.
+/// Files are opened once and re-read by pread(), so it works after seccomp is engaged.
+/// @note This class is not thread-safe.
+class CAcpiInterruptCounter
+{
+  public:
+    CAcpiInterruptCounter();
+    CAcpiInterruptCounter(std::filesystem::path procInterrupts, std::filesystem::path sciCounter);
+    NO_COPYMOVE(CAcpiInterruptCounter);
+    ~CAcpiInterruptCounter();
+
+    /// @returns Current counter or std::nullopt if system does not expose it.
+    [[nodiscard]]
+    std::optional<std::uint64_t> Read() const;
+
+  private:
+    int procFd{-1};
+    int sciFd{-1};
+    mutable std::vector<char> buffer;
+
+    /// @returns Text of the whole file at @p fd, it is valid until next call.
+    std::optional<std::string_view> ReadWhole(int fd) const;
+};
+
+/// @brief Interrupts attributed to the daemon's EC sessions.
+struct AcpiInterruptStatistics
+{
+    /// @brief All ACPI interrupts since daemon started, including ones daemon did not cause.
+    std::uint64_t total{0};
+    std::array<std::uint64_t, kInterruptCausesCount> byCause{};
+    /// @brief Interrupts of the read plans split by bytes read of each register class.
+    RegisterClassCounters byRegisterClass{};
+    std::uint64_t readPlans{0};
+    std::uint64_t lastReadPlan{0};
+    /// @brief Rate of the total over last CAcpiInterruptAccounting::kRateWindow.
+    double perSecond{0.};
+};
+
+/// @brief Samples ACPI counter around each EC session and attributes difference to the session.
+/// Interrupts raised by others while session runs are attributed to it too, sessions are short, so
+/// it is small error.
+/// @note This class is not thread-safe.
+class CAcpiInterruptAccounting
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+    /// @returns Current system counter or std::nullopt if it is not available.
+    using CounterSource = std::function<std::optional<std::uint64_t>()>;
+
+    static constexpr auto kRateWindow = std::chrono::seconds(1);
+
+    explicit CAcpiInterruptAccounting(CounterSource source) :
+        source(std::move(source))
+    {
+        lastCounter = Sample();
+    }
+    NO_COPYMOVE(CAcpiInterruptAccounting);
+    ~CAcpiInterruptAccounting() = default;
+
+    /// @returns false if system does not expose ACPI interrupts counter.
+    [[nodiscard]]
+    bool IsAvailable() const
+    {
+        return lastCounter.has_value();
+    }
+
+    /// @brief Must be called right before EC session.
+    void Begin()
+    {
+        sessionStart = IsAvailable() ? Observe() : 0;
+    }
+
+    /// @brief Must be called right after EC session of the @p cause started by Begin().
+    void End(InterruptCause cause)
+    {
+        Attribute(cause, Session());
+    }
+
+    /// @brief Ends read plan session, @p bytesRead are bytes read by the session per register class,
+    /// interrupts are split between classes proportionally.
+    void End(const RegisterClassCounters &bytesRead)
+    {
+        const auto interrupts = Session();
+        Attribute(InterruptCause::READ_PLAN, interrupts);
+        ++statistics.readPlans;
+        statistics.lastReadPlan = interrupts;
+
+        std::uint64_t bytes = 0;
+        for (const auto count : bytesRead)
+        {
+            bytes += count;
+        }
+        if (bytes == 0)
+        {
+            return;
+        }
+        // Remainder of the integer split goes to the class which read the most.
+        std::uint64_t given = 0;
+        for (std::size_t i = 0; i < bytesRead.size(); ++i)
+        {
+            const auto share = interrupts * bytesRead.at(i) / bytes;
+            statistics.byRegisterClass.at(i) += share;
+            given += share;
+        }
+        const auto most = std::distance(bytesRead.begin(),
+                                        std::max_element(bytesRead.begin(), bytesRead.end()));
+        statistics.byRegisterClass.at(static_cast<std::size_t>(most)) += interrupts - given;
+    }
+
+    /// @brief Updates Statistics().perSecond once per kRateWindow.
+    void UpdateRate(Clock::time_point now)
+    {
+        if (!IsAvailable())
+        {
+            return;
+        }
+        if (!rateWindowStart)
+        {
+            rateWindowStart = now;
+            rateWindowTotal = statistics.total;
+            return;
+        }
+        const auto elapsed = now - *rateWindowStart;
+        if (elapsed < kRateWindow)
+        {
+            return;
+        }
+        Observe();
+        using Seconds = std::chrono::duration<double>;
+        statistics.perSecond = static_cast<double>(statistics.total - rateWindowTotal)
+                               / Seconds(elapsed).count();
+        rateWindowStart = now;
+        rateWindowTotal = statistics.total;
+    }
+
+    [[nodiscard]]
+    const AcpiInterruptStatistics &Statistics() const
+    {
+        return statistics;
+    }
+
+  private:
+    CounterSource source;
+    std::optional<std::uint64_t> lastCounter;
+    std::uint64_t sessionStart{0};
+    std::optional<Clock::time_point> rateWindowStart;
+    std::uint64_t rateWindowTotal{0};
+    AcpiInterruptStatistics statistics;
+
+    std::optional<std::uint64_t> Sample() const
+    {
+        return source ? source() : std::nullopt;
+    }
+
+    /// @brief Samples counter and accounts total.
+    /// @returns Total after sampling.
+    std::uint64_t Observe()
+    {
+        const auto counter = Sample();
+        // Counter going back means it is not the same counter anymore (file vanished), ignoring.
+        if (counter && lastCounter && *counter >= *lastCounter)
+        {
+            statistics.total += *counter - *lastCounter;
+        }
+        if (counter)
+        {
+            lastCounter = counter;
+        }
+        return statistics.total;
+    }
+
+    std::uint64_t Session()
+    {
+        return IsAvailable() ? Observe() - sessionStart : 0;
+    }
+
+    void Attribute(InterruptCause cause, std::uint64_t interrupts)
+    {
+        statistics.byCause.at(static_cast<std::size_t>(cause)) += interrupts;
+    }
+};
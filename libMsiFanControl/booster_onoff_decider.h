@@ -3,9 +3,11 @@
 #include "cm_ctors.h" // IWYU pragma: keep
 #include "device.h"   // IWYU pragma: keep
 #include "messages_types.h"
+#include "policy_parameters.h"
 #include "running_avr.h"
 #include "tabular_derivative.h" // IWYU pragma: keep
 
+#include <chrono>
 #include <cstddef>
 #include <optional>
 #include <type_traits>
@@ -16,10 +18,15 @@
  * This class uses temperature derivative calculations to dynamically adjust the
  * CPU turbo boost. The turbo boost can be enabled or disabled based on the current
  * temperature and its rate of change (acceleration).
+ *
+ * @tparam taClock Source of the time if temperature has no timestamp, i.e. CManualClock in tests.
  */
-class CpuTurboBoostController
+template <typename taClock = std::chrono::steady_clock>
+class CpuTurboBoostControllerT
 {
   public:
+    using Derivative = TabularDerivativeT<taClock>;
+
     /**
      * @brief Constructs a CpuTurboBoostController instance.
      *
@@ -28,9 +35,16 @@ class CpuTurboBoostController
      * @param alpha_derivative Smoothing factor for temperature acceleration (second derivative)
      * [0.0 – 1.0].
      */
-    explicit CpuTurboBoostController(float alpha_temp = 0.3f, float alpha_derivative = 0.5f) :
-        dT(alpha_temp),
-        d2T(alpha_derivative)
+    explicit CpuTurboBoostControllerT(float alpha_temp = 0.3f, float alpha_derivative = 0.5f) :
+        CpuTurboBoostControllerT(WithAlphas(alpha_temp, alpha_derivative))
+    {
+    }
+
+    /// @brief Constructs controller with thresholds and smoothing factors of @p params.
+    explicit CpuTurboBoostControllerT(const PolicyParameters &params) :
+        params(params),
+        dT(params.alphaTemperature),
+        d2T(params.alphaDerivative)
     {
     }
 
@@ -46,22 +60,29 @@ class CpuTurboBoostController
      */
     CpuTurboBoostState Update(const float currentTemperature, const CpuTurboBoostState currentState)
     {
-        static constexpr float kCpuOnlyHotDegree =
-          83.0; ///< Temperature threshold to consider disabling turbo-boost.
-        static constexpr float kCpuOnlyColdDegree =
-          72.0; ///< Temperature threshold to consider enabling turbo-boost.
+        return Update(currentTemperature, currentState, taClock::now());
+    }
 
-        static constexpr float kTooFastHeatingRateDegreesPerSecond = 0.5f;
+    /**
+     * @brief The same as above, but @p sampledAt is the time when @p currentTemperature was read.
+     * Temperature which is not newer than the previous one does not change derivatives.
+     */
+    CpuTurboBoostState Update(const float currentTemperature, const CpuTurboBoostState currentState,
+                              const typename Derivative::TimePoint sampledAt)
+    {
+        // Temperature thresholds to consider disabling / enabling turbo-boost.
+        const float hotDegree = params.turboHotDegree;
+        const float coldDegree = params.turboColdDegree;
 
         // If user turns on algorithm when it is already hot, we should issue orders immediately, we
         // can't wait d2T to be collected. Also it can be constant d2T but hot.
-        const auto justCreatedResult = [&currentState, &currentTemperature]() {
-            return currentState == CpuTurboBoostState::ON && currentTemperature >= kCpuOnlyHotDegree
+        const auto justCreatedResult = [&currentState, &currentTemperature, hotDegree]() {
+            return currentState == CpuTurboBoostState::ON && currentTemperature >= hotDegree
                      ? CpuTurboBoostState::OFF
                      : CpuTurboBoostState::NO_CHANGE;
         };
 
-        dT.Update(currentTemperature);
+        dT.Update(currentTemperature, sampledAt);
 
         const auto tempDerivative = dT.Result();
         if (!tempDerivative.has_value())
@@ -69,7 +90,7 @@ class CpuTurboBoostController
             return justCreatedResult();
         }
 
-        d2T.Update(*tempDerivative);
+        d2T.Update(*tempDerivative, sampledAt);
         const auto accel = d2T.Result();
         if (!accel.has_value())
         {
@@ -82,15 +103,15 @@ class CpuTurboBoostController
 
         if (currentState == CpuTurboBoostState::ON)
         {
-            if (currentTemperature >= kCpuOnlyHotDegree
-                && rate > kTooFastHeatingRateDegreesPerSecond && IsPositive(acceleration))
+            if (currentTemperature >= hotDegree
+                && rate > params.tooFastHeatingRate && IsPositive(acceleration))
             {
                 return CpuTurboBoostState::OFF;
             }
         }
         else if (currentState == CpuTurboBoostState::OFF)
         {
-            if (currentTemperature <= kCpuOnlyColdDegree && !IsPositive(rate)
+            if (currentTemperature <= coldDegree && !IsPositive(rate)
                 && !IsPositive(acceleration))
             {
                 return CpuTurboBoostState::ON;
@@ -101,8 +122,17 @@ class CpuTurboBoostController
     }
 
   private:
-    TabularDerivative dT;  ///< First derivative (rate of temperature change)
-    TabularDerivative d2T; ///< Second derivative (temperature acceleration)
+    PolicyParameters params;
+    Derivative dT;  ///< First derivative (rate of temperature change)
+    Derivative d2T; ///< Second derivative (temperature acceleration)
+
+    static PolicyParameters WithAlphas(float alphaTemperature, float alphaDerivative)
+    {
+        PolicyParameters res;
+        res.alphaTemperature = alphaTemperature;
+        res.alphaDerivative = alphaDerivative;
+        return res;
+    }
 
     /// @returns -1, 0 or 1 depend on sign of @p value.
     template <class T>
@@ -130,12 +160,21 @@ class CpuTurboBoostController
     }
 };
 
+using CpuTurboBoostController = CpuTurboBoostControllerT<>;
+
 /// @brief This is "smart logic" to decide if we should switch boosters (fan's, cpu turboboost,
 /// etc.).
-template <std::size_t AvrSamplesCount>
+/// @tparam taClock Source of the time, readings' timestamps are taken as this clock's time.
+template <std::size_t AvrSamplesCount, typename taClock = std::chrono::steady_clock>
 class BoostersOnOffDecider
 {
   public:
+    explicit BoostersOnOffDecider(const PolicyParameters &params = {}) :
+        params(params),
+        cpuTurboBoost(params)
+    {
+    }
+
     /// @brief  Computes updated state with new info from daemon.
     /// It's safe to call this method even if there is no new info, but in that case it won't
     /// update anything. This method should be called periodically (every second or so).
@@ -147,12 +186,29 @@ class BoostersOnOffDecider
         BoostersStates res;
         if (newInfo)
         {
-            cpuAvrTemp.OfferValue(newInfo->info.cpu.temperature);
-            gpuAvrTemp.OfferValue(newInfo->info.gpu.temperature);
+            const auto &cpu = newInfo->info.cpu;
+            const auto &gpu = newInfo->info.gpu;
+            const auto cpuTemperature = cpu.PreciseTemperature();
+            // Daemon may re-send reading (i.e. CPU is sampled more often than GPU), timed average
+            // skips it.
+            const auto offer = [](auto &avr, float value, const Info &sensor) {
+                if (const auto sampledAt = sensor.SampledAt<taClock>())
+                {
+                    avr.OfferValue(value, *sampledAt);
+                }
+                else
+                {
+                    avr.OfferValue(value);
+                }
+            };
+            offer(cpuAvrTemp, cpuTemperature, cpu);
+            offer(gpuAvrTemp, static_cast<float>(gpu.temperature), gpu);
 
             // Updating CPU turboboost state, it has own complex decider.
+            const auto cpuSampledAt = cpu.SampledAt<taClock>();
             res.cpuTurboBoostState =
-              cpuTurboBoost.Update(newInfo->info.cpu.temperature, lastStates.cpuTurboBoostState);
+              cpuTurboBoost.Update(cpuTemperature, lastStates.cpuTurboBoostState,
+                                   cpuSampledAt ? *cpuSampledAt : taClock::now());
 
             lastStates = newInfo->boostersStates;
         }
@@ -177,10 +233,13 @@ class BoostersOnOffDecider
     }
 
   private:
+    PolicyParameters params;
     BoostersStates lastStates;
-    RunningAvr<float, AvrSamplesCount> cpuAvrTemp;
-    RunningAvr<float, AvrSamplesCount> gpuAvrTemp;
-    CpuTurboBoostController cpuTurboBoost;
+    using TimePoint = typename taClock::time_point;
+
+    RunningAvr<float, AvrSamplesCount, TimePoint> cpuAvrTemp;
+    RunningAvr<float, AvrSamplesCount, TimePoint> gpuAvrTemp;
+    CpuTurboBoostControllerT<taClock> cpuTurboBoost;
 
     template <typename taLeft, typename taRight>
     [[nodiscard]]
@@ -202,16 +261,11 @@ class BoostersOnOffDecider
 
         if (isGpuActive)
         {
-            static constexpr int kGpuTempLimit = 75; // 75°C GPU
-            static constexpr int kCpuTempLimit = 85; // 85°C CPU
-            static_assert(kGpuTempLimit < kCpuTempLimit, "Revise here.");
-
-            return greater(avrCpu, kCpuTempLimit) || greater(avrGpu, kGpuTempLimit);
+            return greater(avrCpu, params.cpuLimitWithGpu) || greater(avrGpu, params.gpuLimit);
         }
         else
         {
-            static constexpr int kCpuOnlyHotDegree = 91;
-            return greater(avrCpu, kCpuOnlyHotDegree);
+            return greater(avrCpu, params.cpuOnlyLimit);
         }
     }
 };
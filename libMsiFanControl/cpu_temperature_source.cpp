@@ -0,0 +1,68 @@
+#include "cpu_temperature_source.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <system_error>
+
+CHwmonCpuTemperature::CHwmonCpuTemperature(const std::filesystem::path &input) :
+    fd(open(input.c_str(), O_RDONLY | O_CLOEXEC))
+{
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "Failed to open " + input.string());
+    }
+}
+
+CHwmonCpuTemperature::~CHwmonCpuTemperature()
+{
+    close(fd);
+}
+
+CpuTemperatureSourcePtr CHwmonCpuTemperature::Create(const std::filesystem::path &root)
+{
+    const auto input = FindCoretempInput(root);
+    if (input.empty())
+    {
+        return nullptr;
+    }
+    try
+    {
+        auto source = std::make_shared<CHwmonCpuTemperature>(input);
+        if (source->ReadMilliCelsius())
+        {
+            std::cerr << "CPU temperature is read from " << input << std::endl << std::flush;
+            return source;
+        }
+    }
+    catch (std::exception &ex)
+    {
+        std::cerr << "Failed to use coretemp: " << ex.what() << std::endl << std::flush;
+    }
+    return nullptr;
+}
+
+std::optional<std::int32_t> CHwmonCpuTemperature::ReadMilliCelsius() const
+{
+    std::array<char, 32> text{};
+    ssize_t res = 0;
+    do
+    {
+        res = pread(fd, text.data(), text.size(), 0);
+    }
+    while (res < 0 && errno == EINTR);
+    if (res <= 0)
+    {
+        return std::nullopt;
+    }
+    return ParseHwmonMilliCelsius(std::string_view(text.data(), static_cast<std::size_t>(res)));
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "cm_ctors.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+/// @brief Source of the CPU temperature which does not need EC.
+class ICpuTemperatureSource
+{
+  public:
+    ICpuTemperatureSource() = default;
+    NO_COPYMOVE(ICpuTemperatureSource);
+    virtual ~ICpuTemperatureSource() = default;
+
+    /// @returns CPU (package) temperature in millidegrees Celsius or std::nullopt if it failed.
+    [[nodiscard]]
+    virtual std::optional<std::int32_t> ReadMilliCelsius() const = 0;
+};
+
+using CpuTemperatureSourcePtr = std::shared_ptr<ICpuTemperatureSource>;
+
+/// @returns Value of the hwmon's temp*_input file, like "45000\n".
+inline std::optional<std::int32_t> ParseHwmonMilliCelsius(std::string_view text)
+{
+    bool negative = false;
+    if (!text.empty() && text.front() == '-')
+    {
+        negative = true;
+        text.remove_prefix(1);
+    }
+    if (text.empty() || text.front() < '0' || text.front() > '9')
+    {
+        return std::nullopt;
+    }
+    std::int32_t value = 0;
+    for (std::size_t i = 0; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i)
+    {
+        value = value * 10 + (text[i] - '0');
+    }
+    return negative ? -value : value;
+}
+
+/// @brief Looks for the CPU package temperature of the Intel's "coretemp" hwmon driver under
+/// @p root. Sensor labelled "Package id 0" is preferred, temp1_input is used if there is no label.
+/// @returns Path to the temp*_input file or empty path if there is no coretemp.
+inline std::filesystem::path FindCoretempInput(const std::filesystem::path &root = "/sys/class/hwmon")
+{
+    namespace fs = std::filesystem;
+    const auto readLine = [](const fs::path &file) {
+        std::ifstream inp(file);
+        std::string line;
+        std::getline(inp, line);
+        return line;
+    };
+
+    std::error_code ec;
+    for (const auto &entry : fs::directory_iterator(root, ec))
+    {
+        const auto dir = entry.path();
+        if (readLine(dir / "name") != "coretemp")
+        {
+            continue;
+        }
+        for (const auto &sensor : fs::directory_iterator(dir, ec))
+        {
+            const auto name = sensor.path().filename().string();
+            constexpr std::string_view kLabel = "_label";
+            if (name.size() > kLabel.size() && name.compare(0, 4, "temp") == 0
+                && name.compare(name.size() - kLabel.size(), kLabel.size(), kLabel) == 0
+                && readLine(sensor.path()) == "Package id 0")
+            {
+                return dir / (name.substr(0, name.size() - kLabel.size()) + "_input");
+            }
+        }
+        if (fs::exists(dir / "temp1_input", ec))
+        {
+            return dir / "temp1_input";
+        }
+    }
+    return {};
+}
+
+/// @brief Reads CPU temperature out of the coretemp hwmon. It is MSR read done by kernel: no ACPI
+/// transaction and no IRQ9, and it has millidegree resolution. File is opened once and re-read by
+/// pread(), so it works after seccomp is engaged.
+class CHwmonCpuTemperature : public ICpuTemperatureSource
+{
+  public:
+    /// @throws std::system_error if @p input cannot be opened.
+    explicit CHwmonCpuTemperature(const std::filesystem::path &input);
+    NO_COPYMOVE(CHwmonCpuTemperature);
+    ~CHwmonCpuTemperature() override;
+
+    /// @returns Source over coretemp or nullptr if system does not have it.
+    static CpuTemperatureSourcePtr Create(const std::filesystem::path &root = "/sys/class/hwmon");
+
+    [[nodiscard]]
+    std::optional<std::int32_t> ReadMilliCelsius() const final;
+
+  private:
+    int fd;
+};
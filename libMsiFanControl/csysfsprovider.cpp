@@ -1,42 +1,106 @@
 #include "csysfsprovider.h" // IWYU pragma: keep
 
+#include "cm_ctors.h"
 #include "readwrite.h"
 #include "readwrite_provider.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <algorithm>
 #include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <ios>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <system_error>
 #include <utility>
 
 // NOLINTNEXTLINE
 extern bool GLOBAL_DRY_RUN;
 
-class ReadWriteProviderImpl : public IReadWriteProvider
+/// @brief Keeps single O_RDWR descriptor opened for the whole lifetime and accesses it by
+/// pread()/pwrite(). There is no iostream buffering/locale and no open/close per access.
+class PositionedIoProvider : public IReadWriteProvider
 {
-  private:
-    std::filesystem::path fileName;
-
   public:
-    explicit ReadWriteProviderImpl(std::filesystem::path fileName) :
-        fileName(std::move(fileName))
+    explicit PositionedIoProvider(const std::filesystem::path &fileName) :
+        fd(open(fileName.c_str(), O_RDWR | O_CLOEXEC))
     {
+        if (fd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(),
+                                    "Failed to open " + fileName.string());
+        }
     }
+    PositionedIoProvider() = delete;
+    NO_COPYMOVE(PositionedIoProvider);
 
-    [[nodiscard]]
-    std::ofstream WriteStream() const final
+    ~PositionedIoProvider() override
     {
-        return {fileName, std::ios_base::out | std::ios_base::binary | std::ios_base::app};
+        close(fd);
     }
 
-    [[nodiscard]]
-    std::ifstream ReadStream() const final
+    void ReadBytes(std::int64_t offset, std::uint8_t *buffer, std::size_t size) const final
     {
-        return {fileName, std::ios_base::in | std::ios_base::binary};
+        while (size > 0)
+        {
+            const auto res = pread(fd, buffer, size, offset);
+            if (res < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (res <= 0)
+            {
+                ThrowIoError("pread", offset, res);
+            }
+            const auto done = static_cast<std::size_t>(res);
+            buffer = std::next(buffer, res);
+            offset += res;
+            size -= done;
+        }
+    }
+
+    void WriteBytes(std::int64_t offset, const std::uint8_t *buffer, std::size_t size) const final
+    {
+        while (size > 0)
+        {
+            const auto res = pwrite(fd, buffer, size, offset);
+            if (res < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (res <= 0)
+            {
+                ThrowIoError("pwrite", offset, res);
+            }
+            const auto done = static_cast<std::size_t>(res);
+            buffer = std::next(buffer, res);
+            offset += res;
+            size -= done;
+        }
+    }
+
+  private:
+    int fd;
+
+    [[noreturn]]
+    static void ThrowIoError(const char *what, std::int64_t offset, ssize_t res)
+    {
+        const std::string text =
+          std::string(what) + " failed at offset " + std::to_string(offset) + ".";
+        if (res == 0)
+        {
+            throw std::runtime_error(text + " Unexpected end of file.");
+        }
+        throw std::system_error(errno, std::generic_category(), text);
     }
 };
 
@@ -55,13 +119,19 @@ std::shared_ptr<IReadWriteProvider> CSysFsProvider::CreateIoDirect(bool dryRun)
         return name;
     };
 
-    return std::make_shared<ReadWriteProviderImpl>(dryRun ? genDryRun()
-                                                          : "/sys/kernel/debug/ec/ec0/io");
+    return std::make_shared<PositionedIoProvider>(dryRun ? genDryRun()
+                                                         : "/sys/kernel/debug/ec/ec0/io");
 }
 
-CReadWrite CSysFsProvider::CreateIoObject(BackupProviderPtr backupProvider, bool dryRun)
+CReadWrite CSysFsProvider::CreateIoObject(BackupProviderPtr backupProvider, bool dryRun,
+                                          const ReadWriteProviderDecorator &decorator)
 {
-    return {CreateIoDirect(dryRun), std::move(backupProvider)};
+    auto io = CreateIoDirect(dryRun);
+    if (decorator)
+    {
+        io = decorator(std::move(io));
+    }
+    return {std::move(io), std::move(backupProvider)};
 }
 
 bool ReadFsBool(const std::filesystem::path &file)
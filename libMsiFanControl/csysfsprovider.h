@@ -13,7 +13,9 @@ class CSysFsProvider
   public:
     //! @param dryRun if true, then it will generated temp file with temp name, initially containing
     //! 256 zeroes.
-    static CReadWrite CreateIoObject(BackupProviderPtr backupProvider, bool dryRun = true);
+    //! @param decorator if not empty, it wraps direct access, for example to record EC traffic.
+    static CReadWrite CreateIoObject(BackupProviderPtr backupProvider, bool dryRun = true,
+                                     const ReadWriteProviderDecorator &decorator = {});
 
     //! @brief this gives direct access to modified files. It should not be used without real
     //! reason. use CReadWrite by CreateIoObject() instead.
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "cm_ctors.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+/// File defines daemon's self-profiling statistics. Daemon keeps them in separated shared memory,
+/// clients map it read-only (see msifanctl stats).
+
+/// @brief Phases of the single daemon's cycle (CSharedDevice::Communicate()).
+enum class CyclePhase : std::uint8_t {
+    REQUEST_PARSE,
+    EC_READ,
+    EC_WRITE,
+    SERIALIZE_PUBLISH,
+    /// @brief Handing OpenMetrics text to the metrics server. Cycle takes no interprocess locks.
+    METRICS_PUBLISH,
+    /// @brief Whole cycle which did any work.
+    CYCLE,
+    COUNT
+};
+
+inline constexpr std::size_t kCyclePhasesCount = static_cast<std::size_t>(CyclePhase::COUNT);
+
+inline const char *CyclePhaseName(CyclePhase phase)
+{
+    static constexpr std::array<const char *, kCyclePhasesCount> kNames = {
+      "request_parse", "ec_read", "ec_write", "serialize_publish", "metrics_publish", "cycle",
+    };
+    const auto index = static_cast<std::size_t>(phase);
+    return index < kNames.size() ? kNames.at(index) : "unknown";
+}
+
+/// @brief Histogram of the single phase copied out of shared memory.
+struct PhaseHistogram
+{
+    /// @brief Bucket i counts durations below 2^i microseconds, last one counts everything else.
+    static constexpr std::size_t kBuckets = 24;
+
+    std::uint64_t count{0};
+    std::uint64_t sumNs{0};
+    std::uint64_t maxNs{0};
+    std::array<std::uint64_t, kBuckets> buckets{};
+
+    static std::size_t BucketOf(std::chrono::nanoseconds duration)
+    {
+        const auto us = static_cast<std::uint64_t>(
+          std::max<std::int64_t>(duration.count(), 0) / 1000);
+        std::size_t bucket = 0;
+        while (bucket + 1 < kBuckets && (std::uint64_t{1} << bucket) <= us)
+        {
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    /// @brief Accounts @p duration, it is for the local (not shared) histograms.
+    void Record(std::chrono::nanoseconds duration)
+    {
+        const auto ns = static_cast<std::uint64_t>(std::max<std::int64_t>(duration.count(), 0));
+        ++count;
+        sumNs += ns;
+        maxNs = std::max(maxNs, ns);
+        ++buckets.at(BucketOf(duration));
+    }
+
+    /// @returns Upper bound of the bucket where @p quantile (0..1) of the samples are.
+    [[nodiscard]]
+    std::chrono::microseconds Quantile(double quantile) const
+    {
+        const auto wanted = static_cast<std::uint64_t>(quantile * static_cast<double>(count));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < kBuckets; ++i)
+        {
+            seen += buckets.at(i);
+            if (seen > wanted || (seen == count && seen > 0))
+            {
+                return std::chrono::microseconds(std::int64_t{1} << i);
+            }
+        }
+        return std::chrono::microseconds(0);
+    }
+};
+
+/// @brief All statistics copied out of shared memory.
+struct DaemonStatsSnapshot
+{
+    /// @brief Cycles longer than CDaemonStats::kCycleBudget.
+    std::uint64_t overruns{0};
+    std::array<PhaseHistogram, kCyclePhasesCount> phases{};
+};
+
+/// @brief Fixed bucket latency histograms placed over raw (shared) memory block. Single writer
+/// (daemon) updates them without allocations and locks, readers copy them out. Counters are
+/// independent atomics, so snapshot may be off by the sample being recorded at the moment.
+///
+/// Layout: [overruns u64, padded to 64][phase 0]...[phase N-1], phase is
+/// [count u64][sum ns u64][max ns u64][buckets u64 x kBuckets]. Memory must be zero-initialized
+/// before 1st use (shm is after ftruncate()).
+/// @note Object does not own memory, it is cheap to create.
+class CDaemonStats
+{
+  public:
+    /// @brief Cycle longer than this is overrun.
+    static constexpr auto kCycleBudget = std::chrono::milliseconds(50);
+
+    static constexpr std::size_t RequiredSize()
+    {
+        return kHeaderSize + kCyclePhasesCount * sizeof(Phase);
+    }
+
+    CDaemonStats(char *base, std::size_t size) :
+        base(base)
+    {
+        if (size < RequiredSize())
+        {
+            throw std::invalid_argument("Memory block is too small for the daemon's stats.");
+        }
+    }
+
+    /// @brief Writer only.
+    void Record(CyclePhase phase, std::chrono::nanoseconds duration) const
+    {
+        auto &dst = PhaseAt(phase);
+        const auto ns = static_cast<std::uint64_t>(std::max<std::int64_t>(duration.count(), 0));
+        dst.count.fetch_add(1, std::memory_order_relaxed);
+        dst.sumNs.fetch_add(ns, std::memory_order_relaxed);
+        if (ns > dst.maxNs.load(std::memory_order_relaxed))
+        {
+            dst.maxNs.store(ns, std::memory_order_relaxed);
+        }
+        dst.buckets.at(PhaseHistogram::BucketOf(duration)).fetch_add(1, std::memory_order_relaxed);
+
+        if (phase == CyclePhase::CYCLE && duration > kCycleBudget)
+        {
+            Overruns().fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    [[nodiscard]]
+    DaemonStatsSnapshot Snapshot() const
+    {
+        DaemonStatsSnapshot res;
+        res.overruns = Overruns().load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < kCyclePhasesCount; ++i)
+        {
+            const auto &src = PhaseAt(static_cast<CyclePhase>(i));
+            auto &dst = res.phases.at(i);
+            dst.count = src.count.load(std::memory_order_relaxed);
+            dst.sumNs = src.sumNs.load(std::memory_order_relaxed);
+            dst.maxNs = src.maxNs.load(std::memory_order_relaxed);
+            for (std::size_t b = 0; b < PhaseHistogram::kBuckets; ++b)
+            {
+                dst.buckets.at(b) = src.buckets.at(b).load(std::memory_order_relaxed);
+            }
+        }
+        return res;
+    }
+
+  private:
+    static constexpr std::size_t kHeaderSize = 64;
+
+    struct Phase
+    {
+        std::atomic<std::uint64_t> count;
+        std::atomic<std::uint64_t> sumNs;
+        std::atomic<std::uint64_t> maxNs;
+        std::array<std::atomic<std::uint64_t>, PhaseHistogram::kBuckets> buckets;
+    };
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                  "Atomics in shared memory must be lock-free.");
+
+    char *base;
+
+    std::atomic<std::uint64_t> &Overruns() const
+    {
+        // NOLINTNEXTLINE
+        return *reinterpret_cast<std::atomic<std::uint64_t> *>(base);
+    }
+
+    Phase &PhaseAt(CyclePhase phase) const
+    {
+        // NOLINTNEXTLINE
+        return reinterpret_cast<Phase *>(base + kHeaderSize)[static_cast<std::size_t>(phase)];
+    }
+};
+
+/// @brief Records time from construction to destruction as @p phase.
+class CPhaseTimer
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    CPhaseTimer(const CDaemonStats &stats, CyclePhase phase) :
+        stats(stats),
+        phase(phase),
+        started(Clock::now())
+    {
+    }
+    NO_COPYMOVE(CPhaseTimer);
+
+    ~CPhaseTimer()
+    {
+        stats.Record(phase, Clock::now() - started);
+    }
+
+  private:
+    const CDaemonStats &stats;
+    CyclePhase phase;
+    Clock::time_point started;
+};
+
+/// @returns Shared memory name of the daemon's statistics.
+inline const char *GetStatsMemoryName()
+{
+    static const char *const ptr = "MSICoolersDaemonStats1";
+    return ptr;
+}
+
+/// @brief Size of the statistics' shared memory, rounded to the whole pages.
+inline constexpr std::size_t kStatsSharedMemSize = [] {
+    constexpr std::size_t kPage = 4096;
+    return (CDaemonStats::RequiredSize() + kPage - 1) / kPage * kPage;
+}();
@@ -1,13 +1,15 @@
 #include "device.h" // IWYU pragma: keep
 
 #include "command_detector.h"
-#include "csysfsprovider.h"
 #include "device_commands.h" // IWYU pragma: keep
 #include "messages_types.h"  // IWYU pragma: keep
-#include "readwrite.h"       // IWYU pragma: keep
+#include "read_plan.h"
+#include "readwrite.h" // IWYU pragma: keep
+#include "turbo_boost_switch.h"
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <iosfwd>
 #include <iterator>
 #include <optional>
@@ -71,8 +73,9 @@ Info::Info(const AddressedValueAny &temp, const AddressedValueAny &rpm) :
 {
 }
 
-CDevice::CDevice(CReadWrite readWrite) :
-    readWriteAccess(std::move(readWrite))
+CDevice::CDevice(CReadWrite readWrite, TurboBoostSwitchPtr turboBoost) :
+    readWriteAccess(std::move(readWrite)),
+    turboBoost(turboBoost ? std::move(turboBoost) : std::make_shared<CIntelPStateTurboBoost>())
 {
 }
 CDevice::~CDevice() = default;
@@ -80,13 +83,8 @@ CDevice::~CDevice() = default;
 CpuGpuInfo CDevice::ReadInfo() const
 {
     auto cmd = GetCmdTempRPM();
-    Throw(cmd.size() == 4,
-          "We expect 4 commands: temp getter, then RPM getter for CPU, then for GPU.");
     readWriteAccess.Read(cmd);
-    const Info cpu(cmd.at(0), cmd.at(1));
-    const Info gpu(cmd.at(2), cmd.at(3));
-
-    return {cpu, gpu};
+    return ParseInfo(cmd);
 }
 
 BoostersStates CDevice::ReadBoostersStates() const
@@ -95,30 +93,38 @@ BoostersStates CDevice::ReadBoostersStates() const
     const auto clone = cmd;
     readWriteAccess.Read(cmd);
 
-    const auto diff = cmd.GetOneDifference(clone);
-    Throw(diff != std::nullopt,
-          "Something went wrong. Read should indicate BOOSTER's changed state.");
+    return {ParseBoosterState(cmd, clone), ReadCpuTurboBoostState()};
+}
 
-    const bool isTurboEnabled = !ReadFsBool(kIntelPStateNoTurbo);
+CReadWrite::WriteHandle CDevice::StartWrites() const
+{
+    return readWriteAccess.StartWritting();
+}
 
-    // We read OFF state different, that means there is ON state in device.
-    return {!diff || diff->first == BoosterState::OFF ? BoosterState::ON : BoosterState::OFF,
-            isTurboEnabled ? CpuTurboBoostState::ON : CpuTurboBoostState::OFF};
+void CDevice::CommitWrites(CReadWrite::WriteHandle &session) const
+{
+    readWriteAccess.Commit(session);
 }
 
 void CDevice::SetBoosters(const BoostersStates what) const
 {
-    auto handle = readWriteAccess.StartWritting();
+    auto handle = StartWrites();
+    SetBoosters(what, handle);
+    CommitWrites(handle);
+}
+
+void CDevice::SetBoosters(const BoostersStates what, CReadWrite::WriteHandle &session) const
+{
     auto cmd = GetCmdBoosterStates();
-    readWriteAccess.Write(handle, {cmd.at(what.fanBoosterState)});
+    readWriteAccess.Write(session, {cmd.at(what.fanBoosterState)});
 
     switch (what.cpuTurboBoostState)
     {
         case CpuTurboBoostState::OFF:
-            WriteFsBool(kIntelPStateNoTurbo, true);
+            turboBoost->SetDisabled(true);
             break;
         case CpuTurboBoostState::ON:
-            WriteFsBool(kIntelPStateNoTurbo, false);
+            turboBoost->SetDisabled(false);
             break;
         case CpuTurboBoostState::NO_CHANGE:
             break;
@@ -129,33 +135,33 @@ BehaveWithCurve CDevice::ReadBehaveState() const
 {
     auto cmd = GetCmdBehaveStates();
     const auto clone = cmd;
-    readWriteAccess.Read(cmd);
-
-    const auto diff = cmd.GetOneDifference(clone);
-    Throw(diff != std::nullopt,
-          "Something went wrong. Read should indicate BEHAVE's changed state.");
-
-    // Same logic as in booster, if "auto" is different, then "advanced" is set there.
     BehaveWithCurve res;
-    res.behaveState =
-      diff && diff->first == BehaveState::AUTO ? BehaveState::ADVANCED : BehaveState::AUTO;
 
-    readWriteAccess.Read(res.curve.cpu);
-    readWriteAccess.Read(res.curve.gpu);
+    CReadPlan plan;
+    plan.Add(cmd).Add(res.curve.cpu).Add(res.curve.gpu);
+    readWriteAccess.Read(plan);
+
+    res.behaveState = ParseBehaveState(cmd, clone);
     return res;
 }
 
 void CDevice::SetBehaveState(const BehaveWithCurve &behaveWithCurve) const
 {
-    auto cmd = GetCmdBehaveStates();
-    auto handle = readWriteAccess.StartWritting();
+    auto handle = StartWrites();
+    SetBehaveState(behaveWithCurve, handle);
+    CommitWrites(handle);
+}
 
+void CDevice::SetBehaveState(const BehaveWithCurve &behaveWithCurve,
+                             CReadWrite::WriteHandle &session) const
+{
+    auto cmd = GetCmdBehaveStates();
     if (BehaveState::NO_CHANGE != behaveWithCurve.behaveState)
     {
         behaveWithCurve.curve.Validate();
-        readWriteAccess.Write(handle, behaveWithCurve.curve.cpu);
-        readWriteAccess.Write(handle, behaveWithCurve.curve.gpu);
-        readWriteAccess.Write(handle, {cmd.at(behaveWithCurve.behaveState)});
+        readWriteAccess.Write(session, behaveWithCurve.curve.cpu);
+        readWriteAccess.Write(session, behaveWithCurve.curve.gpu);
+        readWriteAccess.Write(session, {cmd.at(behaveWithCurve.behaveState)});
     }
 }
 
@@ -182,6 +188,13 @@ Battery CDevice::ReadBattery() const
                   conf.charge_control.offset_end + 60);
 */
 void CDevice::SetBattery(const Battery &battery) const
+{
+    auto handle = StartWrites();
+    SetBattery(battery, handle);
+    CommitWrites(handle);
+}
+
+void CDevice::SetBattery(const Battery &battery, CReadWrite::WriteHandle &session) const
 {
     if (const auto val = Battery::StateToPercents(battery.maxLevel))
     {
@@ -189,16 +202,150 @@ void CDevice::SetBattery(const Battery &battery) const
         {
             readWriteAccess.CancelBackupOn(*cmd);
             cmd->value = *val;
-            auto handle = readWriteAccess.StartWritting();
-            readWriteAccess.Write(handle, {*cmd});
+            readWriteAccess.Write(session, {*cmd});
         }
     }
 }
 
 FullInfoBlock CDevice::ReadFullInformation(std::size_t aTag) const
 {
-    return {aTag,          ReadInfo(),   ReadBoostersStates(), ReadBehaveState(),
-            std::string{}, ReadBattery()};
+    ClassifyRegisters();
+
+    auto tempRpmCmd = GetCmdTempRPM();
+    auto boosterCmd = GetCmdBoosterStates();
+    const auto boosterClone = boosterCmd;
+    auto behaveCmd = GetCmdBehaveStates();
+    const auto behaveClone = behaveCmd;
+    auto batteryCmd = GetBatteryThreshold();
+    BehaveWithCurve behave;
+
+    // CPU temperature register is not read from EC if there is cheaper source.
+    const auto cpuSampledAt = Info::SampleClock::now();
+    const auto cpuTemperature = ReadCpuTemperature();
+    CReadPlan plan;
+    for (std::size_t i = 0; i < tempRpmCmd.size(); ++i)
+    {
+        if (i != 0 || !cpuTemperature)
+        {
+            plan.AddOne(tempRpmCmd.at(i));
+        }
+    }
+
+    // Booster & behave states contain the same address per state, and curves are contiguous, so
+    // plan makes much less EC transactions than separated reads.
+    plan.Add(boosterCmd).Add(behaveCmd).Add(behave.curve.cpu).Add(behave.curve.gpu);
+    if (batteryCmd)
+    {
+        plan.AddOne(*batteryCmd);
+    }
+    const auto ecSampledAt = Info::SampleClock::now();
+    readWriteAccess.Read(plan);
+
+    behave.behaveState = ParseBehaveState(behaveCmd, behaveClone);
+    const BoostersStates boosters{ParseBoosterState(boosterCmd, boosterClone),
+                                  ReadCpuTurboBoostState()};
+
+    // Sensors served by the register cache keep time of their real read.
+    const auto acquiredAt = [this, ecSampledAt](const AddressedValueAny &temperature,
+                                                const AddressedValueAny &rpm) {
+        return readWriteAccess.AcquiredAt(AddressedValueAnyList{temperature, rpm})
+          .value_or(ecSampledAt);
+    };
+    auto info = ParseInfo(tempRpmCmd);
+    info.cpu.SetSampledAt(acquiredAt(tempRpmCmd.at(0), tempRpmCmd.at(1)));
+    info.gpu.SetSampledAt(acquiredAt(tempRpmCmd.at(2), tempRpmCmd.at(3)));
+    if (cpuTemperature)
+    {
+        info.cpu.SetTemperatureMilli(*cpuTemperature);
+        info.cpu.SetSampledAt(cpuSampledAt);
+    }
+
+    return {aTag,
+            info,
+            boosters,
+            std::move(behave),
+            std::string{},
+            batteryCmd ? Battery{*batteryCmd} : Battery{}};
+}
+
+void CDevice::SetCpuTemperatureSource(CpuTemperatureSourcePtr source)
+{
+    cpuTemperatureSource = std::move(source);
+}
+
+bool CDevice::HasCpuTemperatureSource() const
+{
+    return cpuTemperatureSource != nullptr;
+}
+
+std::optional<std::int32_t> CDevice::ReadCpuTemperature() const
+{
+    return cpuTemperatureSource ? cpuTemperatureSource->ReadMilliCelsius() : std::nullopt;
+}
+
+RegisterClassCounters CDevice::BytesReadByClass() const
+{
+    return readWriteAccess.BytesReadByClass();
+}
+
+void CDevice::ClassifyRegisters() const
+{
+    if (registersClassified)
+    {
+        return;
+    }
+
+    readWriteAccess.ClassifyRegisters(GetCmdTempRPM(), RegisterClass::FAST_SENSOR);
+    readWriteAccess.ClassifyRegisters(GetCmdBoosterStates(), RegisterClass::SLOW_SETTING);
+    readWriteAccess.ClassifyRegisters(GetCmdBehaveStates(), RegisterClass::SLOW_SETTING);
+    if (const auto battery = GetBatteryThreshold())
+    {
+        readWriteAccess.ClassifyRegisters(AddressedValueAnyList{*battery},
+                                          RegisterClass::SLOW_SETTING);
+    }
+
+    // Firmware does not touch fan's curves, only we do (and that invalidates cache).
+    const auto curves = CpuGpuFanCurve::MakeDefault();
+    readWriteAccess.ClassifyRegisters(curves.cpu, RegisterClass::STATIC);
+    readWriteAccess.ClassifyRegisters(curves.gpu, RegisterClass::STATIC);
+
+    registersClassified = true;
+}
+
+CpuGpuInfo CDevice::ParseInfo(const AddressedValueAnyList &readCmd)
+{
+    Throw(readCmd.size() == 4,
+          "We expect 4 commands: temp getter, then RPM getter for CPU, then for GPU.");
+    const Info cpu(readCmd.at(0), readCmd.at(1));
+    const Info gpu(readCmd.at(2), readCmd.at(3));
+
+    return {cpu, gpu};
+}
+
+BoosterState CDevice::ParseBoosterState(const BoosterStates &readCmd,
+                                        const BoosterStates &originalCmd)
+{
+    const auto diff = readCmd.GetOneDifference(originalCmd);
+    Throw(diff != std::nullopt,
+          "Something went wrong. Read should indicate BOOSTER's changed state.");
+
+    // We read OFF state different, that means there is ON state in device.
+    return !diff || diff->first == BoosterState::OFF ? BoosterState::ON : BoosterState::OFF;
+}
+
+BehaveState CDevice::ParseBehaveState(const BehaveStates &readCmd, const BehaveStates &originalCmd)
+{
+    const auto diff = readCmd.GetOneDifference(originalCmd);
+    Throw(diff != std::nullopt,
+          "Something went wrong. Read should indicate BEHAVE's changed state.");
+
+    // Same logic as in booster, if "auto" is different, then "advanced" is set there.
+    return diff && diff->first == BehaveState::AUTO ? BehaveState::ADVANCED : BehaveState::AUTO;
+}
+
+CpuTurboBoostState CDevice::ReadCpuTurboBoostState() const
+{
+    return turboBoost->IsDisabled() ? CpuTurboBoostState::OFF : CpuTurboBoostState::ON;
 }
 
 AddressedValueAnyList CDevice::GetCmdTempRPM() const
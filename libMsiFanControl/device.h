@@ -1,11 +1,14 @@
 #pragma once
 
 #include "cm_ctors.h"
+#include "cpu_temperature_source.h"
 #include "device_commands.h"
 #include "messages_types.h" // IWYU pragma: keep
 #include "readwrite.h"      // IWYU pragma: keep
+#include "turbo_boost_switch.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <optional>
 
 /// @brief This represents physical device we're on. Like whole laptop, with fans, CPU, GPU etc.
@@ -17,7 +20,8 @@ class CDevice
     CDevice() = delete;
     NO_COPYMOVE(CDevice);
 
-    explicit CDevice(CReadWrite readWrite);
+    /// @param turboBoost Switch of the CPU's turbo-boost, nullptr means intel_pstate of the host.
+    explicit CDevice(CReadWrite readWrite, TurboBoostSwitchPtr turboBoost = nullptr);
     virtual ~CDevice();
 
     CpuGpuInfo ReadInfo() const;
@@ -31,8 +35,41 @@ class CDevice
     Battery ReadBattery() const;
     void SetBattery(const Battery &battery) const;
 
+    /// @brief Starts EC write session. Setters below only stage writes into the @p session, all of
+    /// them are sent to EC by CommitWrites() (or when session is destroyed) as single transaction.
+    /// @note This object must outlive returned session.
+    [[nodiscard]]
+    CReadWrite::WriteHandle StartWrites() const;
+    void CommitWrites(CReadWrite::WriteHandle &session) const;
+
+    void SetBoosters(const BoostersStates what, CReadWrite::WriteHandle &session) const;
+    void SetBehaveState(const BehaveWithCurve &behaveWithCurve,
+                        CReadWrite::WriteHandle &session) const;
+    void SetBattery(const Battery &battery, CReadWrite::WriteHandle &session) const;
+
+    /// @brief Reads everything in one go. All commands are merged into single read plan, so each
+    /// EC byte is read once per call. Settings which are still fresh in the register cache are not
+    /// read at all.
     FullInfoBlock ReadFullInformation(std::size_t aTag) const;
 
+    /// @brief Sets source of the CPU temperature which is used instead of EC register. EC is still
+    /// used if @p source is nullptr or it fails.
+    void SetCpuTemperatureSource(CpuTemperatureSourcePtr source);
+
+    /// @returns true if CPU temperature can be read without EC (see ReadCpuTemperature()).
+    [[nodiscard]]
+    bool HasCpuTemperatureSource() const;
+
+    /// @brief Cheap path: reads only CPU temperature from the source set by
+    /// SetCpuTemperatureSource(), EC is not touched.
+    /// @returns Millidegrees Celsius or std::nullopt if there is no source or it failed.
+    [[nodiscard]]
+    std::optional<std::int32_t> ReadCpuTemperature() const;
+
+    /// @returns Bytes read from EC so far per register class (see CReadWrite::BytesReadByClass()).
+    [[nodiscard]]
+    RegisterClassCounters BytesReadByClass() const;
+
   protected:
     using BoosterStates = AddressedValueStates<BoosterState>;
     using BehaveStates = AddressedValueStates<BehaveState>;
@@ -50,5 +87,19 @@ class CDevice
     virtual std::optional<AddressedBits> GetBatteryThreshold() const;
 
   private:
+    static CpuGpuInfo ParseInfo(const AddressedValueAnyList &readCmd);
+    static BoosterState ParseBoosterState(const BoosterStates &readCmd,
+                                          const BoosterStates &originalCmd);
+    static BehaveState ParseBehaveState(const BehaveStates &readCmd,
+                                        const BehaveStates &originalCmd);
+    CpuTurboBoostState ReadCpuTurboBoostState() const;
+
+    /// @brief Tags all known registers for the register cache of the readWriteAccess once, so
+    /// rarely changed registers are not re-read on each refresh.
+    void ClassifyRegisters() const;
+
     CReadWrite readWriteAccess;
+    mutable bool registersClassified{false};
+    CpuTemperatureSourcePtr cpuTemperatureSource;
+    TurboBoostSwitchPtr turboBoost;
 };
@@ -0,0 +1,469 @@
+#pragma once
+
+#include "cm_ctors.h"
+#include "readwrite_provider.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// @brief Binary trace of the EC traffic.
+///
+/// File starts by kEcTraceMagic, than records follow. Each record is 16 bytes header and value
+/// bytes. All numbers are little endian:
+///   u8  operation (EcTraceOperation)
+///   u8  width - amount of the value bytes
+///   u16 address of the 1st byte
+///   u32 latency of the access, ns (saturated)
+///   u64 timestamp of the access start, ns since recording started (steady clock)
+///   u8[width] value bytes as they were read / written.
+
+enum class EcTraceOperation : std::uint8_t {
+    READ = 0,
+    WRITE = 1,
+};
+
+struct EcTraceRecord
+{
+    EcTraceOperation operation{EcTraceOperation::READ};
+    std::uint16_t address{0};
+    std::chrono::nanoseconds timestamp{0};
+    std::chrono::nanoseconds latency{0};
+    std::vector<std::uint8_t> values;
+};
+
+using EcTrace = std::vector<EcTraceRecord>;
+
+/// @brief Amount of the accesses. Each byte is separated ACPI transaction on real device.
+struct EcTrafficStatistics
+{
+    std::size_t readCalls{0};
+    std::size_t writeCalls{0};
+    std::size_t bytesRead{0};
+    std::size_t bytesWritten{0};
+
+    [[nodiscard]]
+    std::size_t Transactions() const
+    {
+        return bytesRead + bytesWritten;
+    }
+
+    void Account(EcTraceOperation operation, std::size_t size)
+    {
+        if (operation == EcTraceOperation::READ)
+        {
+            ++readCalls;
+            bytesRead += size;
+        }
+        else
+        {
+            ++writeCalls;
+            bytesWritten += size;
+        }
+    }
+};
+
+inline constexpr std::array<char, 8> kEcTraceMagic{'M', 'S', 'I', 'E', 'C', 'T', 'R', '1'};
+
+namespace ec_trace_details {
+inline constexpr std::size_t kRecordHeaderSize = 16;
+
+template <typename taValue>
+void PutLe(std::uint8_t *dst, taValue value)
+{
+    for (std::size_t i = 0; i < sizeof(taValue); ++i)
+    {
+        dst[i] = static_cast<std::uint8_t>(value & 0xFFu);
+        value = static_cast<taValue>(value >> 8u);
+    }
+}
+
+template <typename taValue>
+taValue GetLe(const std::uint8_t *src)
+{
+    taValue value = 0;
+    for (std::size_t i = sizeof(taValue); i > 0; --i)
+    {
+        value = static_cast<taValue>((value << 8u) | src[i - 1]);
+    }
+    return value;
+}
+} // namespace ec_trace_details
+
+inline void WriteEcTraceHeader(std::ostream &out)
+{
+    out.write(kEcTraceMagic.data(), kEcTraceMagic.size());
+}
+
+/// @brief Appends single record. Values longer than 255 bytes must be split by caller.
+inline void WriteEcTraceRecord(std::ostream &out, const EcTraceRecord &record)
+{
+    using namespace ec_trace_details;
+    if (record.values.size() > std::numeric_limits<std::uint8_t>::max())
+    {
+        throw std::invalid_argument("EC trace record is too wide.");
+    }
+    const auto latency = std::min<std::chrono::nanoseconds::rep>(
+      record.latency.count(), std::numeric_limits<std::uint32_t>::max());
+
+    std::array<std::uint8_t, kRecordHeaderSize> header{};
+    header[0] = static_cast<std::uint8_t>(record.operation);
+    header[1] = static_cast<std::uint8_t>(record.values.size());
+    PutLe<std::uint16_t>(&header[2], record.address);
+    PutLe<std::uint32_t>(&header[4], static_cast<std::uint32_t>(latency));
+    PutLe<std::uint64_t>(&header[8], static_cast<std::uint64_t>(record.timestamp.count()));
+
+    // NOLINTNEXTLINE
+    out.write(reinterpret_cast<const char *>(header.data()), header.size());
+    // NOLINTNEXTLINE
+    out.write(reinterpret_cast<const char *>(record.values.data()),
+              static_cast<std::streamsize>(record.values.size()));
+}
+
+/// @brief Parses whole trace.
+/// @throws std::runtime_error if stream is not a trace or it is truncated.
+inline EcTrace ReadEcTrace(std::istream &in)
+{
+    using namespace ec_trace_details;
+    std::array<char, kEcTraceMagic.size()> magic{};
+    if (!in.read(magic.data(), magic.size()) || magic != kEcTraceMagic)
+    {
+        throw std::runtime_error("It is not EC trace.");
+    }
+
+    EcTrace trace;
+    std::array<std::uint8_t, kRecordHeaderSize> header{};
+    // NOLINTNEXTLINE
+    while (in.read(reinterpret_cast<char *>(header.data()), header.size()))
+    {
+        EcTraceRecord record;
+        if (header[0] > static_cast<std::uint8_t>(EcTraceOperation::WRITE))
+        {
+            throw std::runtime_error("Unknown operation in EC trace.");
+        }
+        record.operation = static_cast<EcTraceOperation>(header[0]);
+        record.address = GetLe<std::uint16_t>(&header[2]);
+        record.latency = std::chrono::nanoseconds(GetLe<std::uint32_t>(&header[4]));
+        record.timestamp = std::chrono::nanoseconds(GetLe<std::uint64_t>(&header[8]));
+        record.values.resize(header[1]);
+        // NOLINTNEXTLINE
+        if (!in.read(reinterpret_cast<char *>(record.values.data()),
+                     static_cast<std::streamsize>(record.values.size())))
+        {
+            throw std::runtime_error("EC trace is truncated.");
+        }
+        trace.emplace_back(std::move(record));
+    }
+    if (in.gcount() != 0)
+    {
+        throw std::runtime_error("EC trace is truncated.");
+    }
+    return trace;
+}
+
+inline EcTrace ReadEcTrace(const std::filesystem::path &fileName)
+{
+    std::ifstream in(fileName, std::ios_base::in | std::ios_base::binary);
+    if (!in)
+    {
+        throw std::runtime_error("Cannot open EC trace " + fileName.string());
+    }
+    return ReadEcTrace(in);
+}
+
+/// @returns Amount of the accesses recorded.
+inline EcTrafficStatistics SummarizeEcTrace(const EcTrace &trace)
+{
+    EcTrafficStatistics stats;
+    for (const auto &record : trace)
+    {
+        stats.Account(record.operation, record.values.size());
+    }
+    return stats;
+}
+
+/// @brief Decorator which passes all accesses to the wrapped provider and records each of them
+/// into the trace. Failed accesses are not recorded.
+/// @note This class is thread-safe if wrapped provider is.
+class CRecordingProvider : public IReadWriteProvider
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    CRecordingProvider(ReadWriteProviderPtr wrapped, std::unique_ptr<std::ostream> output) :
+        wrapped(std::move(wrapped)),
+        output(std::move(output)),
+        started(Clock::now())
+    {
+        if (!this->wrapped || !this->output)
+        {
+            throw std::invalid_argument("Recording provider needs provider and output.");
+        }
+        WriteEcTraceHeader(*this->output);
+        this->output->flush();
+    }
+
+    CRecordingProvider(ReadWriteProviderPtr wrapped, const std::filesystem::path &fileName) :
+        CRecordingProvider(std::move(wrapped),
+                           std::make_unique<std::ofstream>(fileName, std::ios_base::out
+                                                                       | std::ios_base::trunc
+                                                                       | std::ios_base::binary))
+    {
+        if (!*output)
+        {
+            throw std::runtime_error("Cannot create EC trace " + fileName.string());
+        }
+    }
+    NO_COPYMOVE(CRecordingProvider);
+    ~CRecordingProvider() override = default;
+
+    void ReadBytes(std::int64_t offset, std::uint8_t *buffer, std::size_t size) const final
+    {
+        const auto start = Clock::now();
+        wrapped->ReadBytes(offset, buffer, size);
+        Record(EcTraceOperation::READ, offset, buffer, size, start, Clock::now());
+    }
+
+    void WriteBytes(std::int64_t offset, const std::uint8_t *buffer, std::size_t size) const final
+    {
+        const auto start = Clock::now();
+        wrapped->WriteBytes(offset, buffer, size);
+        Record(EcTraceOperation::WRITE, offset, buffer, size, start, Clock::now());
+    }
+
+    [[nodiscard]]
+    EcTrafficStatistics Statistics() const
+    {
+        const std::lock_guard grd(mutex);
+        return statistics;
+    }
+
+  private:
+    ReadWriteProviderPtr wrapped;
+    std::unique_ptr<std::ostream> output;
+    Clock::time_point started;
+
+    mutable std::mutex mutex;
+    mutable EcTrafficStatistics statistics;
+
+    void Record(EcTraceOperation operation, std::int64_t offset, const std::uint8_t *buffer,
+                std::size_t size, Clock::time_point start, Clock::time_point end) const
+    {
+        constexpr std::size_t kMaxWidth = std::numeric_limits<std::uint8_t>::max();
+        const std::lock_guard grd(mutex);
+        statistics.Account(operation, size);
+        for (std::size_t done = 0; done < size; done += kMaxWidth)
+        {
+            const auto address = offset + static_cast<std::int64_t>(done);
+            if (address < 0 || address > std::numeric_limits<std::uint16_t>::max())
+            {
+                throw std::out_of_range("EC trace cannot record address "
+                                        + std::to_string(address));
+            }
+            const auto width = std::min(kMaxWidth, size - done);
+            const auto *const from = std::next(buffer, static_cast<std::ptrdiff_t>(done));
+
+            EcTraceRecord record;
+            record.operation = operation;
+            record.address = static_cast<std::uint16_t>(address);
+            record.timestamp = start - started;
+            record.latency = end - start;
+            record.values.assign(from, std::next(from, static_cast<std::ptrdiff_t>(width)));
+            WriteEcTraceRecord(*output, record);
+        }
+        // Trace must survive daemon's crash, and EC is accessed few times per second only.
+        output->flush();
+    }
+};
+
+/// @brief Decorator which only counts accesses, it is cheap enough to be always on.
+/// @note This class is thread-safe if wrapped provider is.
+class CCountingProvider : public IReadWriteProvider
+{
+  public:
+    explicit CCountingProvider(ReadWriteProviderPtr wrapped) :
+        wrapped(std::move(wrapped))
+    {
+        if (!this->wrapped)
+        {
+            throw std::invalid_argument("Counting provider needs provider.");
+        }
+    }
+    NO_COPYMOVE(CCountingProvider);
+    ~CCountingProvider() override = default;
+
+    void ReadBytes(std::int64_t offset, std::uint8_t *buffer, std::size_t size) const final
+    {
+        wrapped->ReadBytes(offset, buffer, size);
+        readCalls.fetch_add(1, std::memory_order_relaxed);
+        bytesRead.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    void WriteBytes(std::int64_t offset, const std::uint8_t *buffer, std::size_t size) const final
+    {
+        wrapped->WriteBytes(offset, buffer, size);
+        writeCalls.fetch_add(1, std::memory_order_relaxed);
+        bytesWritten.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]]
+    EcTrafficStatistics Statistics() const
+    {
+        EcTrafficStatistics res;
+        res.readCalls = readCalls.load(std::memory_order_relaxed);
+        res.writeCalls = writeCalls.load(std::memory_order_relaxed);
+        res.bytesRead = bytesRead.load(std::memory_order_relaxed);
+        res.bytesWritten = bytesWritten.load(std::memory_order_relaxed);
+        return res;
+    }
+
+  private:
+    ReadWriteProviderPtr wrapped;
+    mutable std::atomic<std::size_t> readCalls{0};
+    mutable std::atomic<std::size_t> writeCalls{0};
+    mutable std::atomic<std::size_t> bytesRead{0};
+    mutable std::atomic<std::size_t> bytesWritten{0};
+};
+
+/// @brief Serves recorded trace back deterministically. Replay time is moved by AdvanceTo() only,
+/// so the same sequence of the calls gives the same values no matter how fast it runs.
+///
+/// Provider keeps image of the registers. At replay time T each register has value of the latest
+/// recorded read with timestamp <= T, registers not read yet have value of the 1st recorded read.
+/// Writes of the replayed code are applied to the image (until trace reads that register again),
+/// recorded writes are not applied: device reports their effect by next recorded read anyway.
+/// @note This class is thread-safe.
+class CReplayProvider : public IReadWriteProvider
+{
+  public:
+    explicit CReplayProvider(EcTrace trace) :
+        trace(std::move(trace)),
+        image(kImageSize, 0)
+    {
+        std::vector<bool> seen(kImageSize, false);
+        for (const auto &record : this->trace)
+        {
+            if (record.operation != EcTraceOperation::READ)
+            {
+                continue;
+            }
+            for (std::size_t i = 0; i < record.values.size(); ++i)
+            {
+                const auto address = record.address + i;
+                if (address < kImageSize && !seen[address])
+                {
+                    seen[address] = true;
+                    image[address] = record.values[i];
+                }
+            }
+        }
+        ApplyUpTo(std::chrono::nanoseconds(0));
+    }
+
+    explicit CReplayProvider(const std::filesystem::path &fileName) :
+        CReplayProvider(ReadEcTrace(fileName))
+    {
+    }
+    NO_COPYMOVE(CReplayProvider);
+    ~CReplayProvider() override = default;
+
+    void ReadBytes(std::int64_t offset, std::uint8_t *buffer, std::size_t size) const final
+    {
+        const std::lock_guard grd(mutex);
+        CheckRange(offset, size);
+        std::copy_n(std::next(image.begin(), offset), size, buffer);
+        statistics.Account(EcTraceOperation::READ, size);
+    }
+
+    void WriteBytes(std::int64_t offset, const std::uint8_t *buffer, std::size_t size) const final
+    {
+        const std::lock_guard grd(mutex);
+        CheckRange(offset, size);
+        std::copy_n(buffer, size, std::next(image.begin(), offset));
+        statistics.Account(EcTraceOperation::WRITE, size);
+    }
+
+    /// @brief Moves replay time forward to @p sinceStart (relative to recording start).
+    void AdvanceTo(std::chrono::nanoseconds sinceStart)
+    {
+        const std::lock_guard grd(mutex);
+        ApplyUpTo(sinceStart);
+    }
+
+    /// @returns Timestamp of the last record.
+    [[nodiscard]]
+    std::chrono::nanoseconds Duration() const
+    {
+        return trace.empty() ? std::chrono::nanoseconds(0) : trace.back().timestamp;
+    }
+
+    /// @returns true if all recorded reads were applied.
+    [[nodiscard]]
+    bool Finished() const
+    {
+        const std::lock_guard grd(mutex);
+        return position == trace.size();
+    }
+
+    /// @returns Accesses made by replayed code so far.
+    [[nodiscard]]
+    EcTrafficStatistics Statistics() const
+    {
+        const std::lock_guard grd(mutex);
+        return statistics;
+    }
+
+    /// @returns Accesses which were made by recorded code.
+    [[nodiscard]]
+    EcTrafficStatistics RecordedStatistics() const
+    {
+        return SummarizeEcTrace(trace);
+    }
+
+  private:
+    static constexpr std::size_t kImageSize = std::numeric_limits<std::uint16_t>::max() + 1u;
+
+    const EcTrace trace;
+
+    mutable std::mutex mutex;
+    std::size_t position{0};
+    mutable std::vector<std::uint8_t> image;
+    mutable EcTrafficStatistics statistics;
+
+    void ApplyUpTo(std::chrono::nanoseconds sinceStart)
+    {
+        for (; position < trace.size() && trace[position].timestamp <= sinceStart; ++position)
+        {
+            const auto &record = trace[position];
+            if (record.operation == EcTraceOperation::READ)
+            {
+                const auto count = std::min(record.values.size(), kImageSize - record.address);
+                std::copy_n(record.values.begin(), count,
+                            std::next(image.begin(), record.address));
+            }
+        }
+    }
+
+    static void CheckRange(std::int64_t offset, std::size_t size)
+    {
+        if (offset < 0 || static_cast<std::size_t>(offset) + size > kImageSize)
+        {
+            throw std::out_of_range("Access out of the EC trace's address space.");
+        }
+    }
+};
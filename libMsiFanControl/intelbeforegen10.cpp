@@ -3,11 +3,12 @@
 #include "device.h" // IWYU pragma: keep
 #include "device_commands.h"
 #include "readwrite.h"
+#include "turbo_boost_switch.h"
 
 #include <utility>
 
-CIntelBeforeGen10::CIntelBeforeGen10(CReadWrite readWrite) :
-    CDevice(std::move(readWrite))
+CIntelBeforeGen10::CIntelBeforeGen10(CReadWrite readWrite, TurboBoostSwitchPtr turboBoost) :
+    CDevice(std::move(readWrite), std::move(turboBoost))
 {
 }
 CIntelBeforeGen10::~CIntelBeforeGen10() = default;
@@ -3,11 +3,12 @@
 #include "cm_ctors.h"
 #include "device.h"
 #include "readwrite.h"
+#include "turbo_boost_switch.h"
 
 class CIntelBeforeGen10 : public CDevice
 {
   public:
-    explicit CIntelBeforeGen10(CReadWrite readWrite);
+    explicit CIntelBeforeGen10(CReadWrite readWrite, TurboBoostSwitchPtr turboBoost = nullptr);
     NO_COPYMOVE(CIntelBeforeGen10);
     ~CIntelBeforeGen10() override;
 
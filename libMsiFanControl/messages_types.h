@@ -6,6 +6,7 @@
 
 #include <cereal/cereal.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <cstddef>
@@ -17,9 +18,9 @@
 #include <utility>
 #include <variant>
 
-/// File contains "messages" which are passed between GUI/daemon, serialized by cereal to the shared
-/// memory. It is usable by both daemon & GUI, so all related code must stay here in the single
-/// header file.
+/// File contains "messages" which are passed between GUI/daemon, those are converted to fixed
+/// layout of wire_messages.h for the shared memory (cereal is kept for debug dumps). It is usable
+/// by both daemon & GUI, so all related code must stay here in the single header file.
 
 /// @brief Current state of fan's boost, value is passed/read to/from system fs.
 enum class BoosterState : std::uint8_t {
@@ -42,10 +43,21 @@ enum class CpuTurboBoostState : std::uint8_t {
     NO_CHANGE
 };
 
+/// @brief State of the daemon's "game mode" policy engine, which switches boosters itself.
+enum class PolicyState : std::uint8_t {
+    ON,
+    OFF,
+    NO_CHANGE
+};
+
 /// @brief At least delay between 2 sequental communications sessions of the daemon / GUI (it is
 /// poll-time of the daemon).
 constexpr inline auto kMinimumServiceDelay = std::chrono::milliseconds(500);
 
+/// @brief Daemon sleeps until GUI pushes request, but not longer than this. Once it passed daemon
+/// does periodic housekeeping even if nobody talks to it.
+constexpr inline auto kDaemonHousekeepingPeriod = std::chrono::seconds(5);
+
 ///@brief Contains temperature and RPM of the CPU or GPU.
 struct Info
 {
@@ -53,6 +65,16 @@ struct Info
     std::uint16_t temperature{0};
     // NOLINTNEXTLINE
     std::uint16_t fanRPM{0};
+    /// @brief Millidegrees Celsius if sensor has better resolution than whole degree (coretemp),
+    /// otherwise 0. It is known to the daemon only, wire format keeps whole degrees.
+    // NOLINTNEXTLINE
+    std::int32_t temperatureMilli{0};
+    /// @brief std::chrono::steady_clock (CLOCK_MONOTONIC) in nanoseconds when sensors were read, it
+    /// is the same in all processes. 0 if unknown.
+    // NOLINTNEXTLINE
+    std::int64_t sampledAtNs{0};
+
+    using SampleClock = std::chrono::steady_clock;
 
     Info() = default;
     // NOLINTNEXTLINE
@@ -93,14 +115,58 @@ struct Info
         return std::visit(visitor, rpm);
     }
 
+    /// @returns Temperature with the best resolution known.
+    [[nodiscard]]
+    float PreciseTemperature() const
+    {
+        return temperatureMilli != 0 ? static_cast<float>(temperatureMilli) / 1000.f
+                                     : static_cast<float>(temperature);
+    }
+
+    /// @brief Sets both temperatures out of @p milliCelsius.
+    void SetTemperatureMilli(std::int32_t milliCelsius)
+    {
+        temperatureMilli = milliCelsius;
+        temperature = static_cast<std::uint16_t>(std::max(0, (milliCelsius + 500) / 1000));
+    }
+
+    /// @returns Time when sensors were read or std::nullopt if it is unknown. Other @p taClock
+    /// (i.e. CManualClock) gets the same time since its epoch.
+    template <typename taClock = SampleClock>
+    [[nodiscard]]
+    std::optional<typename taClock::time_point> SampledAt() const
+    {
+        if (sampledAtNs == 0)
+        {
+            return std::nullopt;
+        }
+        return typename taClock::time_point(
+          std::chrono::duration_cast<typename taClock::duration>(std::chrono::nanoseconds(sampledAtNs)));
+    }
+
+    template <typename taClock = SampleClock>
+    void SetSampledAt(typename taClock::time_point when)
+    {
+        sampledAtNs =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(when.time_since_epoch()).count();
+    }
+
     // support for Cereal
     template <class Archive>
-    void serialize(Archive &ar, const std::uint32_t /*version*/)
+    void serialize(Archive &ar, const std::uint32_t version)
     {
         ar(temperature, fanRPM);
+        if (version > 1)
+        {
+            ar(temperatureMilli);
+        }
+        if (version > 2)
+        {
+            ar(sampledAtNs);
+        }
     }
 };
-CEREAL_CLASS_VERSION(Info, 1)
+CEREAL_CLASS_VERSION(Info, 3)
 
 /// @brief Contains both CPU and GPU struct Info.
 struct CpuGpuInfo
@@ -332,6 +398,7 @@ struct Battery
 
   private:
     friend class CDevice;
+    friend class CWireCodec;
 
     static constexpr std::uint8_t kRequiredOffset = 0x80;
     static constexpr std::uint8_t kFullBattery = 100 /* (percents) */;
@@ -407,38 +474,41 @@ struct FullInfoBlock
     BehaveWithCurve behaveAndCurve;
     std::string daemonDeviceException;
     Battery battery;
+    /// @brief ON if daemon's policy engine drives the boosters.
+    PolicyState gameMode{PolicyState::OFF};
 
     // support for Cereal
     template <class Archive>
     void save(Archive &ar, const std::uint32_t version) const
     {
-        if (version < 4)
+        if (version < 5)
         {
             throw std::runtime_error("Recompile. It is not compatible binary with older code.");
         }
 
-        ar(signature, tag, info, boostersStates, behaveAndCurve, daemonDeviceException, battery);
+        ar(signature, tag, info, boostersStates, behaveAndCurve, daemonDeviceException, battery,
+           gameMode);
         return;
     }
 
     template <class Archive>
     void load(Archive &ar, const std::uint32_t version)
     {
-        if (version < 4)
+        if (version < 5)
         {
             throw std::runtime_error("Recompile. It is not compatible binary with older code.");
         }
 
         std::size_t signatureRead = 0u;
         ar(signatureRead, tag, info, boostersStates, behaveAndCurve, daemonDeviceException,
-           battery);
+           battery, gameMode);
         if (signatureRead != signature)
         {
             throw std::runtime_error("Wrong signature detected on reading FullInfoBlock.");
         }
     }
 };
-CEREAL_CLASS_VERSION(FullInfoBlock, 4)
+CEREAL_CLASS_VERSION(FullInfoBlock, 5)
 
 /// @brief Request sent by GUI to daemon. It can be ping, action to execute, etc.
 struct RequestFromUi
@@ -458,16 +528,18 @@ struct RequestFromUi
     BoostersStates boostersStates{};
     BehaveWithCurve behaveAndCurve{};
     Battery battery{Battery::TCannotDetectBatteryControlSlot{}};
+    /// @brief Enables / disables daemon's policy engine.
+    PolicyState gameMode{PolicyState::NO_CHANGE};
 
     // support for Cereal
     template <class Archive>
     void serialize(Archive &ar, const std::uint32_t version)
     {
-        if (version < 4)
+        if (version < 5)
         {
             throw std::runtime_error("Recompile. It is not compatible binary with older code.");
         }
-        ar(boostersStates, behaveAndCurve, request, battery);
+        ar(boostersStates, behaveAndCurve, request, battery, gameMode);
     }
 
     /// @returns true if this request from GUI to daemon contains some action requested by user (or
@@ -484,7 +556,8 @@ struct RequestFromUi
               return false;
           },
         };
-        return boostersStates.HasAnyChange() || std::visit(visitor, battery.maxLevel);
+        return boostersStates.HasAnyChange() || gameMode != PolicyState::NO_CHANGE
+               || std::visit(visitor, battery.maxLevel);
     }
 };
-CEREAL_CLASS_VERSION(RequestFromUi, 4)
+CEREAL_CLASS_VERSION(RequestFromUi, 5)
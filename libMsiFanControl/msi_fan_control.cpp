@@ -3,7 +3,9 @@
 #include "csysfsprovider.h" // IWYU pragma: keep
 #include "intelbeforegen10.h"
 #include "intelgen10.h"
+#include "readwrite.h"
 #include "readwrite_provider.h"
+#include "turbo_boost_switch.h"
 
 #include <libcpuid/libcpuid.h>
 
@@ -13,7 +15,8 @@
 #include <string>
 #include <utility>
 
-DevicePtr CreateDeviceController(BackupProviderPtr backupProvider, bool dryRun)
+DevicePtr CreateDeviceController(BackupProviderPtr backupProvider, bool dryRun,
+                                 const ReadWriteProviderDecorator &decorator)
 {
     if (!cpuid_present())
     {
@@ -51,7 +54,7 @@ DevicePtr CreateDeviceController(BackupProviderPtr backupProvider, bool dryRun)
         if (gen > 9)
         {
             return std::make_shared<CIntelGen10>(
-              CSysFsProvider::CreateIoObject(std::move(backupProvider), dryRun));
+              CSysFsProvider::CreateIoObject(std::move(backupProvider), dryRun, decorator));
         }
     }
     else
@@ -60,5 +63,12 @@ DevicePtr CreateDeviceController(BackupProviderPtr backupProvider, bool dryRun)
     }
 
     return std::make_shared<CIntelBeforeGen10>(
-      CSysFsProvider::CreateIoObject(std::move(backupProvider), dryRun));
+      CSysFsProvider::CreateIoObject(std::move(backupProvider), dryRun, decorator));
+}
+
+DevicePtr CreateSimulatedDeviceController(ReadWriteProviderPtr simulatedEc)
+{
+    // Host's turbo-boost must not be switched by the simulation.
+    return std::make_shared<CIntelGen10>(CReadWrite(std::move(simulatedEc), nullptr),
+                                         std::make_shared<CMemoryTurboBoost>());
 }
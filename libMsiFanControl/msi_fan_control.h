@@ -11,5 +11,12 @@ using DevicePtr = std::shared_ptr<CDevice>;
 //! @throws if cpu is not recognized, wrong vendor, missing access to debugfs (no root) etc.
 //! @param dryRun if true, then temporary file will be created with 256 bytes size and filled by
 //!        zeroes to operate on it instead access to debugfs.
+//! @param decorator optional wrapper of the EC access, for example CRecordingProvider.
 //!
-DevicePtr CreateDeviceController(BackupProviderPtr backupProvider, bool dryRun = false);
+DevicePtr CreateDeviceController(BackupProviderPtr backupProvider, bool dryRun = false,
+                                 const ReadWriteProviderDecorator &decorator = {});
+
+//! @brief Creates controller which works over simulated EC (see CSimulatedEcProvider). CPU is not
+//! checked and hardware is not touched (turbo-boost is in-memory flag as well), so it can run on
+//! any Linux box for benchmarks and tests.
+DevicePtr CreateSimulatedDeviceController(ReadWriteProviderPtr simulatedEc);
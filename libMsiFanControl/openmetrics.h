@@ -0,0 +1,176 @@
+#pragma once
+
+#include "acpi_interrupts.h"
+#include "ec_trace.h"
+#include "lambda_visitors.h"
+#include "messages_types.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <variant>
+
+/// @brief Timing of the daemon's control loop, only cycles which did any work are accounted.
+struct DaemonLoopStatistics
+{
+    std::uint64_t cycles{0};
+    std::chrono::nanoseconds lastCycle{0};
+    std::chrono::nanoseconds totalCycles{0};
+
+    void Account(std::chrono::nanoseconds cycle)
+    {
+        ++cycles;
+        lastCycle = cycle;
+        totalCycles += cycle;
+    }
+};
+
+namespace openmetrics_details {
+/// @brief Appends printf-like formatted text to @p out. Once @p out has grown, it does not
+/// allocate anymore.
+// NOLINTNEXTLINE
+inline void Append(std::string &out, const char *format, ...)
+{
+    std::array<char, 512> line{};
+    va_list args;
+    va_start(args, format);
+    const auto len = std::vsnprintf(line.data(), line.size(), format, args);
+    va_end(args);
+    if (len > 0)
+    {
+        out.append(line.data(), std::min<std::size_t>(len, line.size() - 1));
+    }
+}
+
+inline const char *BatteryText(const Battery &battery)
+{
+    const sfw::LambdaVisitor visitor{
+      [](const Battery::BatteryLevels &level) {
+          switch (level)
+          {
+              case Battery::BatteryLevels::BestForBattery:
+                  return "battery";
+              case Battery::BatteryLevels::Balanced:
+                  return "balanced";
+              case Battery::BatteryLevels::BestForMobility:
+                  return "mobility";
+          }
+          return "unknown";
+      },
+      [](const Battery::TCannotDetectBatteryControlSlot &) { return "undetected"; },
+      [](const Battery::TInvalidRange &) { return "invalid"; },
+      [](const Battery::TLevelWasNotExact &) { return "custom"; },
+    };
+    return std::visit(visitor, battery.maxLevel);
+}
+
+/// @returns 1 for ON, 0 for OFF and -1 if state is unknown.
+template <typename taState>
+int StateValue(taState state)
+{
+    if (state == taState::ON)
+    {
+        return 1;
+    }
+    return state == taState::OFF ? 0 : -1;
+}
+} // namespace openmetrics_details
+
+/// @brief Formats daemon's state in OpenMetrics text format into @p out (it is cleared 1st).
+/// It is called by daemon after each publication, so scraping never causes EC reads.
+/// @param acpi ACPI interrupts accounting, it is skipped if nullptr (system does not expose it).
+inline void FormatOpenMetrics(const FullInfoBlock &info, const EcTrafficStatistics &ec,
+                              const DaemonLoopStatistics &loop, const AcpiInterruptStatistics *acpi,
+                              std::string &out)
+{
+    using namespace openmetrics_details;
+    using Seconds = std::chrono::duration<double>;
+    out.clear();
+
+    Append(out, "# TYPE msifan_temperature_celsius gauge\n"
+                "# UNIT msifan_temperature_celsius celsius\n"
+                "msifan_temperature_celsius{sensor=\"cpu\"} %u\n"
+                "msifan_temperature_celsius{sensor=\"gpu\"} %u\n",
+           unsigned{info.info.cpu.temperature}, unsigned{info.info.gpu.temperature});
+    Append(out, "# TYPE msifan_fan_rpm gauge\n"
+                "msifan_fan_rpm{fan=\"cpu\"} %u\n"
+                "msifan_fan_rpm{fan=\"gpu\"} %u\n",
+           unsigned{info.info.cpu.fanRPM}, unsigned{info.info.gpu.fanRPM});
+
+    Append(out, "# HELP msifan_cooler_boost 1 if on, 0 if off, -1 if unknown.\n"
+                "# TYPE msifan_cooler_boost gauge\n"
+                "msifan_cooler_boost %d\n",
+           StateValue(info.boostersStates.fanBoosterState));
+    Append(out, "# HELP msifan_cpu_turbo_boost 1 if on, 0 if off, -1 if unknown.\n"
+                "# TYPE msifan_cpu_turbo_boost gauge\n"
+                "msifan_cpu_turbo_boost %d\n",
+           StateValue(info.boostersStates.cpuTurboBoostState));
+    Append(out, "# TYPE msifan_game_mode gauge\n"
+                "msifan_game_mode %d\n",
+           StateValue(info.gameMode));
+    Append(out, "# TYPE msifan_battery_mode info\n"
+                "msifan_battery_mode_info{mode=\"%s\"} 1\n",
+           BatteryText(info.battery));
+
+    Append(out, "# TYPE msifan_ec_calls counter\n"
+                "msifan_ec_calls_total{operation=\"read\"} %zu\n"
+                "msifan_ec_calls_total{operation=\"write\"} %zu\n",
+           ec.readCalls, ec.writeCalls);
+    Append(out, "# HELP msifan_ec_transactions Each byte is separated ACPI transaction.\n"
+                "# TYPE msifan_ec_transactions counter\n"
+                "msifan_ec_transactions_total{operation=\"read\"} %zu\n"
+                "msifan_ec_transactions_total{operation=\"write\"} %zu\n",
+           ec.bytesRead, ec.bytesWritten);
+
+    if (acpi)
+    {
+        Append(out, "# HELP msifan_acpi_interrupts All ACPI interrupts since daemon started.\n"
+                    "# TYPE msifan_acpi_interrupts counter\n"
+                    "msifan_acpi_interrupts_total %llu\n"
+                    "# TYPE msifan_acpi_interrupts_per_second gauge\n"
+                    "msifan_acpi_interrupts_per_second %.3f\n",
+               static_cast<unsigned long long>(acpi->total), acpi->perSecond);
+        Append(out, "# HELP msifan_acpi_session_interrupts ACPI interrupts while EC sessions run.\n"
+                    "# TYPE msifan_acpi_session_interrupts counter\n");
+        for (std::size_t i = 0; i < acpi->byCause.size(); ++i)
+        {
+            Append(out, "msifan_acpi_session_interrupts_total{cause=\"%s\"} %llu\n",
+                   InterruptCauseName(static_cast<InterruptCause>(i)),
+                   static_cast<unsigned long long>(acpi->byCause.at(i)));
+        }
+        Append(out, "# HELP msifan_acpi_read_interrupts Read plans' interrupts split by bytes read.\n"
+                    "# TYPE msifan_acpi_read_interrupts counter\n");
+        for (std::size_t i = 0; i < acpi->byRegisterClass.size(); ++i)
+        {
+            Append(out, "msifan_acpi_read_interrupts_total{register_class=\"%s\"} %llu\n",
+                   RegisterClassName(i),
+                   static_cast<unsigned long long>(acpi->byRegisterClass.at(i)));
+        }
+        Append(out, "# TYPE msifan_read_plans counter\n"
+                    "msifan_read_plans_total %llu\n"
+                    "# TYPE msifan_acpi_last_read_plan_interrupts gauge\n"
+                    "msifan_acpi_last_read_plan_interrupts %llu\n",
+               static_cast<unsigned long long>(acpi->readPlans),
+               static_cast<unsigned long long>(acpi->lastReadPlan));
+    }
+
+    Append(out, "# TYPE msifan_loop_cycle_seconds summary\n"
+                "# UNIT msifan_loop_cycle_seconds seconds\n"
+                "msifan_loop_cycle_seconds_count %llu\n"
+                "msifan_loop_cycle_seconds_sum %.9f\n",
+           static_cast<unsigned long long>(loop.cycles),
+           Seconds(loop.totalCycles).count());
+    Append(out, "# TYPE msifan_loop_last_cycle_seconds gauge\n"
+                "# UNIT msifan_loop_last_cycle_seconds seconds\n"
+                "msifan_loop_last_cycle_seconds %.9f\n",
+           Seconds(loop.lastCycle).count());
+    Append(out, "# TYPE msifan_publication gauge\n"
+                "msifan_publication %zu\n"
+                "# EOF\n",
+           info.tag);
+}
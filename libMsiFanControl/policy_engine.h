@@ -0,0 +1,73 @@
+#pragma once
+
+#include "booster_onoff_decider.h"
+#include "messages_types.h"
+#include "policy_parameters.h"
+
+#include <optional>
+
+/// @brief Daemon side "game mode". It runs BoostersOnOffDecider right after each fresh EC read, so
+/// reaction does not depend on GUI and keeps working when GUI is closed.
+class CPolicyEngine
+{
+  public:
+    explicit CPolicyEngine(const PolicyParameters &params = {}) :
+        params(params)
+    {
+    }
+
+    [[nodiscard]]
+    bool IsEnabled() const
+    {
+        return decider.has_value();
+    }
+
+    [[nodiscard]]
+    PolicyState State() const
+    {
+        return IsEnabled() ? PolicyState::ON : PolicyState::OFF;
+    }
+
+    /// @brief Starts the policy, @p current turbo-boost state is restored by Disable().
+    void Enable(const BoostersStates &current)
+    {
+        if (!IsEnabled())
+        {
+            decider.emplace(params);
+            originalTurboBoostState = current.cpuTurboBoostState;
+        }
+    }
+
+    /// @brief Stops the policy.
+    /// @returns States which must be written to restore CPU turbo-boost as it was before Enable().
+    BoostersStates Disable()
+    {
+        BoostersStates res;
+        if (IsEnabled())
+        {
+            res.cpuTurboBoostState = originalTurboBoostState;
+            decider.reset();
+        }
+        return res;
+    }
+
+    /// @brief Must be called with each fresh EC read while enabled.
+    /// @returns States which must be written to the EC.
+    [[nodiscard]]
+    BoostersStates Decide(const FullInfoBlock &freshInfo)
+    {
+        if (!IsEnabled())
+        {
+            return {};
+        }
+        return decider->ComputeUpdatedBoosterStates(freshInfo);
+    }
+
+    /// @brief Amount of the samples averaged by decider, offline tools use the same.
+    static constexpr std::size_t kAvrSamplesCount = 3;
+
+  private:
+    PolicyParameters params;
+    std::optional<BoostersOnOffDecider<kAvrSamplesCount>> decider;
+    CpuTurboBoostState originalTurboBoostState{CpuTurboBoostState::NO_CHANGE};
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+/// @brief Tunable thresholds of the "game mode" (BoostersOnOffDecider, CpuTurboBoostController).
+/// Defaults are hand tuned values, per model values are found by msifantune.
+struct PolicyParameters
+{
+    /// @brief Turbo-boost is considered to be disabled above it (°C).
+    float turboHotDegree{83.f};
+    /// @brief Turbo-boost is considered to be enabled below it (°C).
+    float turboColdDegree{72.f};
+    /// @brief Turbo-boost is disabled only if temperature rises faster (°C per second).
+    float tooFastHeatingRate{0.5f};
+    /// @brief Smoothing of the temperature's 1st derivative [0..1].
+    float alphaTemperature{0.3f};
+    /// @brief Smoothing of the temperature's 2nd derivative [0..1].
+    float alphaDerivative{0.5f};
+    /// @brief Cooler boost is on above it while GPU is active (°C).
+    float cpuLimitWithGpu{85.f};
+    /// @brief Cooler boost is on above it (°C).
+    float gpuLimit{75.f};
+    /// @brief Cooler boost is on above it while GPU is idle (°C).
+    float cpuOnlyLimit{91.f};
+
+    struct Field
+    {
+        const char *name;
+        float PolicyParameters::*member;
+        float min;
+        float max;
+    };
+
+    /// @returns All fields with their valid ranges, file format and tuner use it.
+    static const std::array<Field, 8> &Fields()
+    {
+        static const std::array<Field, 8> kFields = {{
+          {"turbo_hot_degree", &PolicyParameters::turboHotDegree, 60.f, 100.f},
+          {"turbo_cold_degree", &PolicyParameters::turboColdDegree, 40.f, 95.f},
+          {"too_fast_heating_rate", &PolicyParameters::tooFastHeatingRate, 0.f, 5.f},
+          {"alpha_temperature", &PolicyParameters::alphaTemperature, 0.05f, 1.f},
+          {"alpha_derivative", &PolicyParameters::alphaDerivative, 0.05f, 1.f},
+          {"cpu_limit_with_gpu", &PolicyParameters::cpuLimitWithGpu, 60.f, 100.f},
+          {"gpu_limit", &PolicyParameters::gpuLimit, 50.f, 95.f},
+          {"cpu_only_limit", &PolicyParameters::cpuOnlyLimit, 60.f, 100.f},
+        }};
+        return kFields;
+    }
+
+    /// @returns true if all fields are in range and turbo's cold is below hot.
+    [[nodiscard]]
+    bool IsValid() const
+    {
+        for (const auto &field : Fields())
+        {
+            const float value = this->*field.member;
+            if (!(value >= field.min && value <= field.max))
+            {
+                return false;
+            }
+        }
+        return turboColdDegree < turboHotDegree;
+    }
+
+    /// @brief Writes "name = value" lines, which Load() reads.
+    void Save(std::ostream &out) const
+    {
+        for (const auto &field : Fields())
+        {
+            out << field.name << " = " << this->*field.member << '\n';
+        }
+    }
+
+    /// @brief Reads "name = value" lines, '#' starts comment. Missing fields keep defaults.
+    /// @throws std::invalid_argument if file has unknown names, malformed or invalid values.
+    static PolicyParameters Load(std::istream &input)
+    {
+        PolicyParameters res;
+        std::string line;
+        for (std::size_t lineNumber = 1; std::getline(input, line); ++lineNumber)
+        {
+            line = line.substr(0, line.find('#'));
+            const auto eq = line.find('=');
+            std::istringstream nameStream(line.substr(0, eq));
+            std::string name;
+            if (!(nameStream >> name))
+            {
+                continue;
+            }
+            std::optional<float> value;
+            if (eq != std::string::npos)
+            {
+                std::istringstream valueStream(line.substr(eq + 1));
+                float parsed{0.f};
+                std::string tail;
+                if ((valueStream >> parsed) && !(valueStream >> tail))
+                {
+                    value = parsed;
+                }
+            }
+            const auto &fields = Fields();
+            const auto *field = std::find_if(fields.begin(), fields.end(), [&name](const auto &f) {
+                return name == f.name;
+            });
+            if (field == fields.end() || !value)
+            {
+                throw std::invalid_argument("Policy parameters, line " + std::to_string(lineNumber)
+                                            + " is malformed: " + line);
+            }
+            res.*(field->member) = *value;
+        }
+        if (!res.IsValid())
+        {
+            throw std::invalid_argument("Policy parameters are out of the valid ranges.");
+        }
+        return res;
+    }
+};
@@ -0,0 +1,454 @@
+#pragma once
+
+#include "booster_onoff_decider.h"
+#include "manual_clock.hpp"
+#include "messages_types.h"
+#include "policy_parameters.h"
+#include "telemetry_history.h"
+#include "thermal_plant.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <istream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/// File defines offline replay of the "game mode" decider: recorded or synthetic telemetry is fed
+/// to BoostersOnOffDecider as fast as possible, so thresholds can be evaluated without playing.
+
+using TelemetryTrace = std::vector<TelemetrySample>;
+
+/// @brief Temperature above which replay accounts time.
+struct ReplayThreshold
+{
+    enum class Sensor : std::uint8_t {
+        CPU,
+        GPU
+    };
+    Sensor sensor;
+    float degrees;
+};
+
+/// @brief Thresholds used by BoostersOnOffDecider and CpuTurboBoostController.
+inline std::vector<ReplayThreshold> DefaultReplayThresholds(const PolicyParameters &params = {})
+{
+    using Sensor = ReplayThreshold::Sensor;
+    return {{Sensor::CPU, params.turboColdDegree},
+            {Sensor::CPU, params.turboHotDegree},
+            {Sensor::CPU, params.cpuLimitWithGpu},
+            {Sensor::CPU, params.cpuOnlyLimit},
+            {Sensor::GPU, params.gpuLimit}};
+}
+
+/// @brief How fast decider answers temperature crossing ReplayThreshold upward. Answer is the
+/// first order which turns booster ON or turbo OFF while temperature is still above threshold.
+/// Delays are in the trace's time, so they show how many samples the policy needs to react.
+struct ReplayReaction
+{
+    ReplayThreshold threshold;
+    /// @brief How many times temperature went above threshold.
+    std::uint64_t crossings{0};
+    /// @brief Crossings which got the answer, others dropped back or the trace ended first.
+    std::uint64_t answered{0};
+    std::chrono::duration<double> totalDelay{0};
+    std::chrono::duration<double> maxDelay{0};
+
+    [[nodiscard]]
+    std::chrono::duration<double> MeanDelay() const
+    {
+        return answered ? totalDelay / static_cast<double>(answered)
+                        : std::chrono::duration<double>{0};
+    }
+};
+
+/// @brief Outcome of the single replay.
+struct ReplayReport
+{
+    std::size_t samples{0};
+    /// @brief Trace time from the first to the last sample.
+    std::chrono::duration<double> traceDuration{0};
+    std::uint64_t boosterToggles{0};
+    std::uint64_t turboToggles{0};
+    std::chrono::duration<double> boosterOnTime{0};
+    std::chrono::duration<double> turboOffTime{0};
+    /// @brief Time above each of ReplayThreshold, in the same order.
+    std::vector<std::pair<ReplayThreshold, std::chrono::duration<double>>> timeAbove;
+    /// @brief Reaction to each of ReplayThreshold, in the same order.
+    std::vector<ReplayReaction> reactions;
+    /// @brief Wall time of the whole replay, it is used for throughput only.
+    std::chrono::duration<double> wallTime{0};
+
+    [[nodiscard]]
+    double SamplesPerSecond() const
+    {
+        return wallTime.count() > 0. ? static_cast<double>(samples) / wallTime.count() : 0.;
+    }
+};
+
+namespace policy_replay_details {
+inline std::optional<bool> ParseOnOff(std::string_view text)
+{
+    if (text == "on")
+    {
+        return true;
+    }
+    if (text == "off")
+    {
+        return false;
+    }
+    return std::nullopt;
+}
+
+inline float SensorTemperature(const TelemetrySample &sample, ReplayThreshold::Sensor sensor)
+{
+    return static_cast<float>(sensor == ReplayThreshold::Sensor::CPU ? sample.cpuTemperature
+                                                                     : sample.gpuTemperature);
+}
+} // namespace policy_replay_details
+
+/// @brief Parses text line of "msifanctl watch":
+/// "steady_ms cpu_temp cpu_rpm gpu_temp gpu_rpm fan_booster turbo", booster and turbo are on/off.
+/// @returns std::nullopt for comments (#), empty and malformed lines.
+inline std::optional<TelemetrySample> ParseTelemetryLine(const std::string &line)
+{
+    long long steadyMs = 0;
+    unsigned values[4]{};
+    char booster[8]{};
+    char turbo[8]{};
+    // NOLINTNEXTLINE
+    if (std::sscanf(line.c_str(), "%lld %u %u %u %u %7s %7s", &steadyMs, &values[0], &values[1],
+                    &values[2], &values[3], booster, turbo)
+        != 7)
+    {
+        return std::nullopt;
+    }
+    const auto boosterOn = policy_replay_details::ParseOnOff(booster);
+    const auto turboOn = policy_replay_details::ParseOnOff(turbo);
+    if (!boosterOn || !turboOn)
+    {
+        return std::nullopt;
+    }
+
+    TelemetrySample res{};
+    res.steadyTimeNs = steadyMs * 1000000;
+    res.cpuTemperature = static_cast<std::uint16_t>(values[0]);
+    res.cpuFanRpm = static_cast<std::uint16_t>(values[1]);
+    res.gpuTemperature = static_cast<std::uint16_t>(values[2]);
+    res.gpuFanRpm = static_cast<std::uint16_t>(values[3]);
+    res.fanBoosterState = *boosterOn ? BoosterState::ON : BoosterState::OFF;
+    res.cpuTurboBoostState = *turboOn ? CpuTurboBoostState::ON : CpuTurboBoostState::OFF;
+    return res;
+}
+
+/// @brief Reads trace written by "msifanctl watch", text or --binary (raw TelemetrySample).
+/// Samples which are not newer than the previous one are dropped.
+inline TelemetryTrace ReadTelemetryTrace(std::istream &input, bool binary)
+{
+    TelemetryTrace res;
+    const auto append = [&res](const TelemetrySample &sample) {
+        if (res.empty() || sample.steadyTimeNs > res.back().steadyTimeNs)
+        {
+            res.push_back(sample);
+        }
+    };
+    if (binary)
+    {
+        TelemetrySample sample{};
+        // NOLINTNEXTLINE
+        while (input.read(reinterpret_cast<char *>(&sample), sizeof(sample)))
+        {
+            append(sample);
+        }
+        return res;
+    }
+    std::string line;
+    while (std::getline(input, line))
+    {
+        if (const auto sample = ParseTelemetryLine(line))
+        {
+            append(*sample);
+        }
+    }
+    return res;
+}
+
+/// @brief CPU & GPU fan curves of CpuGpuFanCurve::MakeDefault() for CThermalPlant.
+struct PlantFanCurves
+{
+    CThermalPlant::Curve cpu{};
+    CThermalPlant::Curve gpu{};
+
+    static PlantFanCurves MakeDefault()
+    {
+        const auto toCurve = [](const AddressedValueAnyList &registers) {
+            CThermalPlant::Curve curve{};
+            for (std::size_t i = 0; i < curve.size() && i < registers.size(); ++i)
+            {
+                if (const auto *value = std::get_if<AddressedValue1B>(&registers.at(i)))
+                {
+                    curve.at(i) = value->value;
+                }
+            }
+            return curve;
+        };
+        const auto curves = CpuGpuFanCurve::MakeDefault();
+        return {toCurve(curves.cpu), toCurve(curves.gpu)};
+    }
+};
+
+/// @returns Reading of the @p plant as EC would give it (whole degrees) at @p time.
+inline TelemetrySample SamplePlant(const CThermalPlant &plant, std::chrono::nanoseconds time,
+                                   BoosterState booster, CpuTurboBoostState turbo)
+{
+    const auto &params = plant.Parameters();
+    const auto degrees = [](float temperature) {
+        return static_cast<std::uint16_t>(std::max(temperature, 0.f));
+    };
+    TelemetrySample sample{};
+    sample.steadyTimeNs = time.count();
+    sample.cpuTemperature = degrees(plant.Cpu().temperature);
+    sample.cpuFanRpm = static_cast<std::uint16_t>(plant.Cpu().Rpm(params.cpu));
+    sample.gpuTemperature = degrees(plant.Gpu().temperature);
+    sample.gpuFanRpm = static_cast<std::uint16_t>(plant.Gpu().Rpm(params.gpu));
+    sample.fanBoosterState = booster;
+    sample.cpuTurboBoostState = turbo;
+    return sample;
+}
+
+/// @returns Trace of the simulated laptop (CThermalPlant) with default fan curves and without
+/// cooler boost, sampled each @p period during @p duration.
+inline TelemetryTrace MakeSyntheticTrace(std::chrono::milliseconds duration,
+                                         std::chrono::milliseconds period,
+                                         const ThermalPlantParameters &params = {},
+                                         const LoadProfile &profile = {})
+{
+    if (period.count() <= 0)
+    {
+        throw std::invalid_argument("Sampling period must be positive.");
+    }
+    const auto curves = PlantFanCurves::MakeDefault();
+    CThermalPlant plant(params, profile);
+    const float dtSeconds = std::chrono::duration<float>(period).count();
+    TelemetryTrace res;
+    res.reserve(static_cast<std::size_t>(duration / period) + 1);
+    // Zero time means "unknown" for Info::sampledAtNs.
+    std::chrono::nanoseconds now = period;
+    for (auto passed = std::chrono::milliseconds{0}; passed <= duration; passed += period)
+    {
+        res.push_back(SamplePlant(plant, now, BoosterState::OFF, CpuTurboBoostState::ON));
+
+        plant.Advance(dtSeconds, curves.cpu, curves.gpu, false);
+        now += period;
+    }
+    return res;
+}
+
+/// @brief Runs BoostersOnOffDecider over samples given one by one, applies its orders as daemon's
+/// "game mode" would do and accounts them to ReplayReport.
+/// @note Decider runs on CManualClock driven by the samples' timestamps, it never sleeps and does
+/// not touch CManualClock's state, so runs may go in parallel.
+template <std::size_t taAvrSamplesCount>
+class CPolicyRun
+{
+  public:
+    /// @param initial States which device has before the 1st sample.
+    CPolicyRun(const BoostersStates &initial, const std::vector<ReplayThreshold> &thresholds,
+               const PolicyParameters &params = {}) :
+        decider(params)
+    {
+        info.boostersStates = initial;
+        for (const auto &threshold : thresholds)
+        {
+            report.timeAbove.emplace_back(threshold, TraceTime{0});
+            report.reactions.push_back({threshold});
+        }
+        crossings.resize(thresholds.size());
+    }
+
+    /// @brief Feeds @p sample, it must be newer than the previous one.
+    /// @returns States after applying the decider's orders.
+    const BoostersStates &Step(const TelemetrySample &sample)
+    {
+        // Previous sample and states are considered valid until this sample.
+        if (previous)
+        {
+            Account(*previous, TraceTime(std::chrono::nanoseconds(sample.steadyTimeNs
+                                                                  - previous->steadyTimeNs)));
+        }
+        previous = sample;
+        ++report.samples;
+
+        info.info.cpu.temperature = sample.cpuTemperature;
+        info.info.cpu.SetTemperatureMilli(static_cast<std::int32_t>(sample.cpuTemperature) * 1000);
+        info.info.cpu.fanRPM = sample.cpuFanRpm;
+        info.info.gpu.temperature = sample.gpuTemperature;
+        info.info.gpu.fanRPM = sample.gpuFanRpm;
+        info.info.cpu.sampledAtNs = sample.steadyTimeNs;
+        info.info.gpu.sampledAtNs = sample.steadyTimeNs;
+
+        const auto orders = decider.ComputeUpdatedBoosterStates(info);
+
+        auto &states = info.boostersStates;
+        bool cooling = false;
+        if (orders.fanBoosterState != BoosterState::NO_CHANGE
+            && orders.fanBoosterState != states.fanBoosterState)
+        {
+            states.fanBoosterState = orders.fanBoosterState;
+            ++report.boosterToggles;
+            cooling = states.fanBoosterState == BoosterState::ON;
+        }
+        if (orders.cpuTurboBoostState != CpuTurboBoostState::NO_CHANGE
+            && orders.cpuTurboBoostState != states.cpuTurboBoostState)
+        {
+            states.cpuTurboBoostState = orders.cpuTurboBoostState;
+            ++report.turboToggles;
+            cooling = cooling || states.cpuTurboBoostState == CpuTurboBoostState::OFF;
+        }
+        AccountReactions(sample, cooling);
+        return states;
+    }
+
+    /// @returns Report of all steps done, wallTime is not set.
+    [[nodiscard]]
+    const ReplayReport &Report() const
+    {
+        return report;
+    }
+
+  private:
+    using TraceTime = std::chrono::duration<double>;
+
+    BoostersOnOffDecider<taAvrSamplesCount, CManualClock> decider;
+    FullInfoBlock info;
+    std::optional<TelemetrySample> previous;
+    ReplayReport report;
+    /// @brief State of the ReplayReaction accounting, per threshold.
+    struct Crossing
+    {
+        bool above{false};
+        /// Trace time of the crossing which still waits for the answer.
+        std::optional<std::int64_t> waitsSinceNs;
+    };
+    std::vector<Crossing> crossings;
+
+    void AccountReactions(const TelemetrySample &sample, bool cooling)
+    {
+        for (std::size_t i = 0; i < report.reactions.size(); ++i)
+        {
+            auto &reaction = report.reactions.at(i);
+            auto &crossing = crossings.at(i);
+            if (policy_replay_details::SensorTemperature(sample, reaction.threshold.sensor)
+                <= reaction.threshold.degrees)
+            {
+                crossing = {};
+                continue;
+            }
+            if (!crossing.above)
+            {
+                crossing = {true, sample.steadyTimeNs};
+                ++reaction.crossings;
+            }
+            if (crossing.waitsSinceNs && cooling)
+            {
+                const TraceTime delay =
+                  std::chrono::nanoseconds(sample.steadyTimeNs - *crossing.waitsSinceNs);
+                ++reaction.answered;
+                reaction.totalDelay += delay;
+                reaction.maxDelay = std::max(reaction.maxDelay, delay);
+                crossing.waitsSinceNs = std::nullopt;
+            }
+        }
+    }
+
+    void Account(const TelemetrySample &sample, TraceTime dt)
+    {
+        const auto &states = info.boostersStates;
+        report.traceDuration += dt;
+        if (states.fanBoosterState == BoosterState::ON)
+        {
+            report.boosterOnTime += dt;
+        }
+        if (states.cpuTurboBoostState == CpuTurboBoostState::OFF)
+        {
+            report.turboOffTime += dt;
+        }
+        for (auto &[threshold, time] : report.timeAbove)
+        {
+            if (policy_replay_details::SensorTemperature(sample, threshold.sensor)
+                > threshold.degrees)
+            {
+                time += dt;
+            }
+        }
+    }
+};
+
+/// @brief Feeds @p trace to BoostersOnOffDecider as daemon's "game mode" would do. Temperatures
+/// come from the trace, booster and turbo states start as the first sample has them and then
+/// follow the decider's orders, so result shows what this build's policy would do.
+template <std::size_t taAvrSamplesCount>
+ReplayReport
+ReplayPolicy(const TelemetryTrace &trace,
+             const std::vector<ReplayThreshold> &thresholds = DefaultReplayThresholds(),
+             const PolicyParameters &params = {})
+{
+    if (trace.empty())
+    {
+        return CPolicyRun<taAvrSamplesCount>({}, thresholds, params).Report();
+    }
+
+    BoostersStates initial;
+    initial.fanBoosterState = trace.front().fanBoosterState;
+    initial.cpuTurboBoostState = trace.front().cpuTurboBoostState;
+    CPolicyRun<taAvrSamplesCount> run(initial, thresholds, params);
+    const auto started = std::chrono::steady_clock::now();
+    for (const auto &sample : trace)
+    {
+        run.Step(sample);
+    }
+    auto report = run.Report();
+    report.wallTime = std::chrono::steady_clock::now() - started;
+    return report;
+}
+
+namespace policy_replay_details {
+template <std::size_t... taCounts>
+ReplayReport ReplayPolicy(std::size_t avrSamplesCount, const TelemetryTrace &trace,
+                          const std::vector<ReplayThreshold> &thresholds,
+                          const PolicyParameters &params,
+                          std::index_sequence<taCounts...> /*counts*/)
+{
+    ReplayReport res;
+    const bool found = ((avrSamplesCount == taCounts + 1
+                           ? (res = ::ReplayPolicy<taCounts + 1>(trace, thresholds, params), true)
+                           : false)
+                        || ...);
+    if (!found)
+    {
+        throw std::invalid_argument("Unsupported amount of the averaged samples.");
+    }
+    return res;
+}
+} // namespace policy_replay_details
+
+/// @brief Maximum of the averaged samples supported by ReplayPolicy(std::size_t, ...).
+inline constexpr std::size_t kMaxReplayAvrSamples = 16;
+
+/// @brief The same as ReplayPolicy<N>() but averaged samples amount is given at runtime.
+/// @throws std::invalid_argument if @p avrSamplesCount is not in [1, kMaxReplayAvrSamples].
+inline ReplayReport ReplayPolicy(std::size_t avrSamplesCount, const TelemetryTrace &trace,
+                                 const std::vector<ReplayThreshold> &thresholds =
+                                   DefaultReplayThresholds(),
+                                 const PolicyParameters &params = {})
+{
+    return policy_replay_details::ReplayPolicy(avrSamplesCount, trace, thresholds, params,
+                                               std::make_index_sequence<kMaxReplayAvrSamples>{});
+}
@@ -0,0 +1,380 @@
+#pragma once
+
+#include "messages_types.h"
+#include "policy_engine.h"
+#include "policy_parameters.h"
+#include "policy_replay.h"
+#include "thermal_plant.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/// File defines automatic tuning of PolicyParameters: each candidate drives simulated laptop
+/// (CThermalPlant) in closed loop, so booster and turbo-boost orders change temperatures, and the
+/// best one by PolicyObjective wins.
+
+/// @brief Part of the CPU power produced while turbo-boost is off.
+inline constexpr float kTurboOffCpuPowerScale = 0.7f;
+
+/// @brief Thermal model of the particular laptop: plant parameters and the load it had.
+struct FittedThermalModel
+{
+    ThermalPlantParameters plant{};
+    LoadProfile profile{};
+
+    [[nodiscard]]
+    std::chrono::milliseconds ProfileDuration() const
+    {
+        std::chrono::milliseconds res{0};
+        for (const auto &segment : profile)
+        {
+            res += segment.duration;
+        }
+        return res;
+    }
+};
+
+/// @brief Fits the model to the recorded @p traces. RC constants of the @p nominal are kept (power
+/// and conductance can not be separated without power readings), while fans' max RPM and the load
+/// are taken out of the traces: power of each @p window is solved from
+///  P = C * dT/dt + (T - T_ambient) * (G_passive + G_fan * rpm / maxRpm).
+/// Windows of all traces are concatenated into the single profile.
+/// @param ambient Room temperature, if unknown it is guessed out of the coldest reading.
+/// @throws std::invalid_argument if there is no trace with 2 samples at least.
+inline FittedThermalModel
+FitThermalModel(const std::vector<TelemetryTrace> &traces,
+                std::chrono::milliseconds window = std::chrono::seconds(10),
+                const ThermalPlantParameters &nominal = {},
+                std::optional<float> ambient = std::nullopt)
+{
+    FittedThermalModel res;
+    res.plant = nominal;
+
+    float coldest = std::numeric_limits<float>::max();
+    float cpuMaxRpm = 0.f;
+    float gpuMaxRpm = 0.f;
+    for (const auto &trace : traces)
+    {
+        for (const auto &sample : trace)
+        {
+            coldest = std::min({coldest, static_cast<float>(sample.cpuTemperature),
+                                static_cast<float>(sample.gpuTemperature)});
+            cpuMaxRpm = std::max(cpuMaxRpm, static_cast<float>(sample.cpuFanRpm));
+            gpuMaxRpm = std::max(gpuMaxRpm, static_cast<float>(sample.gpuFanRpm));
+        }
+    }
+    if (coldest == std::numeric_limits<float>::max())
+    {
+        throw std::invalid_argument("There is nothing to fit thermal model to.");
+    }
+    // Idle laptop is few degrees above the room.
+    constexpr float kIdleAboveAmbient = 5.f;
+    res.plant.ambient = ambient ? *ambient : std::clamp(coldest - kIdleAboveAmbient, 10.f, 50.f);
+    res.plant.cpu.maxRpm = std::max(res.plant.cpu.maxRpm, cpuMaxRpm);
+    res.plant.gpu.maxRpm = std::max(res.plant.gpu.maxRpm, gpuMaxRpm);
+
+    const auto power = [&res](const ThermalNodeParameters &node, float temperature, float rate,
+                              float rpm) {
+        const float conductance =
+          node.passiveConductance + node.fanConductance * std::min(rpm / node.maxRpm, 1.f);
+        return node.heatCapacity * rate + (temperature - res.plant.ambient) * conductance;
+    };
+
+    const auto windowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(window).count();
+    for (const auto &trace : traces)
+    {
+        std::size_t begin = 0;
+        while (begin + 1 < trace.size())
+        {
+            float cpuEnergy = 0.f;
+            float gpuEnergy = 0.f;
+            std::size_t end = begin;
+            while (end + 1 < trace.size()
+                   && trace[end].steadyTimeNs - trace[begin].steadyTimeNs < windowNs)
+            {
+                const auto &left = trace[end];
+                const auto &right = trace[end + 1];
+                const float dt =
+                  std::chrono::duration<float>(
+                    std::chrono::nanoseconds(right.steadyTimeNs - left.steadyTimeNs))
+                    .count();
+                // Trapezoid over the interval.
+                const auto rate = [dt](std::uint16_t from, std::uint16_t to) {
+                    return (static_cast<float>(to) - static_cast<float>(from)) / dt;
+                };
+                const auto mid = [](std::uint16_t from, std::uint16_t to) {
+                    return (static_cast<float>(from) + static_cast<float>(to)) / 2.f;
+                };
+                float cpuPower =
+                  power(res.plant.cpu, mid(left.cpuTemperature, right.cpuTemperature),
+                        rate(left.cpuTemperature, right.cpuTemperature),
+                        mid(left.cpuFanRpm, right.cpuFanRpm));
+                if (left.cpuTurboBoostState == CpuTurboBoostState::OFF)
+                {
+                    cpuPower /= kTurboOffCpuPowerScale;
+                }
+                cpuEnergy += std::max(cpuPower, 0.f) * dt;
+                const float gpuPower =
+                  power(res.plant.gpu, mid(left.gpuTemperature, right.gpuTemperature),
+                        rate(left.gpuTemperature, right.gpuTemperature),
+                        mid(left.gpuFanRpm, right.gpuFanRpm));
+                gpuEnergy += std::max(gpuPower, 0.f) * dt;
+                ++end;
+            }
+            const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::nanoseconds(trace[end].steadyTimeNs - trace[begin].steadyTimeNs));
+            if (duration.count() > 0)
+            {
+                const float seconds = std::chrono::duration<float>(duration).count();
+                res.profile.push_back({duration, cpuEnergy / seconds, gpuEnergy / seconds});
+            }
+            begin = end;
+        }
+    }
+    if (res.profile.empty())
+    {
+        throw std::invalid_argument("Traces are too short to fit thermal model.");
+    }
+    return res;
+}
+
+/// @brief Runs "game mode" with @p params over @p model for @p duration in closed loop: booster
+/// makes fans run at full speed, disabled turbo-boost scales CPU power by kTurboOffCpuPowerScale.
+/// Decider sees whole degrees every @p period, as it gets them from EC.
+template <std::size_t taAvrSamplesCount = CPolicyEngine::kAvrSamplesCount>
+ReplayReport SimulatePolicy(const FittedThermalModel &model, const PolicyParameters &params,
+                            std::chrono::milliseconds duration,
+                            std::chrono::milliseconds period = std::chrono::seconds(1),
+                            const std::vector<ReplayThreshold> &thresholds =
+                              DefaultReplayThresholds())
+{
+    if (period.count() <= 0)
+    {
+        throw std::invalid_argument("Sampling period must be positive.");
+    }
+    const auto curves = PlantFanCurves::MakeDefault();
+    CThermalPlant plant(model.plant, model.profile);
+
+    BoostersStates states;
+    states.fanBoosterState = BoosterState::OFF;
+    states.cpuTurboBoostState = CpuTurboBoostState::ON;
+    CPolicyRun<taAvrSamplesCount> run(states, thresholds, params);
+
+    const auto started = std::chrono::steady_clock::now();
+    const float dtSeconds = std::chrono::duration<float>(period).count();
+    // Zero time means "unknown" for Info::sampledAtNs.
+    for (std::chrono::nanoseconds now = period; now <= duration + period; now += period)
+    {
+        states = run.Step(
+          SamplePlant(plant, now, states.fanBoosterState, states.cpuTurboBoostState));
+        plant.SetCpuPowerScale(states.cpuTurboBoostState == CpuTurboBoostState::OFF
+                                 ? kTurboOffCpuPowerScale
+                                 : 1.f);
+        plant.Advance(dtSeconds, curves.cpu, curves.gpu,
+                      states.fanBoosterState == BoosterState::ON);
+    }
+    auto report = run.Report();
+    report.wallTime = std::chrono::steady_clock::now() - started;
+    return report;
+}
+
+/// @brief What tuner minimizes: weighted sum of the shares of time (0..1) and toggles per hour.
+struct PolicyObjective
+{
+    /// @brief Weight of the time turbo-boost was off (CPU was throttled by the policy).
+    double throttled{1.0};
+    /// @brief Weight of the booster's duty cycle (noise).
+    double booster{0.5};
+    /// @brief Weight of the booster and turbo toggles per hour.
+    double togglesPerHour{0.01};
+    /// @brief Weight of the time CPU or GPU was above overheatDegrees.
+    double overheat{10.0};
+    float overheatDegrees{95.f};
+
+    /// @brief Thresholds SimulatePolicy() must account for Score().
+    [[nodiscard]]
+    std::vector<ReplayThreshold> Thresholds() const
+    {
+        return {{ReplayThreshold::Sensor::CPU, overheatDegrees},
+                {ReplayThreshold::Sensor::GPU, overheatDegrees}};
+    }
+
+    /// @returns Score of the @p report made with Thresholds(), less is better.
+    [[nodiscard]]
+    double Score(const ReplayReport &report) const
+    {
+        const double total = report.traceDuration.count();
+        if (total <= 0.)
+        {
+            return 0.;
+        }
+        double overheated = 0.;
+        for (const auto &[threshold, time] : report.timeAbove)
+        {
+            overheated = std::max(overheated, time.count());
+        }
+        const double hours = total / 3600.;
+        return throttled * report.turboOffTime.count() / total
+               + booster * report.boosterOnTime.count() / total
+               + togglesPerHour * static_cast<double>(report.boosterToggles + report.turboToggles)
+                   / hours
+               + overheat * overheated / total;
+    }
+};
+
+struct TunerOptions
+{
+    /// @brief Simulated time per candidate.
+    std::chrono::milliseconds duration{std::chrono::minutes(30)};
+    std::chrono::milliseconds period{std::chrono::seconds(1)};
+    /// @brief Amount of the random candidates, the same amount refines the best of them.
+    std::size_t candidates{2000};
+    /// @brief 0 means all cores.
+    std::size_t threads{0};
+    std::uint32_t seed{1};
+    PolicyObjective objective{};
+};
+
+struct TunedCandidate
+{
+    PolicyParameters params{};
+    double score{std::numeric_limits<double>::max()};
+    ReplayReport report{};
+};
+
+struct TuningResult
+{
+    TunedCandidate best;
+    /// @brief Candidate tuning started from.
+    TunedCandidate start;
+    std::size_t evaluated{0};
+};
+
+namespace policy_tuner_details {
+/// @brief Calls @p body(i) for i in [0, count) on @p threads threads.
+inline void ParallelFor(std::size_t count, std::size_t threads,
+                        const std::function<void(std::size_t)> &body)
+{
+    threads = std::max<std::size_t>(1, std::min(threads, count));
+    std::atomic<std::size_t> next{0};
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (std::size_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&next, count, &body]() {
+            for (auto i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+            {
+                body(i);
+            }
+        });
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+/// @returns Random parameters, uniform within the fields' ranges (@p around is nullptr) or
+/// normal around @p around with sigma @p spread of the range.
+inline PolicyParameters RandomParameters(std::mt19937 &rng, const PolicyParameters *around,
+                                         float spread)
+{
+    for (;;)
+    {
+        PolicyParameters res = around ? *around : PolicyParameters{};
+        for (const auto &field : PolicyParameters::Fields())
+        {
+            float value = 0.f;
+            if (around)
+            {
+                std::normal_distribution<float> dist(res.*field.member,
+                                                     spread * (field.max - field.min));
+                value = dist(rng);
+            }
+            else
+            {
+                std::uniform_real_distribution<float> dist(field.min, field.max);
+                value = dist(rng);
+            }
+            res.*field.member = std::clamp(value, field.min, field.max);
+        }
+        if (res.IsValid())
+        {
+            return res;
+        }
+    }
+}
+} // namespace policy_tuner_details
+
+/// @brief Searches PolicyParameters minimizing @p options.objective over @p model, starting from
+/// @p start. Random search over whole ranges is followed by refinement around the best found, each
+/// round runs candidates in parallel. Result is reproducible for the same seed.
+inline TuningResult TunePolicy(const FittedThermalModel &model, const TunerOptions &options,
+                               const PolicyParameters &start = {})
+{
+    const auto threads =
+      options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    const auto thresholds = options.objective.Thresholds();
+    const auto evaluate = [&](const PolicyParameters &params) {
+        TunedCandidate res;
+        res.params = params;
+        res.report = SimulatePolicy(model, params, options.duration, options.period, thresholds);
+        res.score = options.objective.Score(res.report);
+        return res;
+    };
+    const auto round = [&](std::vector<TunedCandidate> &candidates) {
+        policy_tuner_details::ParallelFor(candidates.size(), threads, [&](std::size_t i) {
+            candidates[i] = evaluate(candidates[i].params);
+        });
+        return *std::min_element(candidates.begin(), candidates.end(),
+                                 [](const auto &a, const auto &b) {
+                                     return a.score < b.score;
+                                 });
+    };
+
+    TuningResult res;
+    res.start = evaluate(start);
+    res.best = res.start;
+    res.evaluated = 1;
+
+    // Candidates are generated up front by single generator, so result does not depend on threads.
+    std::mt19937 rng(options.seed);
+    std::vector<TunedCandidate> candidates(options.candidates);
+    for (auto &candidate : candidates)
+    {
+        candidate.params = policy_tuner_details::RandomParameters(rng, nullptr, 0.f);
+    }
+    if (!candidates.empty())
+    {
+        const auto found = round(candidates);
+        res.evaluated += candidates.size();
+        if (found.score < res.best.score)
+        {
+            res.best = found;
+        }
+
+        constexpr float kRefineSpread = 0.05f;
+        for (auto &candidate : candidates)
+        {
+            candidate.params =
+              policy_tuner_details::RandomParameters(rng, &res.best.params, kRefineSpread);
+        }
+        const auto refined = round(candidates);
+        res.evaluated += candidates.size();
+        if (refined.score < res.best.score)
+        {
+            res.best = refined;
+        }
+    }
+    return res;
+}
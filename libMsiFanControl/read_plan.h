@@ -0,0 +1,190 @@
+#pragma once
+
+#include "cm_ctors.h"
+#include "device_commands.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/// @brief Read plan merges many command lists into single sorted set of the unique byte addresses.
+/// It is executed by CReadWrite::Read(CReadPlan &) in one I/O session, after that each registered
+/// target gets own value decoded out of the bytes read.
+///
+/// Each byte read from EC is ACPI transaction (and IRQ9), so reading each address once per refresh
+/// matters.
+/// @note Plan keeps pointers to the registered targets. Containers passed to Add() must outlive
+/// the plan and must not be resized until the plan is executed.
+class CReadPlan
+{
+  public:
+    CReadPlan() = default;
+    ~CReadPlan() = default;
+    MOVEONLY_ALLOWED(CReadPlan);
+
+    /// @brief Registers all commands of the container as targets to be filled.
+    /// It accepts AddressedValueAnyList, AddressedValueStates<> or anything iterable which contains
+    /// AddressedValueAny or std::pair<key, AddressedValueAny>.
+    template <typename taContainer>
+    CReadPlan &Add(taContainer &toFill)
+    {
+        for (auto &containedValue : toFill)
+        {
+            AddAny(GetCommandFromContained(containedValue));
+        }
+        return *this;
+    }
+
+    /// @brief Registers single command as target to be filled.
+    template <typename taElement>
+    CReadPlan &AddOne(taElement &toFill)
+    {
+        if constexpr (std::is_same_v<taElement, AddressedValueAny>)
+        {
+            AddAny(toFill);
+        }
+        else
+        {
+            AddTarget(&toFill);
+        }
+        return *this;
+    }
+
+    /// @returns Sorted unique byte addresses which must be read to fill all targets.
+    [[nodiscard]]
+    const std::vector<std::int64_t> &Addresses() const
+    {
+        return addresses;
+    }
+
+    /// @returns Amount of the values which will be filled once plan is executed.
+    [[nodiscard]]
+    std::size_t TargetsCount() const
+    {
+        return targets.size();
+    }
+
+    /// @brief Calls @p func(startAddress, bytesCount) for each contiguous run of the addresses.
+    template <typename taCallable>
+    void ForEachRun(const taCallable &func) const
+    {
+        for (auto it = addresses.begin(); it != addresses.end();)
+        {
+            auto runEnd = std::next(it);
+            while (runEnd != addresses.end() && *runEnd == *std::prev(runEnd) + 1)
+            {
+                ++runEnd;
+            }
+            func(*it, static_cast<std::size_t>(std::distance(it, runEnd)));
+            it = runEnd;
+        }
+    }
+
+    /// @brief Must be called by executor once all bytes were read. @p bytes must be ordered as
+    /// Addresses() are. It decodes values into all registered targets.
+    void Distribute(const std::vector<std::uint8_t> &bytes) const
+    {
+        if (bytes.size() != addresses.size())
+        {
+            throw std::logic_error("Read plan got wrong amount of the bytes.");
+        }
+
+        const auto byteAt = [&bytes, this](std::int64_t address) {
+            const auto it = std::lower_bound(addresses.begin(), addresses.end(), address);
+            if (it == addresses.end() || *it != address)
+            {
+                throw std::logic_error("Read plan does not contain requested address.");
+            }
+            return bytes[static_cast<std::size_t>(std::distance(addresses.begin(), it))];
+        };
+
+        for (const auto &target : targets)
+        {
+            std::visit(
+              [&byteAt](auto *element) {
+                  Decode(*element, byteAt);
+              },
+              target);
+        }
+    }
+
+  private:
+    using TargetPtr =
+      std::variant<AddressedValue1B *, AddressedValue2B *, AddressedBits *, TagIgnore *>;
+
+    std::vector<TargetPtr> targets;
+    std::vector<std::int64_t> addresses;
+
+    static AddressedValueAny &GetCommandFromContained(AddressedValueAny &elem)
+    {
+        return elem;
+    }
+
+    template <typename TheState>
+    static AddressedValueAny &GetCommandFromContained(std::pair<TheState, AddressedValueAny> &elem)
+    {
+        return elem.second;
+    }
+
+    void AddAny(AddressedValueAny &value)
+    {
+        std::visit(
+          [this](auto &element) {
+              AddTarget(&element);
+          },
+          value);
+    }
+
+    template <typename taElement>
+    void AddTarget(taElement *element)
+    {
+        if constexpr (!std::is_same_v<taElement, TagIgnore>)
+        {
+            using value_t = decltype(element->value);
+            const auto offset = static_cast<std::int64_t>(element->address);
+            for (std::size_t i = 0; i < sizeof(value_t); ++i)
+            {
+                const auto address = offset + static_cast<std::int64_t>(i);
+                const auto it = std::lower_bound(addresses.begin(), addresses.end(), address);
+                if (it == addresses.end() || *it != address)
+                {
+                    addresses.insert(it, address);
+                }
+            }
+        }
+        targets.emplace_back(element);
+    }
+
+    template <typename taElement, typename taByteGetter>
+    static void Decode(taElement &element, const taByteGetter &byteAt)
+    {
+        if constexpr (!std::is_same_v<taElement, TagIgnore>)
+        {
+            using value_t = decltype(element.value);
+            static_assert(std::is_unsigned_v<value_t>, "Only unsigned values are expected.");
+
+            // Same byte order as CReadWrite uses: python code reads it as big endian.
+            value_t value = 0;
+            const auto offset = static_cast<std::int64_t>(element.address);
+            for (std::size_t i = 0; i < sizeof(value_t); ++i)
+            {
+                value = static_cast<value_t>((value << 8u)
+                                             | byteAt(offset + static_cast<std::int64_t>(i)));
+            }
+            element.value = value;
+
+            if constexpr (std::is_same_v<taElement, AddressedBits>)
+            {
+                element.MaskValue();
+            }
+        }
+    }
+};
+
+TEST_MOVE_NOEX(CReadPlan);
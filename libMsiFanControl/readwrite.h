@@ -2,16 +2,20 @@
 
 #include "cm_ctors.h"
 #include "device_commands.h"
+#include "read_plan.h"
 #include "readwrite_provider.h"
+#include "register_cache.h"
 
 #include <algorithm>
-#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <exception>
-#include <fstream>
 #include <iosfwd>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <optional>
 #include <ostream>
 #include <set>
 #include <type_traits>
@@ -20,7 +24,7 @@
 #include <vector>
 
 /// @brief This is read-write abstraction which accepts AddressedValueAnyList as commands and
-/// operates on "file" provided by ReadWriteProvider.
+/// operates on "file" provided by ReadWriteProvider using positioned byte access (no streams).
 ///
 class CReadWrite
 {
@@ -53,12 +57,15 @@ class CReadWrite
     }
 
     //!@brief starts writting. Writting ends when returned WriteHandle is going out of scope.
+    //! Handle is transaction: writes are buffered and flushed once by Commit() or destructor.
+    //! @note This object must outlive returned handle.
     WriteHandle StartWritting() const
     {
-        return WriteHandle(ioProvider->WriteStream());
+        return WriteHandle(this);
     }
 
-    //! @brief writes multiply commands to the handle.
+    //! @brief writes multiply commands to the handle. Nothing is sent to the device until
+    //! Commit() is called or handle is destroyed.
     //! @param handle - result of StartWritting()
     //! @param toWrite - values to write.
     void Write(WriteHandle &handle, const AddressedValueAnyList &toWrite) const
@@ -68,34 +75,179 @@ class CReadWrite
             std::visit(
               [&handle, this](const auto &element) {
                   using stored_type = std::decay_t<decltype(element)>;
-                  Write<stored_type>(handle.stream, element);
+                  Write<stored_type>(handle, element);
               },
               value);
         }
     }
 
-    //! @brief optimized version which opens file once for many elements to read.
-    //! It uses address field to seek and fills value field of the toFill object.
+    //! @brief Flushes all pending writes of the @p handle to the device. Updates of the
+    //! AddressedBits to the same byte are folded into single read-modify-write, bytes which
+    //! already have requested value are not written at all.
+    //! @throws on I/O failure. Destructor of the handle flushes too, but it cannot report errors.
+    void Commit(WriteHandle &handle) const
+    {
+        auto pending = std::move(handle.pending);
+        handle.pending.clear();
+
+        // Bytes where only some bits are changed must be read to combine with other bits. It is
+        // read once per byte, no matter how many updates were folded into it.
+        std::vector<std::pair<std::int64_t, std::uint8_t>> toWrite;
+        toWrite.reserve(pending.size());
+        for (const auto &[offset, byte] : pending)
+        {
+            std::uint8_t value = byte.value;
+            std::optional<std::uint8_t> current;
+            if (byte.mask != kFullByteMask)
+            {
+                std::uint8_t existing = 0;
+                ioProvider->ReadBytes(offset, &existing, 1);
+                knownBytes[offset] = existing;
+                current = existing;
+                value = static_cast<std::uint8_t>((existing & ~byte.mask) | byte.value);
+            }
+            else if (const auto it = knownBytes.find(offset); it != knownBytes.end())
+            {
+                current = it->second;
+            }
+
+            if (current != value)
+            {
+                toWrite.emplace_back(offset, value);
+            }
+        }
+
+        // Contiguous bytes are written by single call.
+        std::vector<std::uint8_t> run;
+        for (auto it = toWrite.begin(); it != toWrite.end();)
+        {
+            const auto start = it->first;
+            run.clear();
+            do
+            {
+                run.push_back(it->second);
+                ++it;
+            }
+            while (it != toWrite.end() && it->first == start + static_cast<std::int64_t>(run.size()));
+
+            ioProvider->WriteBytes(start, run.data(), run.size());
+            for (std::size_t i = 0; i < run.size(); ++i)
+            {
+                const auto offset = start + static_cast<std::int64_t>(i);
+                knownBytes[offset] = run[i];
+                registerCache.Invalidate(offset);
+            }
+        }
+    }
+
+    //! @brief optimized version which reads each byte once for many elements.
+    //! It uses address field to locate and fills value field of the toFill object.
     template <typename Container>
     void Read(Container &toFill) const
     {
-        auto stream = ioProvider->ReadStream();
-        for (auto &containedValue : toFill)
+        CReadPlan plan;
+        plan.Add(toFill);
+        Read(plan);
+    }
+
+    //! @brief reads all addresses requested by the plan, each byte is read once. Contiguous
+    //! addresses are read by single positioned read. Than fills all targets of the plan.
+    //! Classified registers which are still fresh in the register cache are not read at all.
+    void Read(CReadPlan &plan) const
+    {
+        const auto &addresses = plan.Addresses();
+        if (addresses.empty())
         {
-            std::visit(
-              [&stream](auto &element) {
-                  using stored_type = std::decay_t<decltype(element)>;
-                  Read<stored_type>(stream, element);
-              },
-              GetCommandFromContained(containedValue));
+            return;
+        }
+
+        const auto now = CRegisterCache::Clock::now();
+        std::vector<std::uint8_t> bytes(addresses.size(), 0);
+        std::vector<bool> mustRead(addresses.size(), true);
+        for (std::size_t i = 0; i < addresses.size(); ++i)
+        {
+            if (const auto cached = registerCache.Get(addresses[i], now))
+            {
+                bytes[i] = *cached;
+                mustRead[i] = false;
+            }
+        }
+
+        for (std::size_t i = 0; i < addresses.size();)
+        {
+            if (!mustRead[i])
+            {
+                ++i;
+                continue;
+            }
+            std::size_t count = 1;
+            while (i + count < addresses.size() && mustRead[i + count]
+                   && addresses[i + count] == addresses[i] + static_cast<std::int64_t>(count))
+            {
+                ++count;
+            }
+            ioProvider->ReadBytes(addresses[i],
+                                  std::next(bytes.data(), static_cast<std::ptrdiff_t>(i)), count);
+            for (std::size_t j = i; j < i + count; ++j)
+            {
+                ++bytesReadByClass.at(RegisterClassIndex(registerCache.ClassOf(addresses[j])));
+                registerCache.Store(addresses[j], bytes[j], now);
+                knownBytes[addresses[j]] = bytes[j];
+            }
+            i += count;
+        }
+        plan.Distribute(bytes);
+    }
+
+    /// @brief Sets register class for all bytes used by @p commands, it defines how long value
+    /// read can be re-used out of the register cache. Unclassified registers are read always.
+    template <typename taContainer>
+    void ClassifyRegisters(taContainer commands, RegisterClass registerClass) const
+    {
+        CReadPlan plan;
+        plan.Add(commands);
+        for (const auto address : plan.Addresses())
+        {
+            registerCache.Classify(address, registerClass);
+        }
+    }
+
+    /// @returns When the oldest byte of the @p commands was read from the device. It is older than
+    /// the last Read() if value was served by the register cache. std::nullopt if any byte is not
+    /// cached (it is not classified or it was never read).
+    template <typename taContainer>
+    [[nodiscard]]
+    std::optional<CRegisterCache::Clock::time_point> AcquiredAt(taContainer commands) const
+    {
+        CReadPlan plan;
+        plan.Add(commands);
+        std::optional<CRegisterCache::Clock::time_point> res;
+        for (const auto address : plan.Addresses())
+        {
+            const auto readAt = registerCache.ReadAt(address);
+            if (!readAt)
+            {
+                return std::nullopt;
+            }
+            res = res ? std::min(*res, *readAt) : *readAt;
         }
+        return res;
+    }
+
+    /// @returns Bytes read from the device by Read() so far, per class of the register. Bytes served
+    /// by the register cache are not counted.
+    [[nodiscard]]
+    const RegisterClassCounters &BytesReadByClass() const
+    {
+        return bytesReadByClass;
     }
 
     template <typename taElement>
     void ReadOne(taElement &toFill) const
     {
-        auto stream = ioProvider->ReadStream();
-        Read(stream, toFill);
+        CReadPlan plan;
+        plan.AddOne(toFill);
+        Read(plan);
     }
 
     /// @brief Cancel backup on listed objects, which means changes at those addresses
@@ -122,20 +274,78 @@ class CReadWrite
           value);
     }
 
+    /// @brief Write transaction. It buffers byte writes until CReadWrite::Commit() or destructor.
     class WriteHandle
     {
       public:
-        ~WriteHandle() = default;
         WriteHandle() = delete;
-        MOVEONLY_ALLOWED(WriteHandle);
+        WriteHandle(const WriteHandle &) = delete;
+        WriteHandle &operator=(const WriteHandle &) = delete;
+
+        WriteHandle(WriteHandle &&other) noexcept :
+            owner(std::exchange(other.owner, nullptr)),
+            pending(std::move(other.pending))
+        {
+        }
+
+        WriteHandle &operator=(WriteHandle &&other) noexcept
+        {
+            if (this != &other)
+            {
+                Flush();
+                owner = std::exchange(other.owner, nullptr);
+                pending = std::move(other.pending);
+            }
+            return *this;
+        }
+
+        ~WriteHandle()
+        {
+            Flush();
+        }
 
       private:
         friend class CReadWrite;
-        explicit WriteHandle(std::ofstream &&stream) :
-            stream(std::move(stream))
+
+        /// @brief Byte to be written, only bits set in mask are defined by value.
+        struct PendingByte
+        {
+            std::uint8_t value{0};
+            std::uint8_t mask{0};
+        };
+
+        explicit WriteHandle(const CReadWrite *owner) :
+            owner(owner)
+        {
+        }
+
+        /// @brief Folds new bits into pending byte at @p offset.
+        void Stage(std::int64_t offset, std::uint8_t value, std::uint8_t mask)
         {
+            auto &byte = pending[offset];
+            byte.value = static_cast<std::uint8_t>((byte.value & ~mask) | (value & mask));
+            byte.mask |= mask;
         }
-        std::ofstream stream;
+
+        void Flush() noexcept
+        {
+            if (owner && !pending.empty())
+            {
+                try
+                {
+                    owner->Commit(*this);
+                }
+                catch (std::exception &ex)
+                {
+                    std::cerr << "Exception on flushing writes from ~WriteHandle(): " << ex.what()
+                              << std::endl
+                              << std::flush;
+                }
+            }
+        }
+
+        const CReadWrite *owner;
+        std::map<std::int64_t, PendingByte> pending;
     };
 
   private:
@@ -144,42 +354,17 @@ class CReadWrite
     mutable std::set<std::int64_t> backupOffsets;
     mutable std::set<std::int64_t> ignoreBackupOffsets;
 
-    static AddressedValueAny &GetCommandFromContained(AddressedValueAnyList::value_type &elem)
-    {
-        return elem;
-    }
+    /// @brief Last value seen in device per byte (read or written by us). It is used to skip
+    /// writes which would not change anything.
+    mutable std::map<std::int64_t, std::uint8_t> knownBytes;
 
-    template <typename TheState>
-    static AddressedValueAny &GetCommandFromContained(std::pair<TheState, AddressedValueAny> &elem)
-    {
-        return elem.second;
-    }
+    /// @brief Values of the classified registers with read time.
+    mutable CRegisterCache registerCache;
 
-    template <typename T>
-    static void Read(std::ifstream &readStream, T &element)
-    {
-        if constexpr (std::is_same_v<T, TagIgnore>)
-        {
-            return;
-        }
-        using value_t = decltype(element.value);
-        // using intermedial array to deal with optimization: -fstrict-aliasing
-        static_assert(std::is_scalar_v<value_t>, "Only scalar values are allowed.");
-        std::array<char, sizeof(value_t)> tmp{};
-
-        readStream.seekg(element.address);
-        readStream.read(tmp.data(), tmp.size());
+    /// @brief Statistics for the BytesReadByClass().
+    mutable RegisterClassCounters bytesReadByClass{};
 
-        // Guess i should understand this python code as big endian:
-        //  VALUE = int(file.read(2).hex(),16)
-
-        std::copy(tmp.rbegin(), tmp.rend(), &element.value);
-
-        if constexpr (std::is_same_v<T, AddressedBits>)
-        {
-            element.MaskValue();
-        }
-    }
+    static constexpr std::uint8_t kFullByteMask = 0xFF;
 
     /// Calls callabale passing to each address (offset) used to store element.value.
     template <typename taElementType, typename taCallable>
@@ -194,41 +379,39 @@ class CReadWrite
     }
 
     template <typename taElementType>
-    void Write(std::ofstream &writeStream, const taElementType &element) const
+    void Write(WriteHandle &handle, const taElementType &element) const
     {
-        if constexpr (std::is_same_v<taElementType, TagIgnore>)
+        if constexpr (!std::is_same_v<taElementType, TagIgnore>)
         {
-            return;
-        }
+            // installing backup
+            ForEachByte(element, [this](const auto offset) {
+                if (ignoreBackupOffsets.count(offset) == 0)
+                {
+                    backupOffsets.insert(offset);
+                }
+            });
 
-        // installing backup
-        ForEachByte(element, [this](const auto offset) {
-            if (ignoreBackupOffsets.count(offset) == 0)
+            using value_t = decltype(element.value);
+            static_assert(std::is_scalar_v<value_t>, "Only scalar values are allowed.");
+            const auto offset = static_cast<std::int64_t>(element.address);
+
+            if constexpr (std::is_same_v<taElementType, AddressedBits>)
             {
-                backupOffsets.insert(offset);
+                handle.Stage(offset, element.value, element.validBits);
+            }
+            else
+            {
+                // Guess this is BIG endian too:
+                // file.write(bytes((VALUE,)))
+                auto value = element.value;
+                for (std::size_t i = sizeof(value_t); i > 0; --i)
+                {
+                    handle.Stage(offset + static_cast<std::int64_t>(i - 1),
+                                 static_cast<std::uint8_t>(value & 0xFFu), kFullByteMask);
+                    value = static_cast<value_t>(value >> 8u);
+                }
             }
-        });
-
-        using value_t = decltype(element.value);
-        const std::streampos offset = element.address;
-        auto value = element.value;
-
-        if constexpr (std::is_same_v<taElementType, AddressedBits>)
-        {
-            // using intermedial array to deal with optimization: -fstrict-aliasing
-            AddressedValueAnyList tmp{AddressedValue1B{offset, 0}};
-            Read(tmp);
-            value = element.ValueForWritting(std::get<AddressedValue1B>(tmp.front()).value);
         }
-
-        static_assert(std::is_scalar_v<value_t>, "Only scalar values are allowed.");
-        std::array<char, sizeof(value_t)> tmp{};
-
-        // Guess this is BIG endian too:
-        // file.write(bytes((VALUE,)))
-        std::copy_n(&value, sizeof(value), tmp.rbegin());
-        writeStream.seekp(offset);
-        writeStream.write(tmp.data(), tmp.size());
     }
 };
 
@@ -2,11 +2,15 @@
 
 #include "cm_ctors.h"
 
+#include <cstddef>
 #include <cstdint>
-#include <fstream>
+#include <functional>
 #include <memory>
 #include <set>
+
 //! @brief provides IO access to the system data which should be changed.
+//! Access is positioned (like pread/pwrite), so implementation does not need to keep any "current
+//! position" and may keep file opened for whole lifetime.
 class IReadWriteProvider
 {
   public:
@@ -14,15 +18,21 @@ class IReadWriteProvider
     IReadWriteProvider() = default;
     virtual ~IReadWriteProvider() = default;
 
-    [[nodiscard]]
-    virtual std::ofstream WriteStream() const = 0;
+    //! @brief Reads exactly @p size bytes starting at @p offset into @p buffer.
+    //! @throws std::runtime_error (or derived) if not all bytes could be read.
+    virtual void ReadBytes(std::int64_t offset, std::uint8_t *buffer, std::size_t size) const = 0;
 
-    [[nodiscard]]
-    virtual std::ifstream ReadStream() const = 0;
+    //! @brief Writes exactly @p size bytes of @p buffer starting at @p offset.
+    //! @throws std::runtime_error (or derived) if not all bytes could be written.
+    virtual void WriteBytes(std::int64_t offset, const std::uint8_t *buffer,
+                            std::size_t size) const = 0;
 };
 
 using ReadWriteProviderPtr = std::shared_ptr<IReadWriteProvider>;
 
+//! @brief Wraps provider by another one, like CRecordingProvider. Empty means "use as is".
+using ReadWriteProviderDecorator = std::function<ReadWriteProviderPtr(ReadWriteProviderPtr)>;
+
 //! @brief Caller supplies list of the offsets into WriteStream which were changed.
 //! Provider implementation must restore original system values at those offets.
 class IBackupProvider
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "cm_ctors.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+
+/// @brief How often register's value is changed by the device itself.
+enum class RegisterClass : std::uint8_t {
+    /// Sensors like temperatures and RPMs, those are changed all the time.
+    FAST_SENSOR,
+    /// Settings, like booster or behave state. Can be changed by firmware/hotkeys, but rarely.
+    SLOW_SETTING,
+    /// Never changed by device itself, only by our writes.
+    STATIC,
+};
+
+/// @brief Amount of the RegisterClass values.
+inline constexpr std::size_t kRegisterClassesCount = 3;
+
+/// @brief Counter per RegisterClass, the last one is for unclassified registers.
+using RegisterClassCounters = std::array<std::uint64_t, kRegisterClassesCount + 1>;
+
+/// @returns Index of @p registerClass in RegisterClassCounters.
+inline constexpr std::size_t RegisterClassIndex(std::optional<RegisterClass> registerClass)
+{
+    return registerClass ? static_cast<std::size_t>(*registerClass) : kRegisterClassesCount;
+}
+
+/// @brief Per register class time while cached value is considered valid.
+struct RegisterRefreshIntervals
+{
+    /// Shorter than the fastest schedule of the daemon (CSamplingScheduler::kBurstInterval), so
+    /// only reads of the same cycle share sensor values.
+    std::chrono::milliseconds fastSensor{200};
+    std::chrono::milliseconds slowSetting{10000};
+};
+
+/// @brief Byte-wise cache of the device registers. Each EC byte read costs ACPI transaction and
+/// IRQ9, so values which are still fresh for their class are served from here instead.
+/// Registers which were not classified are never cached.
+/// @note Entry is dropped as soon as we write to that register.
+class CRegisterCache
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    CRegisterCache() = default;
+    explicit CRegisterCache(RegisterRefreshIntervals intervals) :
+        intervals(intervals)
+    {
+    }
+    ~CRegisterCache() = default;
+    DEFAULT_COPYMOVE(CRegisterCache);
+
+    /// @brief Sets class of the register at @p address. It drops cached value.
+    void Classify(std::int64_t address, RegisterClass registerClass)
+    {
+        entries[address] = Entry{registerClass, std::nullopt, {}};
+    }
+
+    /// @returns cached value if register is classified and value is still fresh at @p now.
+    [[nodiscard]]
+    std::optional<std::uint8_t> Get(std::int64_t address, Clock::time_point now) const
+    {
+        const auto it = entries.find(address);
+        if (it == entries.end() || !it->second.value)
+        {
+            return std::nullopt;
+        }
+        const auto &entry = it->second;
+        switch (entry.registerClass)
+        {
+            case RegisterClass::STATIC:
+                return entry.value;
+            case RegisterClass::SLOW_SETTING:
+                return now - entry.readAt < intervals.slowSetting ? entry.value : std::nullopt;
+            case RegisterClass::FAST_SENSOR:
+                return now - entry.readAt < intervals.fastSensor ? entry.value : std::nullopt;
+        }
+        return std::nullopt;
+    }
+
+    /// @returns When cached value of the register at @p address was read from the device, or
+    /// std::nullopt if there is no cached value.
+    [[nodiscard]]
+    std::optional<Clock::time_point> ReadAt(std::int64_t address) const
+    {
+        const auto it = entries.find(address);
+        if (it == entries.end() || !it->second.value)
+        {
+            return std::nullopt;
+        }
+        return it->second.readAt;
+    }
+
+    /// @returns Class of the register at @p address or std::nullopt if it was not classified.
+    [[nodiscard]]
+    std::optional<RegisterClass> ClassOf(std::int64_t address) const
+    {
+        const auto it = entries.find(address);
+        return it == entries.end() ? std::nullopt : std::optional(it->second.registerClass);
+    }
+
+    /// @brief Remembers value read from the device at @p now. Unclassified registers are ignored.
+    void Store(std::int64_t address, std::uint8_t value, Clock::time_point now)
+    {
+        const auto it = entries.find(address);
+        if (it != entries.end())
+        {
+            it->second.value = value;
+            it->second.readAt = now;
+        }
+    }
+
+    /// @brief Drops cached value, so next read will go to the device.
+    void Invalidate(std::int64_t address)
+    {
+        const auto it = entries.find(address);
+        if (it != entries.end())
+        {
+            it->second.value = std::nullopt;
+        }
+    }
+
+  private:
+    struct Entry
+    {
+        RegisterClass registerClass;
+        std::optional<std::uint8_t> value;
+        Clock::time_point readAt;
+    };
+
+    RegisterRefreshIntervals intervals;
+    std::map<std::int64_t, Entry> entries;
+};
@@ -2,13 +2,15 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstddef>
 #include <numeric>
 #include <optional>
 #include <type_traits>
 
 /// @brief Running avr value of the multiply values. It keeps last taCounts values.
-template <typename T, std::size_t taCounts>
+template <typename T, std::size_t taCounts,
+          typename taTimePoint = std::chrono::steady_clock::time_point>
 class RunningAvr
 {
   public:
@@ -34,6 +36,20 @@ class RunningAvr
         ++nextIndex;
     }
 
+    /// @brief Adds value sampled at @p sampledAt. Value which is not newer than previous timed one
+    /// is ignored, so repeated reading does not get more weight.
+    /// @returns true if value was added.
+    bool OfferValue(T newValue, taTimePoint sampledAt) noexcept
+    {
+        if (lastSampledAt && sampledAt <= *lastSampledAt)
+        {
+            return false;
+        }
+        lastSampledAt = sampledAt;
+        OfferValue(newValue);
+        return true;
+    }
+
     /// @returns Avr. value if list has taCounts elements or std::nullopt otherwise.
     std::optional<T> GetCurrent() const noexcept
     {
@@ -47,6 +63,7 @@ class RunningAvr
   private:
     std::array<T, taCounts> lastValues;
     std::size_t nextIndex{0};
+    std::optional<taTimePoint> lastSampledAt;
 
     T Calculate() const noexcept
     {
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+
+/// @brief Decides when daemon reads EC next time.
+///
+/// Each EC read triggers IRQ-9 which leads to more power consumption eventually. However, when CPU
+/// is hot, it means it is loaded, so IRQ-9 will not add too much and we can read more often. So
+/// base interval depends on the temperature. On top of it:
+///  - temperature rising fast (1st and 2nd derivatives) starts short burst of the frequent reads;
+///  - stable temperature of the cool CPU doubles the interval each time, up to the limit. Hot CPU
+///    or enabled policy engine keep the base interval, so step from the hot plateau is seen soon;
+///  - nobody interested (no clients, no policy engine) allows much longer limit.
+/// @note Time is passed explicitly, so it is testable without sleeps.
+class CSamplingScheduler
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+    using Duration = std::chrono::milliseconds;
+
+    /// @brief Interval of the reads while temperature rises fast.
+    static constexpr Duration kBurstInterval{250};
+    /// @brief Amount of the reads in the burst after last fast rise.
+    static constexpr std::size_t kBurstSamples = 8;
+    /// @brief Longest interval while somebody uses the data.
+    static constexpr Duration kMaxActiveInterval{35000};
+    /// @brief Longest interval while nobody uses the data, it only feeds the history.
+    static constexpr Duration kMaxIdleInterval{120000};
+    /// @brief Client is considered connected this long after its last request.
+    static constexpr Duration kClientTimeout{10000};
+    /// @brief Interval can be doubled this many times by stable readings.
+    static constexpr unsigned kMaxBackoffShift = 3;
+    /// @brief Interval is not doubled at this temperature and above.
+    static constexpr float kBackoffBelowDegrees = 65.f;
+
+    static constexpr float kFastRiseDegreesPerSecond = 1.0f;
+    static constexpr float kRiseDegreesPerSecond = 0.3f;
+    static constexpr float kStableDegreesPerSecond = 0.05f;
+
+    /// @brief Must be called for each EC read, scheduled or not.
+    void OnSample(TimePoint now, float cpuTemperature)
+    {
+        if (lastSample)
+        {
+            const std::chrono::duration<float> dt = now - *lastSample;
+            if (dt.count() > 0.f)
+            {
+                UpdateDerivatives((cpuTemperature - lastTemperature) / dt.count(), dt.count());
+            }
+        }
+        lastSample = now;
+        lastTemperature = cpuTemperature;
+
+        const bool fastRise =
+          rate > kFastRiseDegreesPerSecond || (rate > kRiseDegreesPerSecond && acceleration > 0.f);
+        if (fastRise)
+        {
+            burstLeft = kBurstSamples;
+        }
+        else if (burstLeft > 0)
+        {
+            --burstLeft;
+        }
+
+        if (!fastRise && smoothedRate && std::abs(rate) < kStableDegreesPerSecond)
+        {
+            stableStreak = std::min(stableStreak + 1u, kMaxBackoffShift);
+        }
+        else
+        {
+            stableStreak = 0;
+        }
+    }
+
+    /// @brief Must be called when any client sent request.
+    void OnClientRequest(TimePoint now)
+    {
+        lastClientRequest = now;
+    }
+
+    /// @brief Enabled policy engine needs data the same way as connected client does.
+    void SetPolicyEnabled(bool enabled)
+    {
+        policyEnabled = enabled;
+    }
+
+    /// @brief Clients may ask for more frequent reads, @p period is the shortest one they asked,
+    /// it is not shorter than kBurstInterval anyway.
+    void LimitInterval(std::optional<Duration> period)
+    {
+        clientsPeriod = period;
+        if (clientsPeriod)
+        {
+            clientsPeriod = std::max(*clientsPeriod, kBurstInterval);
+        }
+    }
+
+    /// @returns Interval between last and next reads.
+    [[nodiscard]]
+    Duration Interval(TimePoint now) const
+    {
+        if (!lastSample)
+        {
+            return Duration{0};
+        }
+        if (burstLeft > 0)
+        {
+            return kBurstInterval;
+        }
+        auto limit = IsActive(now) ? kMaxActiveInterval : kMaxIdleInterval;
+        if (clientsPeriod)
+        {
+            limit = std::min(limit, *clientsPeriod);
+        }
+        const bool mayBackOff = !policyEnabled && lastTemperature < kBackoffBelowDegrees;
+        const unsigned shift = mayBackOff ? stableStreak : 0u;
+        return std::min(TemperatureInterval(lastTemperature) * (1u << shift), limit);
+    }
+
+    [[nodiscard]]
+    bool IsDue(TimePoint now) const
+    {
+        return !lastSample || now - *lastSample >= Interval(now);
+    }
+
+    /// @returns How long daemon may sleep until next read.
+    [[nodiscard]]
+    Duration TimeToNextSample(TimePoint now) const
+    {
+        if (!lastSample)
+        {
+            return Duration{0};
+        }
+        const auto left = *lastSample + Interval(now) - now;
+        return std::max(std::chrono::duration_cast<Duration>(left), Duration{0});
+    }
+
+    /// @returns true if somebody uses the data: policy engine or client requested recently.
+    [[nodiscard]]
+    bool IsActive(TimePoint now) const
+    {
+        return policyEnabled || (lastClientRequest && now - *lastClientRequest < kClientTimeout);
+    }
+
+  private:
+    /// @brief Smoothing of the derivatives, see TabularDerivative.
+    static constexpr float kAlpha = 0.5f;
+
+    std::optional<TimePoint> lastSample;
+    std::optional<TimePoint> lastClientRequest;
+    std::optional<Duration> clientsPeriod;
+    float lastTemperature{0.f};
+    std::optional<float> smoothedRate;
+    float rate{0.f};
+    float acceleration{0.f};
+    std::size_t burstLeft{0};
+    unsigned stableStreak{0};
+    bool policyEnabled{false};
+
+    void UpdateDerivatives(float newRate, float dtSeconds)
+    {
+        if (!smoothedRate)
+        {
+            smoothedRate = newRate;
+        }
+        else
+        {
+            const float smoothed = kAlpha * newRate + (1.0f - kAlpha) * *smoothedRate;
+            acceleration = (smoothed - *smoothedRate) / dtSeconds;
+            smoothedRate = smoothed;
+        }
+        rate = *smoothedRate;
+    }
+
+    /// @returns Base interval for the temperature, hotter is more often.
+    static Duration TemperatureInterval(float cpuTemperature)
+    {
+        struct TTempInterval
+        {
+            float cpuTemp;
+            Duration interval;
+        };
+        // This must be ordered by the temp.
+        static constexpr TTempInterval kTempIntervals[] = {
+          {0, Duration{1000}}, // it was no reads yet, avoid delays.
+          {39, Duration{35000}}, // no user around ?
+          {42, Duration{23000}},
+          {45, Duration{17000}},
+          {47, Duration{15000}},
+          {50, Duration{13000}},
+          {60, Duration{10000}},
+          {65, Duration{7000}},
+          {70, Duration{4000}},
+          {75, Duration{3000}},
+          {80, Duration{2000}},
+        };
+
+        const auto it = std::lower_bound(std::begin(kTempIntervals), std::end(kTempIntervals),
+                                         cpuTemperature,
+                                         [](const TTempInterval &record, float current) {
+                                             return record.cpuTemp < current;
+                                         });
+        return it == std::end(kTempIntervals) ? std::prev(it)->interval : it->interval;
+    }
+};
@@ -0,0 +1,170 @@
+#include "simulated_ec_provider.h"
+
+#include "messages_types.h"
+#include "thermal_plant.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <variant>
+
+namespace {
+// Register map, same as CDevice and its descendants use.
+constexpr std::size_t kCpuTemp = 0x68;
+constexpr std::size_t kGpuTemp = 0x80;
+constexpr std::size_t kCpuRpm = 0xCC;
+constexpr std::size_t kCpuRpmDetector = 0xC9;
+constexpr std::size_t kGpuRpm = 0xCA;
+constexpr std::size_t kCpuCurve = 0x72;
+constexpr std::size_t kGpuCurve = 0x8A;
+constexpr std::size_t kBooster = 0x98;
+constexpr std::uint8_t kBoosterBit = 0x80;
+constexpr std::size_t kBehaveGen10 = 0xD4;
+constexpr std::size_t kBehaveBeforeGen10 = 0xF4;
+constexpr std::size_t kBattery = 0xEF;
+
+/// @brief Inverse of the Info::parseRPM().
+std::uint16_t RpmToRegister(float rpm)
+{
+    if (rpm < 1.f)
+    {
+        return 0;
+    }
+    return static_cast<std::uint16_t>(std::lround(478000.0 / rpm));
+}
+
+std::uint8_t TemperatureToRegister(float temperature)
+{
+    return static_cast<std::uint8_t>(std::clamp(std::lround(temperature), 0l, 255l));
+}
+
+CThermalPlant::Curve CurveFromRegisters(const std::array<std::uint8_t, 256> &registers,
+                                        std::size_t start)
+{
+    CThermalPlant::Curve curve{};
+    std::copy_n(std::next(registers.begin(), static_cast<std::ptrdiff_t>(start)), curve.size(),
+                curve.begin());
+    return curve;
+}
+} // namespace
+
+CSimulatedEcProvider::CSimulatedEcProvider(SimulatedEcParameters params) :
+    params(std::move(params)),
+    plant(this->params.plant, this->params.loadProfile),
+    lastAdvance(Clock::now())
+{
+    const auto curves = CpuGpuFanCurve::MakeDefault();
+    const auto fill = [this](const AddressedValueAnyList &curve) {
+        for (const auto &value : curve)
+        {
+            const auto &byte = std::get<AddressedValue1B>(value);
+            registers.at(static_cast<std::size_t>(byte.address)) = byte.value;
+        }
+    };
+    fill(curves.cpu);
+    fill(curves.gpu);
+
+    // AUTO_ADV_VALUES "auto" for both generations.
+    registers[kBehaveGen10] = 13;
+    registers[kBehaveBeforeGen10] = 12;
+    // Balanced battery: 0x80 + 80%.
+    registers[kBattery] = 0x80 + 80;
+    // Devices with CPU fan's RPM at 0xCC keep small value at 0xC8-0xC9, so CDevice detects RPM
+    // address even while fan is stopped.
+    registers[kCpuRpmDetector] = 1;
+
+    UpdateSensorRegisters();
+}
+
+CSimulatedEcProvider::~CSimulatedEcProvider() = default;
+
+void CSimulatedEcProvider::ReadBytes(std::int64_t offset, std::uint8_t *buffer,
+                                     std::size_t size) const
+{
+    CheckRange(offset, size);
+    {
+        const std::lock_guard grd(mutex);
+        AdvanceModel();
+        UpdateSensorRegisters();
+        std::copy_n(std::next(registers.begin(), offset), size, buffer);
+        transactions += size;
+    }
+    EmulateLatency(size);
+}
+
+void CSimulatedEcProvider::WriteBytes(std::int64_t offset, const std::uint8_t *buffer,
+                                      std::size_t size) const
+{
+    CheckRange(offset, size);
+    {
+        const std::lock_guard grd(mutex);
+        // Model must run with old settings till now.
+        AdvanceModel();
+        std::copy_n(buffer, size, std::next(registers.begin(), offset));
+        transactions += size;
+    }
+    EmulateLatency(size);
+}
+
+CThermalPlant CSimulatedEcProvider::Plant() const
+{
+    const std::lock_guard grd(mutex);
+    AdvanceModel();
+    return plant;
+}
+
+std::size_t CSimulatedEcProvider::TransactionsCount() const
+{
+    const std::lock_guard grd(mutex);
+    return transactions;
+}
+
+void CSimulatedEcProvider::AdvanceModel() const
+{
+    const auto now = Clock::now();
+    const float dt =
+      std::chrono::duration<float>(now - lastAdvance).count() * std::max(params.timeScale, 0.f);
+    lastAdvance = now;
+
+    plant.Advance(dt, CurveFromRegisters(registers, kCpuCurve),
+                  CurveFromRegisters(registers, kGpuCurve),
+                  (registers[kBooster] & kBoosterBit) != 0);
+}
+
+void CSimulatedEcProvider::UpdateSensorRegisters() const
+{
+    const auto setWord = [this](std::size_t address, std::uint16_t value) {
+        // Big endian, as CReadWrite expects.
+        registers[address] = static_cast<std::uint8_t>(value >> 8u);
+        registers[address + 1] = static_cast<std::uint8_t>(value & 0xFFu);
+    };
+
+    registers[kCpuTemp] = TemperatureToRegister(plant.Cpu().temperature);
+    registers[kGpuTemp] = TemperatureToRegister(plant.Gpu().temperature);
+    setWord(kCpuRpm, RpmToRegister(plant.Cpu().Rpm(plant.Parameters().cpu)));
+    setWord(kGpuRpm, RpmToRegister(plant.Gpu().Rpm(plant.Parameters().gpu)));
+}
+
+void CSimulatedEcProvider::CheckRange(std::int64_t offset, std::size_t size) const
+{
+    if (offset < 0 || static_cast<std::size_t>(offset) + size > registers.size())
+    {
+        throw std::out_of_range("Simulated EC access out of range at offset "
+                                + std::to_string(offset) + ".");
+    }
+}
+
+void CSimulatedEcProvider::EmulateLatency(std::size_t size) const
+{
+    if (params.perByteLatency.count() > 0)
+    {
+        std::this_thread::sleep_for(params.perByteLatency * static_cast<std::int64_t>(size));
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "cm_ctors.h"
+#include "readwrite_provider.h"
+#include "thermal_plant.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/// @brief Settings of the simulated EC.
+struct SimulatedEcParameters
+{
+    ThermalPlantParameters plant{};
+    /// Empty profile means MakeDefaultLoadProfile().
+    LoadProfile loadProfile{};
+    /// Real EC does ACPI transaction per byte, it is slow. This emulates it.
+    std::chrono::microseconds perByteLatency{500};
+    /// Model time runs this times faster than real time.
+    float timeScale{1.f};
+};
+
+/// @brief Emulates MSI EC register map over thermal RC model (CThermalPlant), so daemon, GUI and
+/// deciders can be benchmarked and tested on any Linux box without MSI hardware.
+///
+/// Temperatures (0x68, 0x80) and fans' RPMs (0xCC, 0xCA) are produced by the model, fan's speed
+/// follows curve registers (0x72-0x78, 0x8A-0x90) and cooler boost bit (0x98, 0x80). All other
+/// registers are plain memory, initialized to the values real device has.
+/// @note This class is thread-safe.
+class CSimulatedEcProvider : public IReadWriteProvider
+{
+  public:
+    explicit CSimulatedEcProvider(SimulatedEcParameters params = {});
+    NO_COPYMOVE(CSimulatedEcProvider);
+    ~CSimulatedEcProvider() override;
+
+    void ReadBytes(std::int64_t offset, std::uint8_t *buffer, std::size_t size) const final;
+    void WriteBytes(std::int64_t offset, const std::uint8_t *buffer, std::size_t size) const final;
+
+    /// @returns Current state of the model.
+    [[nodiscard]]
+    CThermalPlant Plant() const;
+
+    /// @returns Amount of the bytes transferred (each is EC transaction on real device).
+    [[nodiscard]]
+    std::size_t TransactionsCount() const;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    void AdvanceModel() const;
+    void UpdateSensorRegisters() const;
+    void CheckRange(std::int64_t offset, std::size_t size) const;
+    void EmulateLatency(std::size_t size) const;
+
+    SimulatedEcParameters params;
+
+    mutable std::mutex mutex;
+    mutable CThermalPlant plant;
+    mutable std::array<std::uint8_t, 256> registers{};
+    mutable Clock::time_point lastAdvance;
+    mutable std::size_t transactions{0};
+};
@@ -7,11 +7,14 @@
 
 /// @brief Computes running tabular derivative of the function, based on real time passed.
 /// Measure units are [value unit] per [real time second].
-class TabularDerivative
+/// @tparam taClock Source of the time for Update() without timestamp, i.e. CManualClock in tests.
+/// It must be monotonic, wall clock adjustments would break derivative.
+template <typename taClock>
+class TabularDerivativeT
 {
   public:
-    using Clock = std::chrono::system_clock;
-    using TimePoint = Clock::time_point;
+    using Clock = taClock;
+    using TimePoint = typename Clock::time_point;
     using Duration = std::chrono::duration<float>;
     using TComputedValue = std::optional<float>;
 
@@ -32,17 +35,28 @@ class TabularDerivative
      * fewer false triggers, but delayed reaction.
      * At alpha = 1.0, no smoothing is applied and raw derivatives are used.
      */
-    explicit TabularDerivative(float smoothing_alpha) :
+    explicit TabularDerivativeT(float smoothing_alpha) :
         alpha(smoothing_alpha)
     {
     }
-    TabularDerivative() = delete;
+    TabularDerivativeT() = delete;
 
     /// @brief Offers new function value, time passed is measured between 2 calls of it.
     /// @note It must be used inside pereodical loop where real time process is measured.
     void Update(float value)
     {
-        history.emplace_back(value);
+        Update(value, Clock::now());
+    }
+
+    /// @brief Offers new function value sampled at @p time. Sample which is not newer than the
+    /// previous one is ignored, so the same reading offered twice does not break derivative.
+    void Update(float value, TimePoint time)
+    {
+        if (!history.empty() && time <= history.back().time)
+        {
+            return;
+        }
+        history.emplace_back(time, value);
         // Limiting to 3 values which is central difference or 2 which is forward difference.
         // It is enough to compute derivative. If more points are needed, then
         // central differences with larger window should be used. But it will increase latency.
@@ -80,8 +94,8 @@ class TabularDerivative
         TimePoint time; // x
         float value;    // f(x)
 
-        explicit Measure(float value) :
-            time(Clock::now()),
+        Measure(TimePoint time, float value) :
+            time(time),
             value(value)
         {
         }
@@ -101,11 +115,7 @@ class TabularDerivative
         const auto &right = history.back();
         const auto &left = history.front();
 
-        // Manual cast to seconds with milliseconds precision.
-        const float dtSeconds =
-          static_cast<float>(
-            std::chrono::duration_cast<std::chrono::milliseconds>(right.time - left.time).count())
-          / 1000.f;
+        const float dtSeconds = std::chrono::duration_cast<Duration>(right.time - left.time).count();
 
         if (dtSeconds <= 0.0f)
         {
@@ -120,3 +130,5 @@ class TabularDerivative
     TComputedValue smoothed;
     std::deque<Measure> history;
 };
+
+using TabularDerivative = TabularDerivativeT<std::chrono::steady_clock>;
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "history_ring.h"
+#include "messages_types.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/// File defines history of the telemetry which daemon keeps in separated shared memory. Daemon
+/// writes, clients map it read-only and may attach any time to get all history at once, without
+/// extra EC reads.
+
+/// @brief Single point of the history.
+struct TelemetrySample
+{
+    /// @brief std::chrono::steady_clock (CLOCK_MONOTONIC) in nanoseconds, it is the same in all
+    /// processes.
+    std::int64_t steadyTimeNs;
+    std::uint16_t cpuTemperature;
+    std::uint16_t cpuFanRpm;
+    std::uint16_t gpuTemperature;
+    std::uint16_t gpuFanRpm;
+    BoosterState fanBoosterState;
+    CpuTurboBoostState cpuTurboBoostState;
+    /// @brief ACPI interrupts per second (saturated) measured by daemon, 0 if unknown.
+    std::uint16_t acpiInterruptsPerSecond;
+    std::uint8_t reserved[4];
+
+    /// @param when Used as the sample time if CPU's Info::sampledAtNs is unknown.
+    static TelemetrySample From(const FullInfoBlock &info,
+                                std::chrono::steady_clock::time_point when)
+    {
+        TelemetrySample res{};
+        res.steadyTimeNs =
+          info.info.cpu.sampledAtNs != 0
+            ? info.info.cpu.sampledAtNs
+            : std::chrono::duration_cast<std::chrono::nanoseconds>(when.time_since_epoch()).count();
+        res.cpuTemperature = info.info.cpu.temperature;
+        res.cpuFanRpm = info.info.cpu.fanRPM;
+        res.gpuTemperature = info.info.gpu.temperature;
+        res.gpuFanRpm = info.info.gpu.fanRPM;
+        res.fanBoosterState = info.boostersStates.fanBoosterState;
+        res.cpuTurboBoostState = info.boostersStates.cpuTurboBoostState;
+        return res;
+    }
+};
+static_assert(sizeof(TelemetrySample) == 24, "Layout is shared between processes.");
+
+using CTelemetryHistory = CHistoryRing<TelemetrySample>;
+
+/// @returns Shared memory name of the telemetry history.
+inline const char *GetHistoryMemoryName()
+{
+    static const char *const ptr = "MSICoolersTelemetryHistory1";
+    return ptr;
+}
+
+/// @brief Daemon records not more than 1 sample per this period.
+inline constexpr auto kHistoryPeriod = std::chrono::seconds(1);
+
+/// @brief Last hour of the samples.
+inline constexpr std::size_t kHistorySamples = 3600;
+
+/// @brief Size of the history's shared memory, rounded to the whole pages.
+inline constexpr std::size_t kHistorySharedMemSize = [] {
+    constexpr std::size_t kPage = 4096;
+    return (CTelemetryHistory::RequiredSize(kHistorySamples) + kPage - 1) / kPage * kPage;
+}();
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// @brief Parameters of the single heat source (CPU or GPU) as thermal RC model:
+///  C * dT/dt = P - (T - T_ambient) * (G_passive + G_fan * fanFraction)
+struct ThermalNodeParameters
+{
+    /// Heat capacity of the die + heatsink, J/°C.
+    float heatCapacity{60.f};
+    /// Conductance to ambient when fans are stopped, W/°C.
+    float passiveConductance{0.25f};
+    /// Additional conductance at 100% fan's speed, W/°C.
+    float fanConductance{1.0f};
+    /// RPM of the fan at 100% speed.
+    float maxRpm{6000.f};
+    /// Time constant of the fan's speed change, seconds.
+    float fanSpinTime{2.f};
+};
+
+/// @brief One step of the load profile: heat produced by CPU/GPU during @var duration.
+struct LoadSegment
+{
+    std::chrono::milliseconds duration;
+    float cpuPower;
+    float gpuPower;
+};
+
+using LoadProfile = std::vector<LoadSegment>;
+
+/// @returns Default profile: idle, gaming load, idle, short stress spike. It is looped.
+inline LoadProfile MakeDefaultLoadProfile()
+{
+    using namespace std::chrono_literals;
+    return {
+      {60s, 8.f, 5.f},
+      {180s, 45.f, 60.f},
+      {60s, 8.f, 5.f},
+      {60s, 65.f, 5.f},
+    };
+}
+
+/// @brief Parameters of the whole laptop.
+struct ThermalPlantParameters
+{
+    float ambient{35.f};
+    ThermalNodeParameters cpu{};
+    ThermalNodeParameters gpu{60.f, 0.3f, 1.2f, 6000.f, 2.f};
+};
+
+/// @brief Thermal model of the laptop with CPU, GPU and fan per each.
+/// Fan speed is defined by the fan curve: 7 steps, each step is activated at fixed temperature
+/// (kStepTemperatures) and its curve byte is fan's speed in percents. It is 100% when cooler boost
+/// is on.
+class CThermalPlant
+{
+  public:
+    static constexpr std::size_t kCurveSteps = 7;
+    using Curve = std::array<std::uint8_t, kCurveSteps>;
+    /// @brief Temperatures where EC activates each step of the curve.
+    static constexpr std::array<float, kCurveSteps> kStepTemperatures{0.f,  50.f, 57.f, 64.f,
+                                                                     71.f, 78.f, 85.f};
+
+    /// @brief Temperature & fan state of the one heat source.
+    struct NodeState
+    {
+        float temperature;
+        float fanFraction;
+
+        [[nodiscard]]
+        float Rpm(const ThermalNodeParameters &params) const
+        {
+            return params.maxRpm * fanFraction;
+        }
+    };
+
+    explicit CThermalPlant(ThermalPlantParameters params = {}, LoadProfile profile = {}) :
+        params(params),
+        profile(profile.empty() ? MakeDefaultLoadProfile() : std::move(profile)),
+        cpu{params.ambient, 0.f},
+        gpu{params.ambient, 0.f}
+    {
+    }
+
+    /// @brief Advances model for @p dtSeconds using current fan's settings.
+    /// Large steps are split, so model stays stable.
+    void Advance(float dtSeconds, const Curve &cpuCurve, const Curve &gpuCurve, bool coolerBoost)
+    {
+        constexpr float kMaxStep = 0.1f;
+        while (dtSeconds > 0.f)
+        {
+            const float dt = std::min(dtSeconds, kMaxStep);
+            const auto &load = CurrentLoad();
+            Step(cpu, params.cpu, load.cpuPower * cpuPowerScale, dt, cpuCurve, coolerBoost);
+            Step(gpu, params.gpu, load.gpuPower, dt, gpuCurve, coolerBoost);
+            MoveProfile(dt);
+            dtSeconds -= dt;
+        }
+    }
+
+    /// @brief CPU produces only this part of the profile's power, i.e. when turbo-boost is off.
+    void SetCpuPowerScale(float scale)
+    {
+        cpuPowerScale = std::clamp(scale, 0.f, 1.f);
+    }
+
+    [[nodiscard]]
+    const NodeState &Cpu() const
+    {
+        return cpu;
+    }
+
+    [[nodiscard]]
+    const NodeState &Gpu() const
+    {
+        return gpu;
+    }
+
+    [[nodiscard]]
+    const ThermalPlantParameters &Parameters() const
+    {
+        return params;
+    }
+
+    /// @returns Load which is applied right now.
+    [[nodiscard]]
+    const LoadSegment &CurrentLoad() const
+    {
+        return profile.at(segmentIndex);
+    }
+
+  private:
+    /// @brief Curve byte which means 100% of the fan's speed, EC accepts up to 150.
+    static constexpr float kFullSpeed = 100.f;
+
+    ThermalPlantParameters params;
+    LoadProfile profile;
+    std::size_t segmentIndex{0};
+    float segmentPassed{0.f};
+    float cpuPowerScale{1.f};
+
+    NodeState cpu;
+    NodeState gpu;
+
+    /// @returns Fan fraction requested by curve for the temperature.
+    static float FanDemand(float temperature, const Curve &curve, bool coolerBoost)
+    {
+        if (coolerBoost)
+        {
+            return 1.f;
+        }
+        std::size_t step = 0;
+        for (std::size_t i = 0; i < kStepTemperatures.size(); ++i)
+        {
+            if (temperature >= kStepTemperatures.at(i))
+            {
+                step = i;
+            }
+        }
+        return std::min(static_cast<float>(curve.at(step)) / kFullSpeed, 1.f);
+    }
+
+    void Step(NodeState &node, const ThermalNodeParameters &nodeParams, float power, float dt,
+              const Curve &curve, bool coolerBoost) const
+    {
+        const float demand = FanDemand(node.temperature, curve, coolerBoost);
+        node.fanFraction +=
+          (demand - node.fanFraction) * std::min(1.f, dt / std::max(nodeParams.fanSpinTime, dt));
+
+        const float conductance =
+          nodeParams.passiveConductance + nodeParams.fanConductance * node.fanFraction;
+        const float heatFlow = power - (node.temperature - params.ambient) * conductance;
+        node.temperature += heatFlow * dt / nodeParams.heatCapacity;
+    }
+
+    void MoveProfile(float dt)
+    {
+        segmentPassed += dt;
+        const auto segmentSeconds =
+          std::chrono::duration<float>(profile.at(segmentIndex).duration).count();
+        if (segmentPassed >= segmentSeconds)
+        {
+            segmentPassed -= segmentSeconds;
+            segmentIndex = (segmentIndex + 1) % profile.size();
+        }
+    }
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "cm_ctors.h"
+#include "csysfsprovider.h"
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <utility>
+
+/// @brief Turns CPU's turbo-boost on and off. It is not EC register, so it is separated from
+/// CReadWrite.
+class ITurboBoostSwitch
+{
+  public:
+    ITurboBoostSwitch() = default;
+    NO_COPYMOVE(ITurboBoostSwitch);
+    virtual ~ITurboBoostSwitch() = default;
+
+    /// @returns true if turbo-boost is disabled.
+    [[nodiscard]]
+    virtual bool IsDisabled() const = 0;
+    virtual void SetDisabled(bool disabled) const = 0;
+};
+
+using TurboBoostSwitchPtr = std::shared_ptr<ITurboBoostSwitch>;
+
+/// @brief Real switch: "no_turbo" file of the intel_pstate driver.
+class CIntelPStateTurboBoost : public ITurboBoostSwitch
+{
+  public:
+    explicit CIntelPStateTurboBoost(std::filesystem::path noTurbo = kIntelPStateNoTurbo) :
+        noTurbo(std::move(noTurbo))
+    {
+    }
+    NO_COPYMOVE(CIntelPStateTurboBoost);
+    ~CIntelPStateTurboBoost() override = default;
+
+    [[nodiscard]]
+    bool IsDisabled() const final
+    {
+        return ReadFsBool(noTurbo);
+    }
+
+    void SetDisabled(bool disabled) const final
+    {
+        WriteFsBool(noTurbo, disabled);
+    }
+
+  private:
+    std::filesystem::path noTurbo;
+};
+
+/// @brief Switch which only remembers the state. It is used over simulated EC, so host's
+/// turbo-boost is not touched.
+class CMemoryTurboBoost : public ITurboBoostSwitch
+{
+  public:
+    CMemoryTurboBoost() = default;
+    NO_COPYMOVE(CMemoryTurboBoost);
+    ~CMemoryTurboBoost() override = default;
+
+    [[nodiscard]]
+    bool IsDisabled() const final
+    {
+        return disabled.load();
+    }
+
+    void SetDisabled(bool value) const final
+    {
+        disabled = value;
+    }
+
+  private:
+    mutable std::atomic<bool> disabled{false};
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "messages_types.h"
+#include "seqlock_buffer.h"
+#include "wire_messages.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+
+/// @brief Daemon side. Publishes FullInfoBlock into CSeqlockBuffer, but writes only fields which
+/// were changed. Each field keeps tag of the publication which changed it last time, so clients
+/// can find out what changed since they looked last time, even if they skipped some publications.
+class CWireDeltaPublisher
+{
+  public:
+    /// @returns Fields changed by this publication.
+    /// @throws std::invalid_argument if @p info does not fit wire::FullInfo.
+    wire::FieldsMask Publish(const CSeqlockBuffer &buffer, const FullInfoBlock &info)
+    {
+        auto next = CWireCodec::Encode(info);
+        if (hasPrevious)
+        {
+            next.changedFields = wire::ChangedFields(previous, next);
+            for (std::size_t i = 0; i < wire::kFieldsCount; ++i)
+            {
+                if (!(next.changedFields & wire::FieldBit(static_cast<wire::Field>(i))))
+                {
+                    next.fieldTags[i] = previous.fieldTags[i];
+                }
+            }
+        }
+
+        // Seqlock is double buffered, so the buffer we write into misses changes of the latest
+        // publication too.
+        const auto toCopy = next.changedFields | previousChanged;
+        buffer.PublishWith(sizeof(next), [&next, toCopy](char *payload) {
+            const auto *src = reinterpret_cast<const char *>(&next); // NOLINT
+            std::memcpy(payload, src, wire::kFullInfoHeadSize);
+            wire::CopyFields(payload, src, toCopy);
+        });
+
+        previous = next;
+        previousChanged = next.changedFields;
+        hasPrevious = true;
+        return next.changedFields;
+    }
+
+  private:
+    wire::FullInfo previous{};
+    wire::FieldsMask previousChanged{wire::kAllFields};
+    bool hasPrevious{false};
+};
+
+/// @brief Client side of the CWireDeltaPublisher. Copies out of the shared memory only subscribed
+/// fields which were changed since previous Read().
+class CWireDeltaSubscriber
+{
+  public:
+    explicit CWireDeltaSubscriber(wire::FieldsMask subscribed = wire::kAllFields) :
+        subscribed(subscribed & wire::kAllFields)
+    {
+    }
+
+    /// @returns Subscribed fields changed since previous call (can be 0 if only tag changed) or
+    /// std::nullopt if nothing could be read.
+    std::optional<wire::FieldsMask> Read(const CSeqlockBuffer &buffer)
+    {
+        wire::FieldsMask changed = 0;
+        const bool ok = buffer.ReadLatestWith([this, &changed](const char *payload,
+                                                                std::size_t size) {
+            if (size != sizeof(wire::FullInfo))
+            {
+                return false;
+            }
+            auto *dst = reinterpret_cast<char *>(&scratch); // NOLINT
+            std::memcpy(dst, payload, wire::kFullInfoHeadSize);
+            changed = 0;
+            for (std::size_t i = 0; i < wire::kFieldsCount; ++i)
+            {
+                const auto bit = wire::FieldBit(static_cast<wire::Field>(i));
+                if ((subscribed & bit) && (!hasLatest || scratch.fieldTags[i] != knownTags[i]))
+                {
+                    changed |= bit;
+                }
+            }
+            wire::CopyFields(dst, payload, changed);
+            return true;
+        });
+        if (!ok)
+        {
+            return std::nullopt;
+        }
+
+        std::memcpy(&latest, &scratch, wire::kFullInfoHeadSize);
+        wire::CopyFields(reinterpret_cast<char *>(&latest),         // NOLINT
+                         reinterpret_cast<const char *>(&scratch), // NOLINT
+                         changed);
+        std::copy(std::begin(scratch.fieldTags), std::end(scratch.fieldTags), knownTags);
+        hasLatest = true;
+        return changed;
+    }
+
+    /// @returns Local copy, only subscribed fields are valid.
+    [[nodiscard]]
+    const wire::FullInfo &Latest() const
+    {
+        return latest;
+    }
+
+  private:
+    wire::FieldsMask subscribed;
+    wire::FullInfo scratch{};
+    wire::FullInfo latest{};
+    std::uint64_t knownTags[wire::kFieldsCount]{};
+    bool hasLatest{false};
+};
@@ -0,0 +1,516 @@
+#pragma once
+
+#include "device_commands.h"
+#include "messages_types.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ios>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <variant>
+
+/// File contains fixed layout representation of the messages from messages_types.h. Those are
+/// copied into the shared memory as is: no allocations, no parsing, and size of each message is
+/// known at compile time, so it cannot overflow the shared memory.
+///
+/// Cereal's serialize() of the messages_types.h are kept for debug dumps only.
+namespace wire {
+
+/// @brief Must be incremented on any change of the layout below.
+inline constexpr std::uint16_t kVersion = 4;
+
+inline constexpr std::uint32_t kFullInfoMagic = 0x4946534Du; // "MSFI"
+inline constexpr std::uint32_t kRequestMagic = 0x5246534Du;  // "MSFR"
+
+inline constexpr std::size_t kMaxCurvePoints = 8;
+inline constexpr std::size_t kMaxErrorText = 256;
+
+/// @brief Which alternative of AddressedValueAny is stored.
+enum class ValueKind : std::uint8_t {
+    IGNORE,
+    ONE_BYTE,
+    TWO_BYTES,
+    BITS,
+};
+
+struct Header
+{
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint16_t size;
+};
+
+struct AddressedValue
+{
+    std::uint32_t address;
+    std::uint16_t value;
+    ValueKind kind;
+    std::uint8_t validBits;
+};
+
+struct Curve
+{
+    std::uint8_t count;
+    std::uint8_t reserved[3];
+    AddressedValue points[kMaxCurvePoints];
+};
+
+/// @brief Groups of FullInfo members which are tracked for the changes and can be copied
+/// independently.
+enum class Field : std::uint8_t {
+    CPU_INFO,
+    GPU_INFO,
+    BOOSTERS,
+    BATTERY,
+    BEHAVE_AND_CURVE,
+    DEVICE_ERROR,
+    COUNT
+};
+
+/// @brief Bit per Field.
+using FieldsMask = std::uint32_t;
+
+constexpr FieldsMask FieldBit(Field field)
+{
+    return 1u << static_cast<std::uint8_t>(field);
+}
+
+inline constexpr auto kFieldsCount = static_cast<std::size_t>(Field::COUNT);
+inline constexpr FieldsMask kAllFields = FieldBit(Field::COUNT) - 1u;
+
+/// @brief FullInfoBlock.
+/// @note Members of the same Field must stay together, see RangeOf().
+struct FullInfo
+{
+    Header header;
+    std::uint64_t tag;
+    /// Fields changed by this publication comparing to previous one.
+    FieldsMask changedFields;
+    std::uint32_t reserved;
+    /// Tag of the publication which changed the Field last time, indexed by Field.
+    std::uint64_t fieldTags[kFieldsCount];
+    /// Info::sampledAtNs of the CPU / GPU. Those are in the head, so each sample does not mark
+    /// Fields as changed.
+    std::int64_t cpuSampledAtNs;
+    std::int64_t gpuSampledAtNs;
+
+    // Field::CPU_INFO
+    std::uint16_t cpuTemperature;
+    std::uint16_t cpuFanRpm;
+    // Field::GPU_INFO
+    std::uint16_t gpuTemperature;
+    std::uint16_t gpuFanRpm;
+    // Field::BOOSTERS
+    BoosterState fanBoosterState;
+    CpuTurboBoostState cpuTurboBoostState;
+    PolicyState gameMode;
+    std::uint8_t reservedBoosters[1];
+    // Field::BATTERY
+    /// Index of the alternative of Battery::TBatteryState.
+    std::uint8_t batteryState;
+    Battery::BatteryLevels batteryLevel;
+    std::uint8_t reservedBattery[2];
+    AddressedValue batteryRead;
+    // Field::BEHAVE_AND_CURVE
+    BehaveState behaveState;
+    std::uint8_t reservedBehave[3];
+    Curve cpuCurve;
+    Curve gpuCurve;
+    // Field::DEVICE_ERROR
+    /// Zero terminated.
+    char error[kMaxErrorText];
+    std::uint8_t reservedTail[4];
+};
+
+/// @brief Part of the FullInfo which is always present in any publication.
+inline constexpr std::size_t kFullInfoHeadSize = offsetof(FullInfo, cpuTemperature);
+
+/// @brief Location of the @p field inside FullInfo.
+struct FieldRange
+{
+    std::size_t offset;
+    std::size_t size;
+};
+
+constexpr FieldRange RangeOf(Field field)
+{
+    const auto between = [](std::size_t begin, std::size_t end) {
+        return FieldRange{begin, end - begin};
+    };
+    switch (field)
+    {
+        case Field::CPU_INFO:
+            return between(offsetof(FullInfo, cpuTemperature), offsetof(FullInfo, gpuTemperature));
+        case Field::GPU_INFO:
+            return between(offsetof(FullInfo, gpuTemperature), offsetof(FullInfo, fanBoosterState));
+        case Field::BOOSTERS:
+            return between(offsetof(FullInfo, fanBoosterState), offsetof(FullInfo, batteryState));
+        case Field::BATTERY:
+            return between(offsetof(FullInfo, batteryState), offsetof(FullInfo, behaveState));
+        case Field::BEHAVE_AND_CURVE:
+            return between(offsetof(FullInfo, behaveState), offsetof(FullInfo, error));
+        case Field::DEVICE_ERROR:
+        case Field::COUNT:
+            break;
+    }
+    return between(offsetof(FullInfo, error), offsetof(FullInfo, reservedTail));
+}
+
+/// @returns Fields which have different bytes in @p a and @p b.
+inline FieldsMask ChangedFields(const FullInfo &a, const FullInfo &b)
+{
+    FieldsMask res = 0;
+    for (std::size_t i = 0; i < kFieldsCount; ++i)
+    {
+        const auto field = static_cast<Field>(i);
+        const auto range = RangeOf(field);
+        const auto *pa = reinterpret_cast<const char *>(&a) + range.offset; // NOLINT
+        const auto *pb = reinterpret_cast<const char *>(&b) + range.offset; // NOLINT
+        if (std::memcmp(pa, pb, range.size) != 0)
+        {
+            res |= FieldBit(field);
+        }
+    }
+    return res;
+}
+
+/// @brief Copies Fields given by @p mask from @p src to @p dst, both point to FullInfo.
+inline void CopyFields(char *dst, const char *src, FieldsMask mask)
+{
+    for (std::size_t i = 0; i < kFieldsCount; ++i)
+    {
+        const auto field = static_cast<Field>(i);
+        if (mask & FieldBit(field))
+        {
+            const auto range = RangeOf(field);
+            std::memcpy(dst + range.offset, src + range.offset, range.size);
+        }
+    }
+}
+
+/// @brief RequestFromUi.
+struct Request
+{
+    Header header;
+    RequestFromUi::RequestType request;
+    BoosterState fanBoosterState;
+    CpuTurboBoostState cpuTurboBoostState;
+    BehaveState behaveState;
+    std::uint8_t batteryState;
+    Battery::BatteryLevels batteryLevel;
+    PolicyState gameMode;
+    std::uint8_t reserved[1];
+    Curve cpuCurve;
+    Curve gpuCurve;
+};
+
+template <typename taMessage>
+constexpr void CheckLayout()
+{
+    static_assert(std::is_trivially_copyable_v<taMessage>, "Must be copied by memcpy.");
+    static_assert(std::is_standard_layout_v<taMessage>, "Must have predictable layout.");
+    static_assert(alignof(taMessage) <= 8, "Must not need over-aligned memory.");
+}
+
+static_assert((CheckLayout<Header>(), sizeof(Header) == 8));
+static_assert((CheckLayout<AddressedValue>(), sizeof(AddressedValue) == 8));
+static_assert((CheckLayout<Curve>(), sizeof(Curve) == 68));
+
+static_assert((CheckLayout<FullInfo>(), sizeof(FullInfo) == 512));
+static_assert(offsetof(FullInfo, tag) == 8);
+static_assert(offsetof(FullInfo, changedFields) == 16);
+static_assert(offsetof(FullInfo, fieldTags) == 24);
+static_assert(offsetof(FullInfo, cpuSampledAtNs) == 72);
+static_assert(offsetof(FullInfo, cpuTemperature) == 88);
+static_assert(offsetof(FullInfo, fanBoosterState) == 96);
+static_assert(offsetof(FullInfo, batteryRead) == 104);
+static_assert(offsetof(FullInfo, cpuCurve) == 116);
+static_assert(offsetof(FullInfo, gpuCurve) == 184);
+static_assert(offsetof(FullInfo, error) == 252);
+static_assert(RangeOf(Field::DEVICE_ERROR).size == kMaxErrorText);
+static_assert(kAllFields == 0x3Fu);
+
+static_assert((CheckLayout<Request>(), sizeof(Request) == 152));
+static_assert(offsetof(Request, request) == 8);
+static_assert(offsetof(Request, cpuCurve) == 16);
+static_assert(offsetof(Request, gpuCurve) == 84);
+
+} // namespace wire
+
+/// @brief Converts messages_types.h structs into wire:: layout and back.
+class CWireCodec
+{
+  public:
+    /// @throws std::invalid_argument if message does not fit fixed layout (like too long curve).
+    static wire::FullInfo Encode(const FullInfoBlock &info)
+    {
+        auto res = MakeMessage<wire::FullInfo>(wire::kFullInfoMagic);
+        res.tag = info.tag;
+        // Standalone message is "all changed", CWireDeltaPublisher refines it.
+        res.changedFields = wire::kAllFields;
+        std::fill(std::begin(res.fieldTags), std::end(res.fieldTags), res.tag);
+        res.cpuSampledAtNs = info.info.cpu.sampledAtNs;
+        res.gpuSampledAtNs = info.info.gpu.sampledAtNs;
+        res.cpuTemperature = info.info.cpu.temperature;
+        res.cpuFanRpm = info.info.cpu.fanRPM;
+        res.gpuTemperature = info.info.gpu.temperature;
+        res.gpuFanRpm = info.info.gpu.fanRPM;
+        res.fanBoosterState = info.boostersStates.fanBoosterState;
+        res.cpuTurboBoostState = info.boostersStates.cpuTurboBoostState;
+        res.gameMode = info.gameMode;
+        res.behaveState = info.behaveAndCurve.behaveState;
+        EncodeBattery(info.battery, res.batteryState, res.batteryLevel);
+        res.batteryRead = EncodeValue(info.battery._debugRead);
+        res.cpuCurve = EncodeCurve(info.behaveAndCurve.curve.cpu);
+        res.gpuCurve = EncodeCurve(info.behaveAndCurve.curve.gpu);
+
+        const auto errorLength = std::min(info.daemonDeviceException.size(), sizeof(res.error) - 1);
+        std::memcpy(res.error, info.daemonDeviceException.data(), errorLength);
+        return res;
+    }
+
+    /// @throws std::runtime_error if message was produced by incompatible binary.
+    static FullInfoBlock Decode(const wire::FullInfo &info)
+    {
+        FullInfoBlock res;
+        Decode(info, wire::kAllFields, res);
+        return res;
+    }
+
+    /// @brief Updates only @p fields of the @p out, tag and sample times are updated always.
+    /// @throws std::runtime_error if message was produced by incompatible binary.
+    static void Decode(const wire::FullInfo &info, wire::FieldsMask fields, FullInfoBlock &out)
+    {
+        CheckHeader<wire::FullInfo>(info.header, wire::kFullInfoMagic);
+
+        const auto has = [fields](wire::Field field) {
+            return (fields & wire::FieldBit(field)) != 0;
+        };
+
+        out.tag = static_cast<std::size_t>(info.tag);
+        out.info.cpu.sampledAtNs = info.cpuSampledAtNs;
+        out.info.gpu.sampledAtNs = info.gpuSampledAtNs;
+        if (has(wire::Field::CPU_INFO))
+        {
+            out.info.cpu.temperature = info.cpuTemperature;
+            out.info.cpu.fanRPM = info.cpuFanRpm;
+        }
+        if (has(wire::Field::GPU_INFO))
+        {
+            out.info.gpu.temperature = info.gpuTemperature;
+            out.info.gpu.fanRPM = info.gpuFanRpm;
+        }
+        if (has(wire::Field::BOOSTERS))
+        {
+            out.boostersStates.fanBoosterState = info.fanBoosterState;
+            out.boostersStates.cpuTurboBoostState = info.cpuTurboBoostState;
+            out.gameMode = info.gameMode;
+        }
+        if (has(wire::Field::BATTERY))
+        {
+            out.battery = DecodeBattery(info.batteryState, info.batteryLevel);
+            const auto batteryRead = DecodeValue(info.batteryRead);
+            if (const auto *bits = std::get_if<AddressedBits>(&batteryRead))
+            {
+                out.battery._debugRead = *bits;
+            }
+        }
+        if (has(wire::Field::BEHAVE_AND_CURVE))
+        {
+            out.behaveAndCurve.behaveState = info.behaveState;
+            out.behaveAndCurve.curve.cpu = DecodeCurve(info.cpuCurve);
+            out.behaveAndCurve.curve.gpu = DecodeCurve(info.gpuCurve);
+        }
+        if (has(wire::Field::DEVICE_ERROR))
+        {
+            const auto *errorEnd = std::find(std::begin(info.error), std::end(info.error), '\0');
+            out.daemonDeviceException.assign(std::begin(info.error), errorEnd);
+        }
+    }
+
+    static wire::Request Encode(const RequestFromUi &request)
+    {
+        auto res = MakeMessage<wire::Request>(wire::kRequestMagic);
+        res.request = request.request;
+        res.fanBoosterState = request.boostersStates.fanBoosterState;
+        res.cpuTurboBoostState = request.boostersStates.cpuTurboBoostState;
+        res.gameMode = request.gameMode;
+        res.behaveState = request.behaveAndCurve.behaveState;
+        EncodeBattery(request.battery, res.batteryState, res.batteryLevel);
+        res.cpuCurve = EncodeCurve(request.behaveAndCurve.curve.cpu);
+        res.gpuCurve = EncodeCurve(request.behaveAndCurve.curve.gpu);
+        return res;
+    }
+
+    /// @throws std::invalid_argument if any state is out of its enum's range. Requests are written
+    /// by the clients, so they are not trusted.
+    static RequestFromUi Decode(const wire::Request &request)
+    {
+        CheckHeader<wire::Request>(request.header, wire::kRequestMagic);
+        CheckEnum(request.request, RequestFromUi::RequestType::WRITE_DATA, "Request type");
+        CheckEnum(request.fanBoosterState, BoosterState::NO_CHANGE, "Booster state");
+        CheckEnum(request.cpuTurboBoostState, CpuTurboBoostState::NO_CHANGE, "Turbo-boost state");
+        CheckEnum(request.gameMode, PolicyState::NO_CHANGE, "Game mode state");
+        CheckEnum(request.behaveState, BehaveState::NO_CHANGE, "Behave state");
+        if (request.batteryState >= std::variant_size_v<Battery::TBatteryState>)
+        {
+            throw std::invalid_argument("Battery state is out of range.");
+        }
+        CheckEnum(request.batteryLevel, Battery::BatteryLevels::BestForMobility, "Battery level");
+
+        RequestFromUi res{request.request};
+        res.boostersStates.fanBoosterState = request.fanBoosterState;
+        res.boostersStates.cpuTurboBoostState = request.cpuTurboBoostState;
+        res.gameMode = request.gameMode;
+        res.behaveAndCurve.behaveState = request.behaveState;
+        res.behaveAndCurve.curve.cpu = DecodeCurve(request.cpuCurve);
+        res.behaveAndCurve.curve.gpu = DecodeCurve(request.gpuCurve);
+        res.battery = DecodeBattery(request.batteryState, request.batteryLevel);
+        return res;
+    }
+
+  private:
+    template <typename taMessage>
+    static taMessage MakeMessage(std::uint32_t magic)
+    {
+        taMessage res;
+        // Padding is zeroed too, so messages can be compared by memcmp().
+        std::memset(&res, 0, sizeof(res));
+        res.header.magic = magic;
+        res.header.version = wire::kVersion;
+        res.header.size = static_cast<std::uint16_t>(sizeof(taMessage));
+        return res;
+    }
+
+    template <typename taMessage>
+    static void CheckHeader(const wire::Header &header, std::uint32_t magic)
+    {
+        if (header.magic != magic || header.version != wire::kVersion
+            || header.size != sizeof(taMessage))
+        {
+            throw std::runtime_error("Recompile. It is not compatible binary with older code.");
+        }
+    }
+
+    /// @brief Enums below are continuous, starting from 0, so @p last defines the range.
+    template <typename taEnum>
+    static void CheckEnum(taEnum value, taEnum last, const char *what)
+    {
+        using underlying_t = std::underlying_type_t<taEnum>;
+        if (static_cast<underlying_t>(value) > static_cast<underlying_t>(last))
+        {
+            throw std::invalid_argument(std::string(what) + " is out of range.");
+        }
+    }
+
+    static wire::AddressedValue EncodeValue(const AddressedValueAny &value)
+    {
+        return std::visit(
+          [](const auto &element) {
+              using element_t = std::decay_t<decltype(element)>;
+              const auto address = static_cast<std::streamoff>(element.address);
+              if (address < 0 || address > static_cast<std::streamoff>(UINT32_MAX))
+              {
+                  throw std::invalid_argument("Address does not fit wire format.");
+              }
+
+              wire::AddressedValue res{static_cast<std::uint32_t>(address), element.value,
+                                       wire::ValueKind::IGNORE, 0};
+              if constexpr (std::is_same_v<element_t, AddressedValue1B>)
+              {
+                  res.kind = wire::ValueKind::ONE_BYTE;
+              }
+              else if constexpr (std::is_same_v<element_t, AddressedValue2B>)
+              {
+                  res.kind = wire::ValueKind::TWO_BYTES;
+              }
+              else if constexpr (std::is_same_v<element_t, AddressedBits>)
+              {
+                  res.kind = wire::ValueKind::BITS;
+                  res.validBits = element.validBits;
+              }
+              return res;
+          },
+          value);
+    }
+
+    static AddressedValueAny DecodeValue(const wire::AddressedValue &value)
+    {
+        const std::streampos address = static_cast<std::streamoff>(value.address);
+        switch (value.kind)
+        {
+            case wire::ValueKind::ONE_BYTE:
+                return AddressedValue1B{address, static_cast<std::uint8_t>(value.value)};
+            case wire::ValueKind::TWO_BYTES:
+                return AddressedValue2B{address, value.value};
+            case wire::ValueKind::BITS:
+                return AddressedBits{address, value.validBits,
+                                     static_cast<std::uint8_t>(value.value)};
+            case wire::ValueKind::IGNORE:
+                break;
+        }
+        return TagIgnore{address, static_cast<std::uint8_t>(value.value)};
+    }
+
+    static wire::Curve EncodeCurve(const AddressedValueAnyList &curve)
+    {
+        if (curve.size() > wire::kMaxCurvePoints)
+        {
+            throw std::invalid_argument("Curve is too long for the wire format.");
+        }
+        wire::Curve res{};
+        res.count = static_cast<std::uint8_t>(curve.size());
+        std::transform(curve.begin(), curve.end(), res.points, &EncodeValue);
+        return res;
+    }
+
+    static AddressedValueAnyList DecodeCurve(const wire::Curve &curve)
+    {
+        AddressedValueAnyList res;
+        const auto count = std::min<std::size_t>(curve.count, wire::kMaxCurvePoints);
+        res.reserve(count);
+        std::transform(curve.points, curve.points + count, std::back_inserter(res), &DecodeValue);
+        return res;
+    }
+
+    static void EncodeBattery(const Battery &battery, std::uint8_t &state,
+                              Battery::BatteryLevels &level)
+    {
+        state = static_cast<std::uint8_t>(battery.maxLevel.index());
+        level = Battery::BatteryLevels::Balanced;
+        if (const auto *exact = std::get_if<Battery::BatteryLevels>(&battery.maxLevel))
+        {
+            level = *exact;
+        }
+    }
+
+    template <std::size_t taIndex, typename taState>
+    static constexpr bool kIsBatteryState =
+      std::is_same_v<std::variant_alternative_t<taIndex, Battery::TBatteryState>, taState>;
+    static_assert(kIsBatteryState<0, Battery::TCannotDetectBatteryControlSlot>
+                    && kIsBatteryState<1, Battery::TLevelWasNotExact>
+                    && kIsBatteryState<2, Battery::TInvalidRange>
+                    && kIsBatteryState<3, Battery::BatteryLevels>,
+                  "Update DecodeBattery() and wire::kVersion.");
+
+    static Battery DecodeBattery(std::uint8_t state, Battery::BatteryLevels level)
+    {
+        switch (state)
+        {
+            case 1:
+                return Battery{Battery::TLevelWasNotExact{}};
+            case 2:
+                return Battery{Battery::TInvalidRange{}};
+            case 3:
+                return Battery{level};
+            default:
+                break;
+        }
+        return Battery{Battery::TCannotDetectBatteryControlSlot{}};
+    }
+};
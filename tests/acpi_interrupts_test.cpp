@@ -0,0 +1,88 @@
+#include "acpi_interrupts.h"
+#include "register_cache.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include <gtest/gtest.h>
+
+/// @brief ACPI interrupts parsing and class CAcpiInterruptAccounting tests.
+namespace Test {
+
+using namespace std::chrono_literals;
+
+TEST(AcpiInterruptsTest, ParsesProcInterrupts)
+{
+    constexpr auto kText = "           CPU0       CPU1\n"
+                           "  0:         44          0   IO-APIC    2-edge      timer\n"
+                           "  9:        120         30   IO-APIC    9-fasteoi   acpi\n"
+                           " 16:          5          7   IO-APIC   16-fasteoi   i801_smbus, acpi2\n";
+    EXPECT_EQ(ParseProcInterruptsAcpi(kText), 150u);
+    EXPECT_EQ(ParseProcInterruptsAcpi("  0:  44  IO-APIC  2-edge  timer\n"), std::nullopt);
+    EXPECT_EQ(ParseProcInterruptsAcpi(" 9:  1  2  IR-IO-APIC  9-fasteoi  acpi, ec\n"), 3u);
+
+    EXPECT_EQ(ParseAcpiInterruptsCounter("  1234  EN     enabled      unmasked\n"), 1234u);
+    EXPECT_EQ(ParseAcpiInterruptsCounter("disabled"), std::nullopt);
+}
+
+TEST(AcpiInterruptsTest, AttributesSessions)
+{
+    std::uint64_t counter = 100;
+    CAcpiInterruptAccounting accounting([&counter]() -> std::optional<std::uint64_t> {
+        return counter;
+    });
+    ASSERT_TRUE(accounting.IsAvailable());
+
+    // Interrupts between sessions go to the total only.
+    counter += 5;
+    accounting.Begin();
+    counter += 3;
+    accounting.End(InterruptCause::CLIENT_REQUEST);
+
+    RegisterClassCounters bytes{};
+    bytes.at(RegisterClassIndex(RegisterClass::FAST_SENSOR)) = 3;
+    bytes.at(RegisterClassIndex(RegisterClass::SLOW_SETTING)) = 1;
+    accounting.Begin();
+    counter += 10;
+    accounting.End(bytes);
+
+    const auto &stats = accounting.Statistics();
+    EXPECT_EQ(stats.total, 18u);
+    EXPECT_EQ(stats.byCause.at(static_cast<std::size_t>(InterruptCause::CLIENT_REQUEST)), 3u);
+    EXPECT_EQ(stats.byCause.at(static_cast<std::size_t>(InterruptCause::READ_PLAN)), 10u);
+    EXPECT_EQ(stats.readPlans, 1u);
+    EXPECT_EQ(stats.lastReadPlan, 10u);
+    // 10 * 3 / 4 = 7 and 10 * 1 / 4 = 2, remainder goes to the class which read the most.
+    EXPECT_EQ(stats.byRegisterClass.at(RegisterClassIndex(RegisterClass::FAST_SENSOR)), 8u);
+    EXPECT_EQ(stats.byRegisterClass.at(RegisterClassIndex(RegisterClass::SLOW_SETTING)), 2u);
+}
+
+TEST(AcpiInterruptsTest, MeasuresRate)
+{
+    std::uint64_t counter = 0;
+    CAcpiInterruptAccounting accounting([&counter]() -> std::optional<std::uint64_t> {
+        return counter;
+    });
+    const CAcpiInterruptAccounting::Clock::time_point start{};
+    accounting.UpdateRate(start);
+    counter = 40;
+    accounting.UpdateRate(start + 500ms);
+    EXPECT_DOUBLE_EQ(accounting.Statistics().perSecond, 0.);
+    accounting.UpdateRate(start + 2s);
+    EXPECT_DOUBLE_EQ(accounting.Statistics().perSecond, 20.);
+}
+
+TEST(AcpiInterruptsTest, UnavailableCounterIsIgnored)
+{
+    CAcpiInterruptAccounting accounting([]() -> std::optional<std::uint64_t> {
+        return std::nullopt;
+    });
+    EXPECT_FALSE(accounting.IsAvailable());
+    accounting.Begin();
+    accounting.End(InterruptCause::POLICY);
+    EXPECT_EQ(accounting.Statistics().total, 0u);
+}
+
+} // namespace Test
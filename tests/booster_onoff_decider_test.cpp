@@ -0,0 +1,88 @@
+#include "booster_onoff_decider.h"
+#include "manual_clock.hpp"
+#include "messages_types.h"
+
+#include <chrono>
+#include <cmath>
+#include <optional>
+
+#include <gtest/gtest.h>
+
+/// @brief class BoostersOnOffDecider tests.
+namespace Test {
+
+using namespace std::chrono_literals;
+
+class BoostersOnOffDeciderTest : public ::testing::Test
+{
+  public:
+    void SetUp() override
+    {
+        // Zero sample time means "unknown".
+        CManualClock::Reset(CManualClock::time_point{1s});
+    }
+
+  protected:
+    BoostersOnOffDecider<3, CManualClock> decider;
+    FullInfoBlock info;
+
+    /// @brief Feeds @p temperature read now, applies the orders as daemon would do.
+    BoostersStates Feed(float temperature)
+    {
+        info.info.cpu.SetTemperatureMilli(static_cast<std::int32_t>(std::lround(temperature * 1000)));
+        info.info.cpu.SetSampledAt<CManualClock>(CManualClock::now());
+        const auto res = decider.ComputeUpdatedBoosterStates(info);
+        if (res.cpuTurboBoostState != CpuTurboBoostState::NO_CHANGE)
+        {
+            info.boostersStates.cpuTurboBoostState = res.cpuTurboBoostState;
+        }
+        if (res.fanBoosterState != BoosterState::NO_CHANGE)
+        {
+            info.boostersStates.fanBoosterState = res.fanBoosterState;
+        }
+        return res;
+    }
+};
+
+TEST_F(BoostersOnOffDeciderTest, TwentyMinutesSessionRunsInstantly)
+{
+    info.boostersStates.cpuTurboBoostState = CpuTurboBoostState::ON;
+    info.boostersStates.fanBoosterState = BoosterState::OFF;
+
+    // Accelerating heat up: turbo-boost is cut.
+    float temperature = 60.f;
+    for (int second = 0; second < 60 && temperature < 95.f; ++second)
+    {
+        temperature = 60.f + 0.02f * static_cast<float>(second * second);
+        Feed(temperature);
+        CManualClock::Advance(1s);
+    }
+    EXPECT_EQ(info.boostersStates.cpuTurboBoostState, CpuTurboBoostState::OFF);
+    EXPECT_EQ(info.boostersStates.fanBoosterState, BoosterState::ON);
+
+    // Cooling down and staying cold for the rest of the session: turbo-boost is back.
+    for (; CManualClock::now().time_since_epoch() < 20min; CManualClock::Advance(1s))
+    {
+        temperature = std::max(60.f, temperature - 0.5f);
+        Feed(temperature);
+    }
+    EXPECT_EQ(info.boostersStates.cpuTurboBoostState, CpuTurboBoostState::ON);
+    EXPECT_EQ(info.boostersStates.fanBoosterState, BoosterState::OFF);
+}
+
+TEST_F(BoostersOnOffDeciderTest, RepeatedReadingIsIgnored)
+{
+    info.boostersStates.cpuTurboBoostState = CpuTurboBoostState::ON;
+    info.boostersStates.fanBoosterState = BoosterState::OFF;
+    info.info.gpu.temperature = 80;
+    info.info.gpu.SetSampledAt<CManualClock>(CManualClock::now());
+
+    // GPU is read once, CPU 3 times: GPU average is not complete yet.
+    for (int i = 0; i < 3; ++i)
+    {
+        Feed(50.f);
+        CManualClock::Advance(1s);
+    }
+    EXPECT_EQ(info.boostersStates.fanBoosterState, BoosterState::OFF);
+}
+} // namespace Test
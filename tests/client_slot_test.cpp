@@ -0,0 +1,72 @@
+#include "client_slot.h"
+
+#include <chrono>
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+/// @brief class CClientSlot tests.
+namespace Test {
+
+class ClientSlotTest : public ::testing::Test
+{
+  public:
+    // NOLINTNEXTLINE
+    alignas(64) char memory[CClientSlot::kSize]{};
+    CClientSlot slot{memory};
+    CClientSlot::TimePoint now = CClientSlot::TimePoint{} + std::chrono::hours(1);
+};
+
+TEST_F(ClientSlotTest, ClaimIsExclusiveUntilReleased)
+{
+    EXPECT_FALSE(slot.IsClaimed());
+    EXPECT_TRUE(slot.TryClaim(1, now));
+    EXPECT_FALSE(slot.TryClaim(2, now));
+    EXPECT_TRUE(slot.IsOwnedBy(1));
+
+    slot.RequestPeriod(500);
+    EXPECT_EQ(slot.RequestedPeriodMs(), 500u);
+
+    slot.Release(2);
+    EXPECT_TRUE(slot.IsOwnedBy(1));
+    slot.Release(1);
+    EXPECT_FALSE(slot.IsClaimed());
+    EXPECT_EQ(slot.RequestedPeriodMs(), 0u);
+}
+
+TEST_F(ClientSlotTest, StaleClientIsReclaimedAndRingContinues)
+{
+    ASSERT_TRUE(slot.TryClaim(1, now));
+    const auto ring = slot.Requests();
+    const std::uint32_t message = 42;
+    ASSERT_EQ(ring.TryPush(message), 1u);
+
+    EXPECT_FALSE(slot.ReclaimIfStale(now + CClientSlot::kHeartbeatTimeout / 2));
+    slot.Heartbeat(now + CClientSlot::kHeartbeatTimeout / 2);
+    EXPECT_FALSE(slot.ReclaimIfStale(now + CClientSlot::kHeartbeatTimeout));
+    EXPECT_TRUE(slot.ReclaimIfStale(now + 2 * CClientSlot::kHeartbeatTimeout));
+    EXPECT_FALSE(slot.IsClaimed());
+
+    // New owner continues counters, so completion sequence stays meaningful.
+    ASSERT_TRUE(slot.TryClaim(2, now + 2 * CClientSlot::kHeartbeatTimeout));
+    EXPECT_EQ(ring.TryPush(message), 2u);
+}
+
+TEST_F(ClientSlotTest, IdleClientSeesLostSlotBeforePush)
+{
+    ASSERT_TRUE(slot.TryClaim(1, now));
+    const auto later = now + 2 * CClientSlot::kHeartbeatTimeout;
+    ASSERT_TRUE(slot.ReclaimIfStale(later));
+    ASSERT_TRUE(slot.TryClaim(2, later));
+
+    // Old owner wakes up: heartbeat goes first, then the check forbids the push.
+    slot.Heartbeat(later);
+    EXPECT_FALSE(slot.IsOwnedBy(1));
+    EXPECT_TRUE(slot.IsOwnedBy(2));
+
+    // Refreshed heartbeat keeps the slot.
+    EXPECT_FALSE(slot.ReclaimIfStale(later + CClientSlot::kHeartbeatTimeout / 2));
+    EXPECT_TRUE(slot.IsOwnedBy(2));
+}
+
+} // namespace Test
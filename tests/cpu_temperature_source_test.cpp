@@ -0,0 +1,66 @@
+#include "cpu_temperature_source.h"
+
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+
+#include <gtest/gtest.h>
+
+/// @brief coretemp hwmon lookup tests.
+namespace Test {
+
+class CpuTemperatureSourceTest : public ::testing::Test
+{
+  public:
+    std::filesystem::path root =
+      std::filesystem::temp_directory_path()
+      / ("msi_hwmon_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+
+    void SetUp() override
+    {
+        std::filesystem::remove_all(root);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(root);
+    }
+
+    void Put(const std::filesystem::path &file, const std::string &text) const
+    {
+        std::filesystem::create_directories((root / file).parent_path());
+        std::ofstream(root / file) << text;
+    }
+};
+
+TEST_F(CpuTemperatureSourceTest, ParsesMilliCelsius)
+{
+    EXPECT_EQ(ParseHwmonMilliCelsius("45500\n"), 45500);
+    EXPECT_EQ(ParseHwmonMilliCelsius("-1000"), -1000);
+    EXPECT_EQ(ParseHwmonMilliCelsius(""), std::nullopt);
+    EXPECT_EQ(ParseHwmonMilliCelsius("N/A"), std::nullopt);
+}
+
+TEST_F(CpuTemperatureSourceTest, PrefersPackageSensorOfCoretemp)
+{
+    Put("hwmon0/name", "acpitz\n");
+    Put("hwmon0/temp1_input", "27800\n");
+    Put("hwmon1/name", "coretemp\n");
+    Put("hwmon1/temp1_input", "50000\n");
+    Put("hwmon1/temp2_label", "Core 0\n");
+    Put("hwmon1/temp3_label", "Package id 0\n");
+    Put("hwmon1/temp3_input", "51000\n");
+    EXPECT_EQ(FindCoretempInput(root), root / "hwmon1/temp3_input");
+}
+
+TEST_F(CpuTemperatureSourceTest, FallsBackToFirstSensorOrNothing)
+{
+    EXPECT_TRUE(FindCoretempInput(root).empty());
+
+    Put("hwmon2/name", "coretemp\n");
+    Put("hwmon2/temp1_input", "50000\n");
+    EXPECT_EQ(FindCoretempInput(root), root / "hwmon2/temp1_input");
+}
+
+} // namespace Test
@@ -0,0 +1,35 @@
+#include "daemon_stats.h"
+
+#include <chrono>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+/// @brief class CDaemonStats tests.
+namespace Test {
+
+using namespace std::chrono_literals;
+
+TEST(DaemonStatsTest, HistogramsAndOverruns)
+{
+    std::vector<char> memory(kStatsSharedMemSize, 0);
+    const CDaemonStats stats(memory.data(), memory.size());
+
+    stats.Record(CyclePhase::EC_READ, 3us);
+    stats.Record(CyclePhase::EC_READ, 3us);
+    stats.Record(CyclePhase::EC_READ, 900us);
+    stats.Record(CyclePhase::CYCLE, 1ms);
+    stats.Record(CyclePhase::CYCLE, CDaemonStats::kCycleBudget + 1ms);
+
+    const auto snapshot = stats.Snapshot();
+    const auto &read = snapshot.phases.at(static_cast<std::size_t>(CyclePhase::EC_READ));
+    EXPECT_EQ(read.count, 3u);
+    EXPECT_EQ(read.sumNs, 906000u);
+    EXPECT_EQ(read.maxNs, 900000u);
+    EXPECT_EQ(read.Quantile(0.5), 4us);
+    EXPECT_EQ(read.Quantile(0.99), 1024us);
+    EXPECT_EQ(snapshot.overruns, 1u);
+    EXPECT_EQ(snapshot.phases.at(static_cast<std::size_t>(CyclePhase::EC_WRITE)).count, 0u);
+}
+
+} // namespace Test
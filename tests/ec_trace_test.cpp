@@ -0,0 +1,139 @@
+#include "device_commands.h"
+#include "ec_trace.h"
+#include "memory_provider.h"
+#include "readwrite.h"
+#include "readwrite_provider.h"
+#include "register_cache.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+/// @brief EC traffic record / replay tests.
+namespace Test {
+
+class EcTraceTest : public ::testing::Test
+{
+  public:
+    std::shared_ptr<MemoryProvider> memory{std::make_shared<MemoryProvider>()};
+
+    /// @returns Trace of the @p body executed over recorder.
+    template <typename taBody>
+    EcTrace Record(const taBody &body)
+    {
+        auto stream = std::make_unique<std::stringstream>();
+        const auto *const recorded = stream.get();
+        const auto recorder = std::make_shared<CRecordingProvider>(memory, std::move(stream));
+        body(recorder);
+
+        std::stringstream copy(recorded->str());
+        return ReadEcTrace(copy);
+    }
+};
+
+TEST_F(EcTraceTest, RecordsAreReadBack)
+{
+    memory->memory[0x68] = 55;
+    const auto trace = Record([](const ReadWriteProviderPtr &provider) {
+        std::array<std::uint8_t, 2> bytes{};
+        provider->ReadBytes(0x68, bytes.data(), 1);
+        bytes = {0x12, 0x34};
+        provider->WriteBytes(0xC8, bytes.data(), bytes.size());
+    });
+
+    ASSERT_EQ(trace.size(), 2u);
+    EXPECT_EQ(trace[0].operation, EcTraceOperation::READ);
+    EXPECT_EQ(trace[0].address, 0x68);
+    EXPECT_EQ(trace[0].values, std::vector<std::uint8_t>{55});
+    EXPECT_EQ(trace[1].operation, EcTraceOperation::WRITE);
+    EXPECT_EQ(trace[1].address, 0xC8);
+    EXPECT_EQ(trace[1].values, (std::vector<std::uint8_t>{0x12, 0x34}));
+    EXPECT_LE(trace[0].timestamp, trace[1].timestamp);
+
+    const auto stats = SummarizeEcTrace(trace);
+    EXPECT_EQ(stats.readCalls, 1u);
+    EXPECT_EQ(stats.writeCalls, 1u);
+    EXPECT_EQ(stats.Transactions(), 3u);
+}
+
+TEST_F(EcTraceTest, TruncatedTraceIsRejected)
+{
+    std::stringstream stream;
+    WriteEcTraceHeader(stream);
+    WriteEcTraceRecord(stream, {EcTraceOperation::READ, 0x68, {}, {}, {1, 2, 3}});
+    auto text = stream.str();
+    text.pop_back();
+    std::stringstream truncated(text);
+    EXPECT_THROW(ReadEcTrace(truncated), std::runtime_error);
+}
+
+TEST_F(EcTraceTest, ReplayFollowsRecordedTime)
+{
+    using namespace std::chrono_literals;
+    const EcTrace trace{
+      {EcTraceOperation::READ, 0x68, 0ms, {}, {40}},
+      {EcTraceOperation::READ, 0x68, 500ms, {}, {45}},
+      {EcTraceOperation::READ, 0x68, 1000ms, {}, {50}},
+    };
+    CReplayProvider replay(trace);
+    std::uint8_t value = 0;
+
+    replay.ReadBytes(0x68, &value, 1);
+    EXPECT_EQ(value, 40);
+    replay.AdvanceTo(700ms);
+    replay.ReadBytes(0x68, &value, 1);
+    EXPECT_EQ(value, 45);
+
+    value = 99;
+    replay.WriteBytes(0x68, &value, 1);
+    replay.ReadBytes(0x68, &value, 1);
+    EXPECT_EQ(value, 99);
+
+    replay.AdvanceTo(replay.Duration());
+    replay.ReadBytes(0x68, &value, 1);
+    EXPECT_EQ(value, 50);
+    EXPECT_TRUE(replay.Finished());
+    EXPECT_EQ(replay.Statistics().Transactions(), 5u);
+}
+
+TEST_F(EcTraceTest, ReplayMeasuresTransactionsOfTheBuild)
+{
+    memory->memory[0x72] = 50;
+    memory->memory[0x73] = 60;
+    AddressedValueAnyList curve{AddressedValue1B{0x72, 0}, AddressedValue1B{0x73, 0}};
+
+    // Recorded workload: 3 reads of the curve without any caching, 1 record per read.
+    const auto trace = Record([&curve](const ReadWriteProviderPtr &provider) {
+        CReadWrite readWrite(provider, nullptr);
+        for (int i = 0; i < 3; ++i)
+        {
+            readWrite.Read(curve);
+        }
+    });
+    ASSERT_EQ(trace.size(), 3u);
+    EXPECT_EQ(SummarizeEcTrace(trace).Transactions(), 6u);
+
+    // Same workload replayed by code which caches static registers.
+    const auto replay = std::make_shared<CReplayProvider>(trace);
+    CReadWrite readWrite(replay, nullptr);
+    readWrite.ClassifyRegisters(curve, RegisterClass::STATIC);
+    for (int i = 0; i < 3; ++i)
+    {
+        replay->AdvanceTo(trace.at(static_cast<std::size_t>(i)).timestamp);
+        readWrite.Read(curve);
+        EXPECT_EQ(std::get<AddressedValue1B>(curve[0]).value, 50);
+        EXPECT_EQ(std::get<AddressedValue1B>(curve[1]).value, 60);
+    }
+    EXPECT_EQ(replay->Statistics().Transactions(), 2u);
+    EXPECT_EQ(replay->RecordedStatistics().Transactions(), 6u);
+}
+
+} // namespace Test
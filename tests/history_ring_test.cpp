@@ -0,0 +1,54 @@
+#include "history_ring.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+/// @brief class CHistoryRing tests.
+namespace Test {
+
+class HistoryRingTest : public ::testing::Test
+{
+  public:
+    static constexpr std::size_t kCapacity = 5;
+    std::vector<char> memory =
+      std::vector<char>(CHistoryRing<std::uint32_t>::RequiredSize(kCapacity), 0);
+    CHistoryRing<std::uint32_t> ring{memory.data(), memory.size()};
+};
+
+TEST_F(HistoryRingTest, ReadsOnlyNewSamples)
+{
+    ASSERT_EQ(ring.Capacity(), kCapacity);
+    std::vector<std::uint32_t> out;
+    EXPECT_EQ(ring.ReadSince(0, out), 0u);
+    EXPECT_TRUE(out.empty());
+
+    ring.Append(10);
+    ring.Append(11);
+    auto next = ring.ReadSince(0, out);
+    EXPECT_EQ(out, (std::vector<std::uint32_t>{10, 11}));
+
+    ring.Append(12);
+    out.clear();
+    next = ring.ReadSince(next, out);
+    EXPECT_EQ(out, (std::vector<std::uint32_t>{12}));
+    EXPECT_EQ(next, 3u);
+}
+
+TEST_F(HistoryRingTest, LateReaderGetsLastCapacitySamples)
+{
+    for (std::uint32_t i = 0; i < 3 * kCapacity + 2; ++i)
+    {
+        ring.Append(i);
+    }
+    std::vector<std::uint32_t> out;
+    EXPECT_EQ(ring.ReadSince(0, out), 3 * kCapacity + 2);
+    EXPECT_EQ(out, (std::vector<std::uint32_t>{12, 13, 14, 15, 16}));
+
+    out.clear();
+    ring.ReadSince(15, out);
+    EXPECT_EQ(out, (std::vector<std::uint32_t>{15, 16}));
+}
+} // namespace Test
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "readwrite_provider.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Test {
+
+/// @brief In-memory "EC" which counts accesses, shared by the tests.
+class MemoryProvider : public IReadWriteProvider
+{
+  public:
+    void ReadBytes(std::int64_t offset, std::uint8_t *buffer, std::size_t size) const override
+    {
+        ++reads;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            buffer[i] = memory.at(static_cast<std::size_t>(offset) + i);
+        }
+    }
+
+    void WriteBytes(std::int64_t offset, const std::uint8_t *buffer, std::size_t size) const override
+    {
+        ++writes;
+        writtenBytes += size;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            memory.at(static_cast<std::size_t>(offset) + i) = buffer[i];
+        }
+    }
+
+    mutable std::array<std::uint8_t, 256> memory{};
+    mutable std::size_t reads{0};
+    mutable std::size_t writes{0};
+    mutable std::size_t writtenBytes{0};
+};
+
+} // namespace Test
@@ -0,0 +1,68 @@
+#include "acpi_interrupts.h"
+#include "ec_trace.h"
+#include "messages_types.h"
+#include "openmetrics.h"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include <gtest/gtest.h>
+
+/// @brief FormatOpenMetrics() tests.
+namespace Test {
+
+TEST(OpenMetricsTest, FormatsStateAndReusesBuffer)
+{
+    FullInfoBlock info;
+    info.tag = 7;
+    info.info.cpu.temperature = 65;
+    info.info.gpu.fanRPM = 2400;
+    info.boostersStates.fanBoosterState = BoosterState::ON;
+    info.battery = Battery(Battery::BatteryLevels::Balanced);
+
+    EcTrafficStatistics ec;
+    ec.Account(EcTraceOperation::READ, 3);
+
+    DaemonLoopStatistics loop;
+    loop.Account(std::chrono::milliseconds(2));
+
+    std::string text;
+    FormatOpenMetrics(info, ec, loop, nullptr, text);
+    EXPECT_NE(text.find("msifan_temperature_celsius{sensor=\"cpu\"} 65\n"), std::string::npos);
+    EXPECT_NE(text.find("msifan_fan_rpm{fan=\"gpu\"} 2400\n"), std::string::npos);
+    EXPECT_NE(text.find("msifan_cooler_boost 1\n"), std::string::npos);
+    EXPECT_NE(text.find("msifan_cpu_turbo_boost -1\n"), std::string::npos);
+    EXPECT_NE(text.find("msifan_battery_mode_info{mode=\"balanced\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("msifan_ec_transactions_total{operation=\"read\"} 3\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("msifan_loop_cycle_seconds_count 1\n"), std::string::npos);
+    ASSERT_GE(text.size(), 6u);
+    EXPECT_EQ(text.substr(text.size() - 6), "# EOF\n");
+
+    // The same state gives the same text, buffer does not grow.
+    const auto capacity = text.capacity();
+    const auto copy = text;
+    FormatOpenMetrics(info, ec, loop, nullptr, text);
+    EXPECT_EQ(text, copy);
+    EXPECT_EQ(text.capacity(), capacity);
+    EXPECT_EQ(text.find("msifan_acpi"), std::string::npos);
+}
+
+TEST(OpenMetricsTest, FormatsAcpiInterrupts)
+{
+    AcpiInterruptStatistics acpi;
+    acpi.total = 40;
+    acpi.byCause.at(static_cast<std::size_t>(InterruptCause::POLICY)) = 3;
+    acpi.byRegisterClass.at(RegisterClassIndex(RegisterClass::FAST_SENSOR)) = 12;
+
+    std::string text;
+    FormatOpenMetrics(FullInfoBlock{}, EcTrafficStatistics{}, DaemonLoopStatistics{}, &acpi, text);
+    EXPECT_NE(text.find("msifan_acpi_interrupts_total 40\n"), std::string::npos);
+    EXPECT_NE(text.find("msifan_acpi_session_interrupts_total{cause=\"policy\"} 3\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("msifan_acpi_read_interrupts_total{register_class=\"fast_sensor\"} 12\n"),
+              std::string::npos);
+}
+
+} // namespace Test
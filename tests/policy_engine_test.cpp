@@ -0,0 +1,32 @@
+#include "messages_types.h"
+#include "policy_engine.h"
+
+#include <gtest/gtest.h>
+
+/// @brief class CPolicyEngine tests.
+namespace Test {
+
+TEST(PolicyEngineTest, DisableRestoresTurboBoost)
+{
+    CPolicyEngine engine;
+    EXPECT_EQ(engine.State(), PolicyState::OFF);
+
+    FullInfoBlock info;
+    info.info.cpu.temperature = 95;
+    info.boostersStates.fanBoosterState = BoosterState::OFF;
+    info.boostersStates.cpuTurboBoostState = CpuTurboBoostState::ON;
+    EXPECT_FALSE(engine.Decide(info).HasAnyChange());
+
+    engine.Enable(info.boostersStates);
+    EXPECT_EQ(engine.State(), PolicyState::ON);
+
+    // Decider did not see any previous state yet, so it does not change turbo-boost.
+    EXPECT_EQ(engine.Decide(info).cpuTurboBoostState, CpuTurboBoostState::NO_CHANGE);
+
+    const auto restore = engine.Disable();
+    EXPECT_EQ(engine.State(), PolicyState::OFF);
+    EXPECT_EQ(restore.cpuTurboBoostState, CpuTurboBoostState::ON);
+    EXPECT_EQ(restore.fanBoosterState, BoosterState::NO_CHANGE);
+    EXPECT_FALSE(engine.Disable().HasAnyChange());
+}
+} // namespace Test
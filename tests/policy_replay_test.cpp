@@ -0,0 +1,107 @@
+#include "messages_types.h"
+#include "policy_replay.h"
+
+#include <chrono>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+/// @brief Policy replay tests.
+namespace Test {
+
+using namespace std::chrono_literals;
+
+TEST(PolicyReplayTest, ReadsWatchTextTrace)
+{
+    std::istringstream input("# steady_ms cpu_temp cpu_rpm gpu_temp gpu_rpm fan_booster turbo\n"
+                             "1000 60 2000 50 1800 off on\n"
+                             "2000 61 2000 51 1800 on off\n"
+                             "2000 99 2000 51 1800 on off\n"
+                             "garbage\n"
+                             "3000 62 2100 52 1900 off unknown\n");
+    const auto trace = ReadTelemetryTrace(input, false);
+    ASSERT_EQ(trace.size(), 2u);
+    EXPECT_EQ(trace[0].steadyTimeNs, 1000000000);
+    EXPECT_EQ(trace[0].cpuTemperature, 60);
+    EXPECT_EQ(trace[0].fanBoosterState, BoosterState::OFF);
+    EXPECT_EQ(trace[1].gpuFanRpm, 1800);
+    EXPECT_EQ(trace[1].fanBoosterState, BoosterState::ON);
+    EXPECT_EQ(trace[1].cpuTurboBoostState, CpuTurboBoostState::OFF);
+}
+
+TEST(PolicyReplayTest, CountsTogglesAndTimeAbove)
+{
+    // 10 minutes cold, 10 minutes CPU at 95, 10 minutes cold again.
+    TelemetryTrace trace;
+    for (int second = 1; second <= 1800; ++second)
+    {
+        TelemetrySample sample{};
+        sample.steadyTimeNs = std::chrono::nanoseconds(std::chrono::seconds(second)).count();
+        sample.cpuTemperature = second > 600 && second <= 1200 ? 95 : 50;
+        sample.fanBoosterState = BoosterState::OFF;
+        sample.cpuTurboBoostState = CpuTurboBoostState::ON;
+        trace.push_back(sample);
+    }
+
+    const auto report =
+      ReplayPolicy<3>(trace, {{ReplayThreshold::Sensor::CPU, 91.f},
+                              {ReplayThreshold::Sensor::GPU, 75.f}});
+    EXPECT_EQ(report.samples, trace.size());
+    EXPECT_NEAR(report.traceDuration.count(), 1799., 0.001);
+    EXPECT_EQ(report.boosterToggles, 2u);
+    ASSERT_EQ(report.timeAbove.size(), 2u);
+    EXPECT_NEAR(report.timeAbove[0].second.count(), 600., 0.001);
+    EXPECT_NEAR(report.timeAbove[1].second.count(), 0., 0.001);
+    // Average of 3 samples delays switching both ways.
+    EXPECT_NEAR(report.boosterOnTime.count(), 600., 3.);
+    EXPECT_EQ(ReplayPolicy(3, trace).boosterToggles, report.boosterToggles);
+    EXPECT_THROW(ReplayPolicy(0, trace), std::invalid_argument);
+}
+
+TEST(PolicyReplayTest, ReactionDelayIsInTraceTime)
+{
+    // GPU steps from 50 to 80 twice and stays there for a minute. CPU is cold, so turbo is kept and
+    // only averaged booster's decision answers.
+    const auto makeStepTrace = [](std::chrono::milliseconds period) {
+        TelemetryTrace trace;
+        for (auto time = period; time <= 400s; time += period)
+        {
+            TelemetrySample sample{};
+            sample.steadyTimeNs = std::chrono::nanoseconds(time).count();
+            const bool hot = (time > 100s && time <= 160s) || (time > 300s && time <= 360s);
+            sample.cpuTemperature = 50;
+            sample.gpuTemperature = hot ? 80 : 50;
+            sample.fanBoosterState = BoosterState::OFF;
+            sample.cpuTurboBoostState = CpuTurboBoostState::ON;
+            trace.push_back(sample);
+        }
+        return trace;
+    };
+    const std::vector<ReplayThreshold> thresholds{{ReplayThreshold::Sensor::CPU, 91.f},
+                                                  {ReplayThreshold::Sensor::GPU, 75.f}};
+
+    // Average of 3 samples needs 2 more samples after the step.
+    const auto slow = ReplayPolicy<3>(makeStepTrace(1s), thresholds);
+    ASSERT_EQ(slow.reactions.size(), 2u);
+    EXPECT_EQ(slow.reactions[0].crossings, 0u);
+    EXPECT_EQ(slow.reactions[0].answered, 0u);
+    const auto &gpu = slow.reactions[1];
+    EXPECT_EQ(gpu.crossings, 2u);
+    EXPECT_EQ(gpu.answered, 2u);
+    EXPECT_NEAR(gpu.MeanDelay().count(), 2., 0.001);
+    EXPECT_NEAR(gpu.maxDelay.count(), 2., 0.001);
+
+    // The same samples, twice as often: delay is measured on the trace's clock.
+    const auto fast = ReplayPolicy<3>(makeStepTrace(500ms), thresholds);
+    EXPECT_EQ(fast.reactions[1].answered, 2u);
+    EXPECT_NEAR(fast.reactions[1].MeanDelay().count(), 1., 0.001);
+}
+
+TEST(PolicyReplayTest, SyntheticTraceHeatsUp)
+{
+    const auto trace = MakeSyntheticTrace(10min, 1s);
+    ASSERT_EQ(trace.size(), 601u);
+    EXPECT_GT(trace.front().steadyTimeNs, 0);
+    EXPECT_GT(trace.back().cpuTemperature, trace.front().cpuTemperature);
+}
+} // namespace Test
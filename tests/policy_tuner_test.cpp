@@ -0,0 +1,103 @@
+#include "policy_parameters.h"
+#include "policy_replay.h"
+#include "policy_tuner.h"
+#include "thermal_plant.h"
+
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+/// @brief PolicyParameters and policy tuner tests.
+namespace Test {
+
+using namespace std::chrono_literals;
+
+TEST(PolicyTunerTest, ParametersFileRoundTrip)
+{
+    PolicyParameters params;
+    params.turboHotDegree = 80.5f;
+    params.gpuLimit = 70.f;
+
+    std::stringstream file;
+    params.Save(file);
+    const auto loaded = PolicyParameters::Load(file);
+    EXPECT_FLOAT_EQ(loaded.turboHotDegree, 80.5f);
+    EXPECT_FLOAT_EQ(loaded.gpuLimit, 70.f);
+    EXPECT_FLOAT_EQ(loaded.cpuOnlyLimit, PolicyParameters{}.cpuOnlyLimit);
+
+    std::istringstream partial("# comment\n\ncpu_only_limit = 88 # hot\n");
+    EXPECT_FLOAT_EQ(PolicyParameters::Load(partial).cpuOnlyLimit, 88.f);
+
+    std::istringstream unknown("cpu_limit = 88\n");
+    EXPECT_THROW(PolicyParameters::Load(unknown), std::invalid_argument);
+    std::istringstream malformed("gpu_limit = hot\n");
+    EXPECT_THROW(PolicyParameters::Load(malformed), std::invalid_argument);
+    std::istringstream inverted("turbo_cold_degree = 90\n");
+    EXPECT_THROW(PolicyParameters::Load(inverted), std::invalid_argument);
+}
+
+TEST(PolicyTunerTest, FitRecoversLoad)
+{
+    const LoadProfile profile = {{300s, 40.f, 20.f}, {300s, 10.f, 50.f}};
+    const auto trace = MakeSyntheticTrace(10min, 1s, {}, profile);
+    const auto model = FitThermalModel({trace}, 60s, {}, ThermalPlantParameters{}.ambient);
+
+    ASSERT_GE(model.profile.size(), 9u);
+    EXPECT_NEAR(model.ProfileDuration().count(), 600000, 1000);
+    // Temperatures are whole degrees, so power is approximate. Window in the middle of the load.
+    EXPECT_NEAR(model.profile.at(2).cpuPower, 40.f, 6.f);
+    EXPECT_NEAR(model.profile.at(2).gpuPower, 20.f, 6.f);
+    EXPECT_NEAR(model.profile.at(7).cpuPower, 10.f, 6.f);
+    EXPECT_NEAR(model.profile.at(7).gpuPower, 50.f, 6.f);
+
+    EXPECT_THROW(FitThermalModel({}), std::invalid_argument);
+    // Room temperature is guessed, laptop is a bit warmer.
+    EXPECT_LT(FitThermalModel({trace}).plant.ambient, ThermalPlantParameters{}.ambient);
+}
+
+TEST(PolicyTunerTest, TunerDoesNotMakeItWorseAndIsReproducible)
+{
+    FittedThermalModel hot;
+    hot.plant.ambient = 40.f;
+    hot.profile = {{120s, 10.f, 5.f}, {600s, 80.f, 70.f}};
+
+    TunerOptions options;
+    options.duration = 15min;
+    options.candidates = 16;
+    options.threads = 1;
+    const auto single = TunePolicy(hot, options);
+    EXPECT_EQ(single.evaluated, 33u);
+    EXPECT_LE(single.best.score, single.start.score);
+    EXPECT_TRUE(single.best.params.IsValid());
+
+    options.threads = 4;
+    const auto parallel = TunePolicy(hot, options);
+    EXPECT_DOUBLE_EQ(parallel.best.score, single.best.score);
+    EXPECT_FLOAT_EQ(parallel.best.params.turboHotDegree, single.best.params.turboHotDegree);
+}
+
+TEST(PolicyTunerTest, ClosedLoopBoosterCools)
+{
+    FittedThermalModel hot;
+    hot.plant.ambient = 40.f;
+    hot.profile = {{600s, 60.f, 5.f}};
+
+    // GPU reports temperature, so it is "active" for the decider.
+    PolicyParameters never;
+    never.cpuLimitWithGpu = 100.f;
+    never.gpuLimit = 95.f;
+    never.turboHotDegree = 100.f;
+    never.turboColdDegree = 95.f;
+    PolicyParameters early;
+    early.cpuLimitWithGpu = 70.f;
+
+    const std::vector<ReplayThreshold> overheat = {{ReplayThreshold::Sensor::CPU, 95.f}};
+    const auto idle = SimulatePolicy(hot, never, 10min, 1s, overheat);
+    const auto boosted = SimulatePolicy(hot, early, 10min, 1s, overheat);
+    EXPECT_EQ(idle.boosterToggles, 0u);
+    EXPECT_GT(boosted.boosterOnTime.count(), 0.);
+    EXPECT_LT(boosted.timeAbove.at(0).second.count(), idle.timeAbove.at(0).second.count());
+}
+} // namespace Test
@@ -0,0 +1,88 @@
+#include "device_commands.h"
+#include "read_plan.h"
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+/// @brief class CReadPlan tests.
+namespace Test {
+
+enum class TestState : std::uint8_t {
+    ONE,
+    TWO,
+    IGNORE
+};
+
+class ReadPlanTest : public ::testing::Test
+{
+  public:
+    /// @brief Emulates executor: "reads" bytes out of the map for all planned addresses.
+    static void Execute(const CReadPlan &plan, const std::map<std::int64_t, std::uint8_t> &memory)
+    {
+        std::vector<std::uint8_t> bytes;
+        for (const auto address : plan.Addresses())
+        {
+            bytes.push_back(memory.at(address));
+        }
+        plan.Distribute(bytes);
+    }
+};
+
+TEST_F(ReadPlanTest, AddressesAreSortedAndUnique)
+{
+    AddressedValueAnyList list{
+      AddressedValue1B{0x80, 0},
+      AddressedValue2B{0x68, 0},
+      AddressedValue1B{0x69, 0},
+    };
+    AddressedValueStates<TestState> states{{
+      {TestState::ONE, AddressedBits{0x98, 0x80, 0}},
+      {TestState::TWO, AddressedBits{0x98, 0x80, 0x80}},
+      {TestState::IGNORE, TagIgnore{}},
+    }};
+
+    CReadPlan plan;
+    plan.Add(list).Add(states);
+
+    const std::vector<std::int64_t> expected{0x68, 0x69, 0x80, 0x98};
+    EXPECT_EQ(plan.Addresses(), expected);
+    EXPECT_EQ(plan.TargetsCount(), 6u);
+
+    std::vector<std::pair<std::int64_t, std::size_t>> runs;
+    plan.ForEachRun([&runs](std::int64_t start, std::size_t count) {
+        runs.emplace_back(start, count);
+    });
+    const std::vector<std::pair<std::int64_t, std::size_t>> expectedRuns{
+      {0x68, 2}, {0x80, 1}, {0x98, 1}};
+    EXPECT_EQ(runs, expectedRuns);
+}
+
+TEST_F(ReadPlanTest, ValuesAreFannedOut)
+{
+    AddressedValueAnyList list{
+      AddressedValue2B{0xC8, 0},
+      AddressedValue1B{0xC9, 0},
+    };
+    AddressedValueStates<TestState> states{{
+      {TestState::ONE, AddressedBits{0x98, 0x80, 0}},
+      {TestState::TWO, AddressedBits{0x98, 0x80, 0x80}},
+      {TestState::IGNORE, TagIgnore{}},
+    }};
+    AddressedBits single{0xEF, 0x7F, 0};
+
+    CReadPlan plan;
+    plan.Add(list).Add(states).AddOne(single);
+    Execute(plan, {{0xC8, 0x12}, {0xC9, 0x34}, {0x98, 0x8D}, {0xEF, 0xD0}});
+
+    // Big endian as python code reads it.
+    EXPECT_EQ(std::get<AddressedValue2B>(list.at(0)).value, 0x1234);
+    EXPECT_EQ(std::get<AddressedValue1B>(list.at(1)).value, 0x34);
+    EXPECT_EQ(std::get<AddressedBits>(states.at(TestState::ONE)).value, 0x80);
+    EXPECT_EQ(std::get<AddressedBits>(states.at(TestState::TWO)).value, 0x80);
+    EXPECT_EQ(single.value, 0x50);
+}
+
+} // namespace Test
@@ -0,0 +1,115 @@
+#include "device_commands.h"
+#include "memory_provider.h"
+#include "readwrite.h"
+#include "readwrite_provider.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+/// @brief class CReadWrite tests.
+namespace Test {
+
+class ReadWriteTest : public ::testing::Test
+{
+  public:
+    std::shared_ptr<MemoryProvider> provider{std::make_shared<MemoryProvider>()};
+    CReadWrite readWrite{provider, nullptr};
+};
+
+TEST_F(ReadWriteTest, WritesAreFlushedOnDestroy)
+{
+    {
+        auto handle = readWrite.StartWritting();
+        readWrite.Write(handle, {AddressedValue2B{0xC8, 0x1234}});
+        EXPECT_EQ(provider->writes, 0u);
+    }
+    EXPECT_EQ(provider->memory[0xC8], 0x12);
+    EXPECT_EQ(provider->memory[0xC9], 0x34);
+    EXPECT_EQ(provider->writes, 1u);
+}
+
+TEST_F(ReadWriteTest, BitsToTheSameByteAreFolded)
+{
+    provider->memory[0x98] = 0x0F;
+    auto handle = readWrite.StartWritting();
+    readWrite.Write(handle, {AddressedBits{0x98, 0x80, 0x80}});
+    readWrite.Write(handle, {AddressedBits{0x98, 0x01, 0x00}});
+    readWrite.Commit(handle);
+
+    EXPECT_EQ(provider->memory[0x98], 0x8E);
+    EXPECT_EQ(provider->reads, 1u);
+    EXPECT_EQ(provider->writes, 1u);
+}
+
+TEST_F(ReadWriteTest, UnchangedValuesAreNotWritten)
+{
+    provider->memory[0x72] = 10;
+    provider->memory[0x73] = 20;
+    provider->memory[0x98] = 0x80;
+
+    AddressedValueAnyList curve{AddressedValue1B{0x72, 0}, AddressedValue1B{0x73, 0}};
+    readWrite.Read(curve);
+
+    auto handle = readWrite.StartWritting();
+    readWrite.Write(handle, {AddressedValue1B{0x72, 10}, AddressedValue1B{0x73, 21},
+                             AddressedBits{0x98, 0x80, 0x80}});
+    readWrite.Commit(handle);
+
+    EXPECT_EQ(provider->memory[0x73], 21);
+    EXPECT_EQ(provider->writes, 1u);
+    EXPECT_EQ(provider->writtenBytes, 1u);
+}
+
+TEST_F(ReadWriteTest, ClassifiedRegistersAreCachedUntilWritten)
+{
+    provider->memory[0x72] = 10;
+    AddressedValueAnyList curve{AddressedValue1B{0x72, 0}};
+    readWrite.ClassifyRegisters(curve, RegisterClass::STATIC);
+
+    readWrite.Read(curve);
+    readWrite.Read(curve);
+    EXPECT_EQ(provider->reads, 1u);
+
+    {
+        auto handle = readWrite.StartWritting();
+        readWrite.Write(handle, {AddressedValue1B{0x72, 11}});
+    }
+    readWrite.Read(curve);
+    EXPECT_EQ(provider->reads, 2u);
+    EXPECT_EQ(std::get<AddressedValue1B>(curve.front()).value, 11);
+}
+
+TEST_F(ReadWriteTest, SensorsAreFreshOnEachDaemonCycle)
+{
+    using namespace std::chrono_literals;
+    provider->memory[0x68] = 50;
+    AddressedValueAnyList temperature{AddressedValue1B{0x68, 0}};
+    readWrite.ClassifyRegisters(temperature, RegisterClass::FAST_SENSOR);
+
+    // Reads of the same cycle share value and its acquisition time.
+    readWrite.Read(temperature);
+    const auto first = readWrite.AcquiredAt(temperature);
+    provider->memory[0x68] = 60;
+    readWrite.Read(temperature);
+    EXPECT_EQ(provider->reads, 1u);
+    EXPECT_EQ(readWrite.AcquiredAt(temperature), first);
+
+    // Next cycle of the fastest daemon's schedule (burst, 250ms) gets new value.
+    std::this_thread::sleep_for(250ms);
+    readWrite.Read(temperature);
+    EXPECT_EQ(provider->reads, 2u);
+    EXPECT_EQ(std::get<AddressedValue1B>(temperature.front()).value, 60);
+    const auto second = readWrite.AcquiredAt(temperature);
+    ASSERT_TRUE(first && second);
+    EXPECT_GE(*second - *first, 250ms);
+
+    // Unclassified bytes have no known acquisition time.
+    EXPECT_FALSE(readWrite.AcquiredAt(AddressedValueAnyList{AddressedValue1B{0x69, 0}}));
+}
+
+} // namespace Test
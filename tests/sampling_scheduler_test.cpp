@@ -0,0 +1,103 @@
+#include "sampling_scheduler.h"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+/// @brief class CSamplingScheduler tests.
+namespace Test {
+
+using namespace std::chrono_literals;
+
+TEST(SamplingSchedulerTest, StableReadingsBackOff)
+{
+    CSamplingScheduler scheduler;
+    auto now = CSamplingScheduler::TimePoint{} + 1h;
+    EXPECT_TRUE(scheduler.IsDue(now));
+
+    scheduler.OnClientRequest(now);
+    scheduler.OnSample(now, 64.f);
+    const auto first = scheduler.Interval(now);
+    EXPECT_FALSE(scheduler.IsDue(now));
+
+    CSamplingScheduler::Duration previous = first;
+    for (int i = 0; i < 3; ++i)
+    {
+        now += previous;
+        EXPECT_TRUE(scheduler.IsDue(now));
+        scheduler.OnClientRequest(now);
+        scheduler.OnSample(now, 64.f);
+        EXPECT_GT(scheduler.Interval(now), previous);
+        previous = scheduler.Interval(now);
+    }
+    EXPECT_LE(previous, CSamplingScheduler::kMaxActiveInterval);
+
+    // Nobody is connected anymore, limit is longer.
+    now += CSamplingScheduler::kClientTimeout;
+    EXPECT_GE(scheduler.Interval(now), previous);
+    EXPECT_LE(scheduler.Interval(now), CSamplingScheduler::kMaxIdleInterval);
+}
+
+TEST(SamplingSchedulerTest, HotPlateauDoesNotBackOff)
+{
+    CSamplingScheduler scheduler;
+    auto now = CSamplingScheduler::TimePoint{} + 1h;
+    scheduler.OnSample(now, 80.f);
+    const auto hot = scheduler.Interval(now);
+    for (int i = 0; i < 10; ++i)
+    {
+        now += scheduler.Interval(now);
+        scheduler.OnClientRequest(now);
+        scheduler.OnSample(now, 80.f);
+        EXPECT_EQ(scheduler.Interval(now), hot);
+    }
+
+    // Step from the plateau is seen within base interval and starts the burst.
+    now += scheduler.Interval(now);
+    scheduler.OnSample(now, 90.f);
+    EXPECT_EQ(scheduler.Interval(now), CSamplingScheduler::kBurstInterval);
+}
+
+TEST(SamplingSchedulerTest, PolicyKeepsBaseInterval)
+{
+    CSamplingScheduler scheduler;
+    scheduler.SetPolicyEnabled(true);
+    auto now = CSamplingScheduler::TimePoint{} + 1h;
+    scheduler.OnSample(now, 50.f);
+    const auto base = scheduler.Interval(now);
+    for (int i = 0; i < 10; ++i)
+    {
+        now += scheduler.Interval(now);
+        scheduler.OnSample(now, 50.f);
+    }
+    EXPECT_EQ(scheduler.Interval(now), base);
+
+    // Disabled policy lets cool CPU back off again.
+    scheduler.SetPolicyEnabled(false);
+    scheduler.OnClientRequest(now);
+    EXPECT_GT(scheduler.Interval(now), base);
+}
+
+TEST(SamplingSchedulerTest, FastRiseStartsBurst)
+{
+    CSamplingScheduler scheduler;
+    auto now = CSamplingScheduler::TimePoint{} + 1h;
+    scheduler.OnSample(now, 45.f);
+    const auto cool = scheduler.Interval(now);
+
+    now += 2s;
+    scheduler.OnSample(now, 60.f);
+    EXPECT_EQ(scheduler.Interval(now), CSamplingScheduler::kBurstInterval);
+    EXPECT_LT(scheduler.Interval(now), cool);
+    EXPECT_EQ(scheduler.TimeToNextSample(now), CSamplingScheduler::kBurstInterval);
+
+    // Burst ends when temperature settles.
+    for (std::size_t i = 0; i < 4 * CSamplingScheduler::kBurstSamples; ++i)
+    {
+        now += scheduler.Interval(now);
+        scheduler.OnSample(now, 60.f);
+    }
+    EXPECT_GT(scheduler.Interval(now), CSamplingScheduler::kBurstInterval);
+}
+
+} // namespace Test
@@ -0,0 +1,77 @@
+#include "seqlock_buffer.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+/// @brief class CSeqlockBuffer tests.
+namespace Test {
+
+class SeqlockBufferTest : public ::testing::Test
+{
+  public:
+    std::vector<char> memory = std::vector<char>(1024, 0);
+    CSeqlockBuffer buffer{memory.data(), memory.size()};
+};
+
+TEST_F(SeqlockBufferTest, NothingIsReadBeforePublish)
+{
+    std::string out;
+    EXPECT_FALSE(buffer.ReadLatest(out));
+}
+
+TEST_F(SeqlockBufferTest, LatestBlobIsRead)
+{
+    const std::string first = "first";
+    const std::string second = "second blob";
+    buffer.Publish(first.data(), first.size());
+    buffer.Publish(second.data(), second.size());
+
+    std::string out;
+    ASSERT_TRUE(buffer.ReadLatest(out));
+    EXPECT_EQ(out, second);
+
+    const std::string tooBig(buffer.Capacity() + 1, 'x');
+    EXPECT_THROW(buffer.Publish(tooBig.data(), tooBig.size()), std::length_error);
+}
+
+TEST_F(SeqlockBufferTest, ReaderNeverSeesTornBlob)
+{
+    std::atomic<bool> stop{false};
+    std::thread writer([this, &stop]() {
+        std::string blob(buffer.Capacity(), 0);
+        for (std::uint8_t value = 0; !stop; ++value)
+        {
+            blob.assign(blob.size(), static_cast<char>(value));
+            buffer.Publish(blob.data(), blob.size());
+        }
+    });
+
+    std::string out;
+    while (!buffer.ReadLatest(out))
+    {
+        std::this_thread::yield();
+    }
+
+    std::size_t consistent = 0;
+    for (int i = 0; i < 20000; ++i)
+    {
+        if (buffer.ReadLatest(out))
+        {
+            ++consistent;
+            ASSERT_EQ(out.size(), buffer.Capacity());
+            ASSERT_EQ(out.find_first_not_of(out.front()), std::string::npos);
+        }
+    }
+    stop = true;
+    writer.join();
+    EXPECT_GT(consistent, 0u);
+}
+
+} // namespace Test
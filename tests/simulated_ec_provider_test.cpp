@@ -0,0 +1,229 @@
+#include "device_commands.h"
+#include "intelgen10.h"
+#include "messages_types.h"
+#include "readwrite.h"
+#include "simulated_ec_provider.h"
+#include "thermal_plant.h"
+#include "turbo_boost_switch.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <variant>
+
+#include <gtest/gtest.h>
+
+/// @brief class CSimulatedEcProvider and CThermalPlant tests.
+namespace Test {
+
+using namespace std::chrono_literals;
+
+class SimulatedEcProviderTest : public ::testing::Test
+{
+  public:
+    /// @brief Steady load, model runs 1000 times faster than real time.
+    static SimulatedEcParameters MakeParameters()
+    {
+        SimulatedEcParameters params;
+        params.loadProfile = {{1h, 60.f, 40.f}};
+        params.perByteLatency = 0us;
+        params.timeScale = 1000.f;
+        return params;
+    }
+
+    std::shared_ptr<CSimulatedEcProvider> ec{
+      std::make_shared<CSimulatedEcProvider>(MakeParameters())};
+    CReadWrite readWrite{ec, nullptr};
+
+    /// @returns CPU & GPU info parsed the same way CDevice does.
+    CpuGpuInfo ReadInfo() const
+    {
+        AddressedValueAnyList cmd{
+          AddressedValue1B{0x68, 0},
+          AddressedValue2B{0xCC, 0},
+          AddressedValue1B{0x80, 0},
+          AddressedValue2B{0xCA, 0},
+        };
+        readWrite.Read(cmd);
+        const auto parse = [&cmd](std::size_t index) {
+            Info res;
+            res.temperature = Info::parseTemp(cmd.at(index));
+            res.fanRPM = Info::parseRPM(cmd.at(index + 1));
+            return res;
+        };
+        return {parse(0), parse(2)};
+    }
+
+    void SetBooster(bool on) const
+    {
+        auto handle = readWrite.StartWritting();
+        const auto value = static_cast<std::uint8_t>(on ? 0x80 : 0);
+        readWrite.Write(handle, {AddressedBits{0x98, 0x80, value}});
+        readWrite.Commit(handle);
+    }
+};
+
+TEST_F(SimulatedEcProviderTest, RegisterMapFollowsModel)
+{
+    const auto info = ReadInfo();
+    const auto plant = ec->Plant();
+    EXPECT_NEAR(info.cpu.temperature, plant.Cpu().temperature, 1.f);
+    EXPECT_NEAR(info.gpu.temperature, plant.Gpu().temperature, 1.f);
+    EXPECT_NEAR(info.cpu.fanRPM, plant.Cpu().Rpm(plant.Parameters().cpu), 50.f);
+    EXPECT_NEAR(info.gpu.fanRPM, plant.Gpu().Rpm(plant.Parameters().gpu), 50.f);
+
+    // Curves are initialized as on the real device.
+    AddressedValueAnyList curve = CpuGpuFanCurve::MakeDefault().cpu;
+    const auto expected = curve;
+    readWrite.Read(curve);
+    EXPECT_EQ(curve, expected);
+}
+
+TEST_F(SimulatedEcProviderTest, TemperatureAndRpmRespond)
+{
+    const auto cold = ReadInfo();
+    std::this_thread::sleep_for(30ms);
+    const auto warm = ReadInfo();
+    EXPECT_GT(warm.cpu.temperature, cold.cpu.temperature);
+    EXPECT_GT(warm.gpu.temperature, cold.gpu.temperature);
+
+    // Cooler boost spins both fans to the max.
+    SetBooster(true);
+    std::uint8_t booster = 0;
+    ec->ReadBytes(0x98, &booster, 1);
+    EXPECT_EQ(booster & 0x80, 0x80);
+    std::this_thread::sleep_for(30ms);
+    const auto boosted = ReadInfo();
+    const auto &params = ec->Plant().Parameters();
+    EXPECT_GT(boosted.cpu.fanRPM, warm.cpu.fanRPM);
+    EXPECT_NEAR(boosted.cpu.fanRPM, params.cpu.maxRpm, 0.05f * params.cpu.maxRpm);
+    EXPECT_NEAR(boosted.gpu.fanRPM, params.gpu.maxRpm, 0.05f * params.gpu.maxRpm);
+
+    SetBooster(false);
+    std::this_thread::sleep_for(30ms);
+    EXPECT_LT(ReadInfo().cpu.fanRPM, boosted.cpu.fanRPM);
+}
+
+TEST_F(SimulatedEcProviderTest, CurveBytesAreFanSpeeds)
+{
+    std::this_thread::sleep_for(10ms);
+    const auto before = ReadInfo();
+
+    // Each step of the curve is raised, so fans must spin faster at any temperature.
+    auto curves = CpuGpuFanCurve::MakeDefault();
+    for (auto *curve : {&curves.cpu, &curves.gpu})
+    {
+        for (auto &value : *curve)
+        {
+            auto &byte = std::get<AddressedValue1B>(value);
+            byte.value = static_cast<std::uint8_t>(byte.value + 20);
+        }
+    }
+    {
+        auto handle = readWrite.StartWritting();
+        readWrite.Write(handle, curves.cpu);
+        readWrite.Write(handle, curves.gpu);
+        readWrite.Commit(handle);
+    }
+    std::this_thread::sleep_for(10ms);
+    const auto after = ReadInfo();
+    EXPECT_GT(after.cpu.fanRPM, before.cpu.fanRPM);
+    EXPECT_GT(after.gpu.fanRPM, before.gpu.fanRPM);
+}
+
+TEST_F(SimulatedEcProviderTest, EachByteCostsLatency)
+{
+    auto params = MakeParameters();
+    params.perByteLatency = 2ms;
+    const CSimulatedEcProvider slow(params);
+
+    std::uint8_t bytes[4]{};
+    const auto started = std::chrono::steady_clock::now();
+    slow.ReadBytes(0xC8, bytes, sizeof(bytes));
+    EXPECT_GE(std::chrono::steady_clock::now() - started, 4 * params.perByteLatency);
+    EXPECT_EQ(slow.TransactionsCount(), sizeof(bytes));
+
+    EXPECT_THROW(slow.ReadBytes(0xFF, bytes, 2), std::out_of_range);
+}
+
+TEST_F(SimulatedEcProviderTest, DeviceDetectsSimulatedRegisters)
+{
+    // Detection checks of the CDevice are active (debug build, not dry run). Fans are stopped yet,
+    // so RPM address is detected by the 0xC8-0xC9 register.
+    const CIntelGen10 device(CReadWrite(ec, nullptr), std::make_shared<CMemoryTurboBoost>());
+    const auto full = device.ReadFullInformation(7);
+
+    EXPECT_EQ(full.tag, 7u);
+    EXPECT_EQ(full.boostersStates.fanBoosterState, BoosterState::OFF);
+    EXPECT_EQ(full.boostersStates.cpuTurboBoostState, CpuTurboBoostState::ON);
+    EXPECT_EQ(full.behaveAndCurve.behaveState, BehaveState::AUTO);
+    EXPECT_EQ(Battery::StateToPercents(full.battery.maxLevel), 80);
+
+    const auto plant = ec->Plant();
+    EXPECT_NEAR(full.info.cpu.temperature, plant.Cpu().temperature, 1.f);
+    EXPECT_NEAR(full.info.cpu.fanRPM, plant.Cpu().Rpm(plant.Parameters().cpu), 50.f);
+    EXPECT_NEAR(full.info.gpu.fanRPM, plant.Gpu().Rpm(plant.Parameters().gpu), 50.f);
+
+    BoostersStates boosters;
+    boosters.fanBoosterState = BoosterState::ON;
+    {
+        auto session = device.StartWrites();
+        device.SetBoosters(boosters, session);
+        device.CommitWrites(session);
+    }
+    // Sensors are cached till the next daemon's cycle.
+    std::this_thread::sleep_for(RegisterRefreshIntervals{}.fastSensor);
+    const auto boosted = device.ReadFullInformation(8);
+    EXPECT_EQ(boosted.boostersStates.fanBoosterState, BoosterState::ON);
+    const auto &params = ec->Plant().Parameters();
+    EXPECT_NEAR(boosted.info.cpu.fanRPM, params.cpu.maxRpm, 0.05f * params.cpu.maxRpm);
+    EXPECT_NEAR(boosted.info.gpu.fanRPM, params.gpu.maxRpm, 0.05f * params.gpu.maxRpm);
+}
+
+TEST(ThermalPlantTest, CoolerBoostLowersSteadyTemperature)
+{
+    const LoadProfile load{{1h, 45.f, 30.f}};
+    CThermalPlant curve({}, load);
+    CThermalPlant boosted({}, load);
+    const auto curves = CpuGpuFanCurve::MakeDefault();
+    CThermalPlant::Curve cpuCurve{};
+    for (std::size_t i = 0; i < cpuCurve.size(); ++i)
+    {
+        cpuCurve.at(i) = std::get<AddressedValue1B>(curves.cpu.at(i)).value;
+    }
+
+    // Ten minutes is many RC time constants.
+    curve.Advance(600.f, cpuCurve, cpuCurve, false);
+    boosted.Advance(600.f, cpuCurve, cpuCurve, true);
+    EXPECT_GT(curve.Cpu().temperature, curve.Parameters().ambient + 5.f);
+    EXPECT_LT(boosted.Cpu().temperature, curve.Cpu().temperature);
+    EXPECT_NEAR(boosted.Cpu().fanFraction, 1.f, 1e-3f);
+
+    // Steady state: heat produced equals heat removed.
+    const auto &node = boosted.Parameters().cpu;
+    const float removed = (boosted.Cpu().temperature - boosted.Parameters().ambient)
+                          * (node.passiveConductance + node.fanConductance);
+    EXPECT_NEAR(removed, 45.f, 0.5f);
+
+    // Faster curve keeps CPU cooler.
+    auto fastCurve = cpuCurve;
+    for (auto &speed : fastCurve)
+    {
+        speed = static_cast<std::uint8_t>(speed + 20);
+    }
+    CThermalPlant fast({}, load);
+    fast.Advance(600.f, fastCurve, fastCurve, false);
+    EXPECT_GT(fast.Cpu().fanFraction, curve.Cpu().fanFraction);
+    EXPECT_LT(fast.Cpu().temperature, curve.Cpu().temperature);
+
+    // Disabled turbo-boost produces less heat.
+    CThermalPlant throttled({}, load);
+    throttled.SetCpuPowerScale(0.5f);
+    throttled.Advance(600.f, cpuCurve, cpuCurve, true);
+    EXPECT_LT(throttled.Cpu().temperature, boosted.Cpu().temperature);
+}
+
+} // namespace Test
@@ -0,0 +1,60 @@
+#include "spsc_ring.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+/// @brief class CSpscRing tests.
+namespace Test {
+
+class SpscRingTest : public ::testing::Test
+{
+  public:
+    std::vector<char> memory = std::vector<char>(2048, 0);
+    CSpscRing ring{memory.data(), memory.size()};
+};
+
+TEST_F(SpscRingTest, FullRingRejectsAndNothingIsLost)
+{
+    ASSERT_EQ(ring.SlotsCount(), 8u);
+    for (std::uint32_t i = 0; i < ring.SlotsCount(); ++i)
+    {
+        const auto text = std::to_string(i);
+        EXPECT_EQ(ring.TryPush(text.data(), text.size()), i + 1);
+    }
+    EXPECT_FALSE(ring.TryPush("x", 1).has_value());
+
+    std::string out;
+    for (std::uint32_t i = 0; i < ring.SlotsCount(); ++i)
+    {
+        ASSERT_TRUE(ring.TryPop(out));
+        EXPECT_EQ(out, std::to_string(i));
+    }
+    EXPECT_FALSE(ring.TryPop(out));
+    EXPECT_EQ(ring.Consumed(), ring.SlotsCount());
+}
+
+TEST_F(SpscRingTest, CountersWrapAround)
+{
+    // Place both counters right before 32 bits overflow.
+    const std::uint32_t nearOverflow = 0xFFFFFFFEu;
+    std::memcpy(memory.data(), &nearOverflow, sizeof(nearOverflow));
+    std::memcpy(memory.data() + 64, &nearOverflow, sizeof(nearOverflow));
+
+    std::string out;
+    for (int i = 0; i < 5; ++i)
+    {
+        const auto text = std::to_string(i);
+        const auto sequence = ring.TryPush(text.data(), text.size());
+        ASSERT_TRUE(sequence.has_value());
+        ASSERT_TRUE(ring.TryPop(out));
+        EXPECT_EQ(out, text);
+        EXPECT_TRUE(CSpscRing::IsReached(ring.Consumed(), *sequence));
+    }
+    EXPECT_EQ(ring.Consumed(), 3u);
+}
+
+} // namespace Test
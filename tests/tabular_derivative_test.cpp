@@ -1,11 +1,12 @@
+#include "manual_clock.hpp"
+#include "running_avr.h"
 #include "tabular_derivative.h"
 
 #include <chrono>
-#include <thread>
 
 #include <gtest/gtest.h>
 
-/// @brief class TabularDerivative tests.
+/// @brief class TabularDerivative and RunningAvr tests.
 namespace Test {
 
 using namespace std::chrono_literals;
@@ -13,23 +14,27 @@ using namespace std::chrono_literals;
 class TabularDerivativeTest : public ::testing::Test
 {
   public:
+    void SetUp() override
+    {
+        CManualClock::Reset();
+    }
 };
 
 TEST_F(TabularDerivativeTest, ItWorksNoSmoothing)
 {
-    TabularDerivative derivative(1.0f);
+    TabularDerivativeT<CManualClock> derivative(1.0f);
     const auto add_value = [&derivative](float value) {
         derivative.Update(value);
-        std::this_thread::sleep_for(1ms);
+        CManualClock::Advance(1s);
     };
     add_value(1.0);
     ASSERT_FALSE(derivative.Result());
     add_value(2.0);
     ASSERT_TRUE(derivative.Result());
-    EXPECT_GT(*derivative.Result(), 0.0f);
+    EXPECT_NEAR(*derivative.Result(), 1.0f, 0.001f);
     add_value(3.0);
     ASSERT_TRUE(derivative.Result());
-    EXPECT_GT(*derivative.Result(), 0.0f);
+    EXPECT_NEAR(*derivative.Result(), 1.0f, 0.001f);
     add_value(3.0);
     add_value(3.0);
     add_value(3.0);
@@ -42,7 +47,51 @@ TEST_F(TabularDerivativeTest, ItWorksNoSmoothing)
     add_value(1.0);
     add_value(0.0);
     ASSERT_TRUE(derivative.Result());
-    EXPECT_LT(*derivative.Result(), 0.0f);
+    EXPECT_NEAR(*derivative.Result(), -1.0f, 0.001f);
+}
+
+TEST_F(TabularDerivativeTest, RealClock)
+{
+    TabularDerivative derivative(1.0f);
+    const auto start = TabularDerivative::Clock::now();
+    derivative.Update(1.0f, start);
+    derivative.Update(2.0f, start + 1s);
+    ASSERT_TRUE(derivative.Result());
+    EXPECT_NEAR(*derivative.Result(), 1.0f, 0.001f);
+}
+
+TEST_F(TabularDerivativeTest, ExplicitTimestamps)
+{
+    TabularDerivative derivative(1.0f);
+    const TabularDerivative::TimePoint start{};
+    derivative.Update(40.0f, start);
+    derivative.Update(41.0f, start + 500ms);
+    ASSERT_TRUE(derivative.Result());
+    EXPECT_NEAR(*derivative.Result(), 2.0f, 0.001f);
+
+    // Central difference over 3 samples, 2 seconds.
+    derivative.Update(43.0f, start + 2000ms);
+    ASSERT_TRUE(derivative.Result());
+    EXPECT_NEAR(*derivative.Result(), 1.5f, 0.001f);
+
+    // The same sample repeated, or older one, is ignored.
+    derivative.Update(43.0f, start + 2000ms);
+    derivative.Update(10.0f, start + 1000ms);
+    ASSERT_TRUE(derivative.Result());
+    EXPECT_NEAR(*derivative.Result(), 1.5f, 0.001f);
+}
+
+TEST_F(TabularDerivativeTest, RunningAvrSkipsRepeatedSamples)
+{
+    using TimePoint = std::chrono::steady_clock::time_point;
+    RunningAvr<float, 2> avr;
+    const TimePoint start{};
+    EXPECT_TRUE(avr.OfferValue(10.0f, start + 1s));
+    EXPECT_FALSE(avr.OfferValue(10.0f, start + 1s));
+    EXPECT_FALSE(avr.GetCurrent());
+    EXPECT_TRUE(avr.OfferValue(20.0f, start + 2s));
+    ASSERT_TRUE(avr.GetCurrent());
+    EXPECT_NEAR(*avr.GetCurrent(), 15.0f, 0.001f);
 }
 
 } // namespace Test
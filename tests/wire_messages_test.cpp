@@ -0,0 +1,156 @@
+#include "messages_types.h"
+#include "seqlock_buffer.h"
+#include "wire_delta.h"
+#include "wire_messages.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+/// @brief class CWireCodec tests.
+namespace Test {
+
+TEST(WireMessagesTest, FullInfoRoundTrip)
+{
+    FullInfoBlock info;
+    info.tag = 42;
+    info.info.cpu.temperature = 71;
+    info.info.cpu.fanRPM = 1000;
+    info.info.gpu.temperature = 55;
+    info.boostersStates.fanBoosterState = BoosterState::ON;
+    info.behaveAndCurve.behaveState = BehaveState::ADVANCED;
+    info.battery = Battery{Battery::BatteryLevels::BestForBattery};
+    info.daemonDeviceException = "EC timeout";
+    info.info.cpu.sampledAtNs = 1234567;
+    info.info.gpu.sampledAtNs = 1000000;
+
+    const auto decoded = CWireCodec::Decode(CWireCodec::Encode(info));
+    EXPECT_EQ(decoded.tag, info.tag);
+    EXPECT_EQ(decoded.info.cpu.temperature, 71);
+    EXPECT_EQ(decoded.info.cpu.fanRPM, 1000);
+    EXPECT_EQ(decoded.info.gpu.temperature, 55);
+    EXPECT_EQ(decoded.info.cpu.sampledAtNs, 1234567);
+    EXPECT_EQ(decoded.info.gpu.sampledAtNs, 1000000);
+    EXPECT_EQ(decoded.boostersStates, info.boostersStates);
+    EXPECT_EQ(decoded.behaveAndCurve, info.behaveAndCurve);
+    EXPECT_EQ(decoded.daemonDeviceException, info.daemonDeviceException);
+    ASSERT_TRUE(std::holds_alternative<Battery::BatteryLevels>(decoded.battery.maxLevel));
+    EXPECT_EQ(std::get<Battery::BatteryLevels>(decoded.battery.maxLevel),
+              Battery::BatteryLevels::BestForBattery);
+}
+
+TEST(WireMessagesTest, RequestRoundTripAndLimits)
+{
+    RequestFromUi request{RequestFromUi::RequestType::WRITE_DATA};
+    request.boostersStates.cpuTurboBoostState = CpuTurboBoostState::OFF;
+    request.battery = Battery{Battery::TInvalidRange{}};
+    request.gameMode = PolicyState::ON;
+
+    auto message = CWireCodec::Encode(request);
+    const auto decoded = CWireCodec::Decode(message);
+    EXPECT_EQ(decoded.request, request.request);
+    EXPECT_EQ(decoded.boostersStates, request.boostersStates);
+    EXPECT_EQ(decoded.behaveAndCurve, request.behaveAndCurve);
+    EXPECT_EQ(decoded.gameMode, PolicyState::ON);
+    EXPECT_TRUE(std::holds_alternative<Battery::TInvalidRange>(decoded.battery.maxLevel));
+
+    message.header.version += 1;
+    EXPECT_THROW(CWireCodec::Decode(message), std::runtime_error);
+
+    request.behaveAndCurve.curve.cpu.resize(wire::kMaxCurvePoints + 1, AddressedValue1B{0x72, 0});
+    EXPECT_THROW(CWireCodec::Encode(request), std::invalid_argument);
+
+    FullInfoBlock info;
+    info.daemonDeviceException = std::string(1000, 'x');
+    EXPECT_EQ(CWireCodec::Decode(CWireCodec::Encode(info)).daemonDeviceException.size(),
+              wire::kMaxErrorText - 1);
+}
+
+TEST(WireMessagesTest, CorruptedRequestIsRejected)
+{
+    RequestFromUi request{RequestFromUi::RequestType::WRITE_DATA};
+    request.battery = Battery{Battery::BatteryLevels::BestForMobility};
+    const auto valid = CWireCodec::Encode(request);
+    EXPECT_NO_THROW(CWireCodec::Decode(valid));
+
+    // Any client can write raw bytes into its slot.
+    auto message = valid;
+    message.fanBoosterState = static_cast<BoosterState>(0xFF);
+    EXPECT_THROW(CWireCodec::Decode(message), std::invalid_argument);
+
+    message = valid;
+    message.request = static_cast<RequestFromUi::RequestType>(3);
+    EXPECT_THROW(CWireCodec::Decode(message), std::invalid_argument);
+
+    message = valid;
+    message.cpuTurboBoostState = static_cast<CpuTurboBoostState>(3);
+    EXPECT_THROW(CWireCodec::Decode(message), std::invalid_argument);
+
+    message = valid;
+    message.gameMode = static_cast<PolicyState>(3);
+    EXPECT_THROW(CWireCodec::Decode(message), std::invalid_argument);
+
+    message = valid;
+    message.behaveState = static_cast<BehaveState>(3);
+    EXPECT_THROW(CWireCodec::Decode(message), std::invalid_argument);
+
+    message = valid;
+    message.batteryState = 4;
+    EXPECT_THROW(CWireCodec::Decode(message), std::invalid_argument);
+
+    message = valid;
+    message.batteryLevel = static_cast<Battery::BatteryLevels>(3);
+    EXPECT_THROW(CWireCodec::Decode(message), std::invalid_argument);
+}
+
+TEST(WireMessagesTest, DeltaSubscriberSeesOnlyChangedFields)
+{
+    std::vector<char> memory(2048, 0);
+    const CSeqlockBuffer buffer(memory.data(), memory.size());
+    CWireDeltaPublisher publisher;
+    CWireDeltaSubscriber everything;
+    CWireDeltaSubscriber cpuOnly(wire::FieldBit(wire::Field::CPU_INFO));
+
+    FullInfoBlock info;
+    info.tag = 1;
+    info.info.cpu.temperature = 50;
+    info.daemonDeviceException = "first";
+    EXPECT_EQ(publisher.Publish(buffer, info), wire::kAllFields);
+    EXPECT_EQ(everything.Read(buffer), wire::kAllFields);
+    EXPECT_EQ(cpuOnly.Read(buffer), wire::FieldBit(wire::Field::CPU_INFO));
+
+    // Publications which are skipped by the reader are still reported as changes.
+    info.tag = 2;
+    info.daemonDeviceException.clear();
+    EXPECT_EQ(publisher.Publish(buffer, info), wire::FieldBit(wire::Field::DEVICE_ERROR));
+    info.tag = 3;
+    info.info.cpu.temperature = 51;
+    EXPECT_EQ(publisher.Publish(buffer, info), wire::FieldBit(wire::Field::CPU_INFO));
+
+    const auto changed = everything.Read(buffer);
+    ASSERT_TRUE(changed.has_value());
+    EXPECT_EQ(*changed,
+              wire::FieldBit(wire::Field::CPU_INFO) | wire::FieldBit(wire::Field::DEVICE_ERROR));
+    EXPECT_EQ(cpuOnly.Read(buffer), wire::FieldBit(wire::Field::CPU_INFO));
+    EXPECT_EQ(everything.Read(buffer), 0u);
+
+    // Both halves of the double buffer must hold complete data.
+    for (std::size_t tag = 4; tag < 6; ++tag)
+    {
+        info.tag = tag;
+        publisher.Publish(buffer, info);
+        const auto decoded = CWireCodec::Decode(everything.Latest());
+        EXPECT_EQ(decoded.info.cpu.temperature, 51);
+        EXPECT_TRUE(decoded.daemonDeviceException.empty());
+
+        wire::FullInfo whole{};
+        ASSERT_TRUE(buffer.ReadLatest(whole));
+        EXPECT_EQ(whole.tag, tag);
+        EXPECT_EQ(wire::ChangedFields(whole, CWireCodec::Encode(info)), 0u);
+    }
+}
+} // namespace Test